@@ -0,0 +1,209 @@
+#include "bench_scene.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#define BENCH_COMPONENT_SPINNING "bench_spinning"
+
+// Grid instances are laid out across (world units) and the gap between its layers
+#define BENCH_STRESS_SCENE_WIDTH 6.0f
+#define BENCH_STRESS_SCENE_LAYER_SPACING 0.5f
+
+#define BENCH_STRESS_SCENE_TEXTURE_SIZE 128
+
+// MARK: Random
+
+// xorshift32, so scenes don't depend on the C library's rand()
+typedef struct Bench_Random {
+	uint32_t state;
+} Bench_Random;
+
+static Bench_Random bench_random_make(uint32_t seed) {
+	return (Bench_Random){ seed ? seed : 1 };
+}
+
+static float bench_random_float(Bench_Random *random, float min, float max) {
+	random->state ^= random->state << 13;
+	random->state ^= random->state >> 17;
+	random->state ^= random->state << 5;
+	return min + (random->state / (float)UINT32_MAX) * (max - min);
+}
+
+// MARK: Components
+
+static void _bench_spinning_update(Plt_World *world, Plt_Entity_ID entity_id, void *instance_data, Plt_Frame_State state) {
+	(void)instance_data;
+
+	Plt_Transform transform = plt_world_entity_get_transform(world, entity_id);
+	transform = plt_transform_rotate(transform, plt_quaternion_create_from_euler((Plt_Vector3f){0, 0.0005f * state.delta_time, 0}));
+	plt_world_entity_set_transform(world, entity_id, transform);
+}
+
+static void bench_register_components(Plt_World *world) {
+	plt_world_register_component(world, BENCH_COMPONENT_SPINNING, 0, NULL, _bench_spinning_update, NULL);
+}
+
+// MARK: Assets
+
+static void bench_asset_path(char *path, size_t path_size, const char *assets_path, const char *name) {
+	snprintf(path, path_size, "%s/%s", assets_path, name);
+}
+
+Bench_Assets bench_load_assets(const char *assets_path) {
+	char path[1024];
+	Bench_Assets assets;
+
+	bench_asset_path(path, sizeof(path), assets_path, "font_10x16.png");
+	assets.font = plt_font_load(path);
+	bench_asset_path(path, sizeof(path), assets_path, "platypus.ply");
+	assets.platypus_mesh = plt_mesh_load_ply(path);
+	bench_asset_path(path, sizeof(path), assets_path, "platypus.png");
+	assets.platypus_texture = plt_texture_load(path);
+	bench_asset_path(path, sizeof(path), assets_path, "gun.ply");
+	assets.gun_mesh = plt_mesh_load_ply(path);
+	bench_asset_path(path, sizeof(path), assets_path, "gun.png");
+	assets.gun_texture = plt_texture_load(path);
+	bench_asset_path(path, sizeof(path), assets_path, "terrain.ply");
+	assets.terrain_mesh = plt_mesh_load_ply(path);
+	bench_asset_path(path, sizeof(path), assets_path, "lava.png");
+	assets.lava_texture = plt_texture_load(path);
+
+	return assets;
+}
+
+void bench_destroy_assets(Bench_Assets *assets) {
+	plt_font_destroy(&assets->font);
+	plt_mesh_destroy(&assets->platypus_mesh);
+	plt_texture_destroy(&assets->platypus_texture);
+	plt_mesh_destroy(&assets->gun_mesh);
+	plt_texture_destroy(&assets->gun_texture);
+	plt_mesh_destroy(&assets->terrain_mesh);
+	plt_texture_destroy(&assets->lava_texture);
+}
+
+// MARK: Scenes
+
+static Plt_Entity_ID bench_add_mesh_entity(Plt_World *world, const char *name, Plt_Transform transform, Plt_Mesh *mesh, Plt_Texture *texture) {
+	Plt_Entity_ID entity = plt_world_create_entity(world, name, PLT_ENTITY_ID_NONE);
+	plt_world_entity_set_transform(world, entity, transform);
+	plt_world_entity_add_component(world, entity, PLT_COMPONENT_MESH_RENDERER);
+	plt_component_mesh_renderer_set_mesh(world, entity, mesh);
+	plt_component_mesh_renderer_set_texture(world, entity, texture);
+	return entity;
+}
+
+void bench_build_example_scene(Plt_World *world, Bench_Assets *assets, unsigned int prop_count, unsigned int seed) {
+	bench_register_components(world);
+
+	Plt_Entity_ID platypus_entity = bench_add_mesh_entity(world, "platypus", plt_transform_create(plt_vector3f_make(0, 0, 0), plt_quaternion_create_from_euler(plt_vector3f_make(PLT_PI, 0, 0)), plt_vector3f_make(0.5f, 0.5f, 0.5f)), assets->platypus_mesh, assets->platypus_texture);
+	plt_world_entity_add_component(world, platypus_entity, BENCH_COMPONENT_SPINNING);
+
+	Plt_Entity_ID terrain_entity = bench_add_mesh_entity(world, "terrain", plt_transform_create(plt_vector3f_make(0, 0, 0), plt_quaternion_create_from_euler(plt_vector3f_make(0, 0, 0)), plt_vector3f_make(1, 1, 1)), assets->terrain_mesh, assets->lava_texture);
+	plt_component_mesh_renderer_set_static(world, terrain_entity, true);
+
+	Bench_Random random = bench_random_make(seed);
+	for (unsigned int i = 0; i < prop_count; ++i) {
+		Plt_Vector3f position = plt_vector3f_make(bench_random_float(&random, -4.0f, 4.0f), bench_random_float(&random, -1.0f, 0.0f), bench_random_float(&random, -4.0f, 4.0f));
+		Plt_Vector3f rotation = plt_vector3f_make(PLT_PI, bench_random_float(&random, 0.0f, 2.0f * PLT_PI), 0);
+		float scale = bench_random_float(&random, 0.2f, 0.5f);
+
+		Plt_Entity_ID prop_entity = bench_add_mesh_entity(world, "prop", plt_transform_create(position, plt_quaternion_create_from_euler(rotation), plt_vector3f_make(scale, scale, scale)), assets->gun_mesh, assets->gun_texture);
+		if (i % 2) {
+			plt_world_entity_add_component(world, prop_entity, BENCH_COMPONENT_SPINNING);
+		}
+	}
+}
+
+// Checkerboard in a random pair of colours, with mips so distant instances sample like loaded textures do
+static Plt_Texture *bench_create_stress_texture(Bench_Random *random) {
+	Plt_Color8 colors[2];
+	for (unsigned int i = 0; i < 2; ++i) {
+		colors[i] = plt_color8_make(bench_random_float(random, 0, 255), bench_random_float(random, 0, 255), bench_random_float(random, 0, 255), 255);
+	}
+
+	Plt_Texture *texture = plt_texture_create(plt_size_make(BENCH_STRESS_SCENE_TEXTURE_SIZE, BENCH_STRESS_SCENE_TEXTURE_SIZE));
+	for (unsigned int y = 0; y < BENCH_STRESS_SCENE_TEXTURE_SIZE; ++y) {
+		for (unsigned int x = 0; x < BENCH_STRESS_SCENE_TEXTURE_SIZE; ++x) {
+			plt_texture_set_pixel(texture, plt_vector2i_make(x, y), colors[((x / 16) + (y / 16)) % 2]);
+		}
+	}
+	plt_texture_generate_mipmaps(texture);
+	return texture;
+}
+
+Bench_Stress_Scene *bench_stress_scene_create(Plt_World *world, Bench_Assets *assets, Bench_Stress_Scene_Options options) {
+	bench_register_components(world);
+
+	Bench_Stress_Scene *scene = malloc(sizeof(Bench_Stress_Scene));
+	Bench_Random random = bench_random_make(options.seed);
+
+	scene->texture_count = options.texture_count;
+	scene->textures = NULL;
+	if (options.texture_count > 0) {
+		scene->textures = malloc(sizeof(Plt_Texture *) * options.texture_count);
+		for (unsigned int i = 0; i < options.texture_count; ++i) {
+			scene->textures[i] = bench_create_stress_texture(&random);
+		}
+	}
+
+	unsigned int depth_complexity = plt_max(options.depth_complexity, 1);
+	unsigned int layer_instance_count = (options.instance_count + depth_complexity - 1) / depth_complexity;
+	unsigned int columns = plt_max((unsigned int)ceilf(sqrtf(layer_instance_count)), 1);
+	unsigned int rows = plt_max((layer_instance_count + columns - 1) / columns, 1);
+	float spacing = BENCH_STRESS_SCENE_WIDTH / columns;
+	float scale = spacing * 0.5f * options.instance_scale;
+
+	for (unsigned int i = 0; i < options.instance_count; ++i) {
+		unsigned int layer = i / layer_instance_count;
+		unsigned int cell = i % layer_instance_count;
+		unsigned int column = cell % columns;
+		unsigned int row = cell / columns;
+
+		// Layer 0 is furthest from the camera
+		Plt_Vector3f position = {
+			(column - (columns - 1) * 0.5f) * spacing,
+			-0.5f + (row - (rows - 1) * 0.5f) * spacing,
+			-((float)depth_complexity - 1 - layer) * BENCH_STRESS_SCENE_LAYER_SPACING
+		};
+		Plt_Vector3f rotation = plt_vector3f_make(PLT_PI, bench_random_float(&random, 0.0f, 2.0f * PLT_PI), 0);
+		Plt_Transform transform = plt_transform_create(position, plt_quaternion_create_from_euler(rotation), plt_vector3f_make(scale, scale, scale));
+
+		bool use_platypus = (options.mesh == Bench_Stress_Mesh_Platypus) || ((options.mesh == Bench_Stress_Mesh_Mixed) && (i % 2 == 0));
+		Plt_Mesh *mesh = use_platypus ? assets->platypus_mesh : assets->gun_mesh;
+		Plt_Texture *texture = use_platypus ? assets->platypus_texture : assets->gun_texture;
+		if (scene->texture_count > 0) {
+			texture = scene->textures[i % scene->texture_count];
+		}
+
+		Plt_Entity_ID entity = bench_add_mesh_entity(world, "instance", transform, mesh, texture);
+		if (options.animated) {
+			plt_world_entity_add_component(world, entity, BENCH_COMPONENT_SPINNING);
+		} else {
+			plt_component_mesh_renderer_set_static(world, entity, true);
+		}
+	}
+
+	for (unsigned int i = 0; i < options.idle_entity_count; ++i) {
+		Plt_Entity_ID entity = plt_world_create_entity(world, "idle", PLT_ENTITY_ID_NONE);
+		plt_world_entity_add_component(world, entity, BENCH_COMPONENT_SPINNING);
+	}
+
+	return scene;
+}
+
+void bench_stress_scene_destroy(Bench_Stress_Scene **scene) {
+	for (unsigned int i = 0; i < (*scene)->texture_count; ++i) {
+		plt_texture_destroy(&(*scene)->textures[i]);
+	}
+	free((*scene)->textures);
+	free(*scene);
+	*scene = NULL;
+}
+
+Plt_Entity_ID bench_add_camera(Plt_World *world) {
+	Plt_Entity_ID camera_entity = plt_world_create_entity(world, "camera", PLT_ENTITY_ID_NONE);
+	plt_world_entity_add_component(world, camera_entity, PLT_COMPONENT_CAMERA);
+	return camera_entity;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "platypus/platypus.h"
+
+// The renderer records at most 2048 draw calls a frame, leave room for the overlay text
+#define BENCH_STRESS_SCENE_MAX_INSTANCES 2000
+
+typedef struct Bench_Assets {
+	Plt_Font *font;
+	Plt_Mesh *platypus_mesh;
+	Plt_Texture *platypus_texture;
+	Plt_Mesh *gun_mesh;
+	Plt_Texture *gun_texture;
+	Plt_Mesh *terrain_mesh;
+	Plt_Texture *lava_texture;
+} Bench_Assets;
+
+Bench_Assets bench_load_assets(const char *assets_path);
+void bench_destroy_assets(Bench_Assets *assets);
+
+// The spinning platypus example's scene, with prop_count guns scattered around it
+void bench_build_example_scene(Plt_World *world, Bench_Assets *assets, unsigned int prop_count, unsigned int seed);
+
+typedef enum Bench_Stress_Mesh {
+	Bench_Stress_Mesh_Platypus,
+	Bench_Stress_Mesh_Gun,
+
+	// Alternates between the platypus and the gun
+	Bench_Stress_Mesh_Mixed,
+	Bench_Stress_Mesh_Count
+} Bench_Stress_Mesh;
+
+typedef struct Bench_Stress_Scene_Options {
+	// Mesh renderer entities, one draw call each
+	unsigned int instance_count;
+
+	// Instances are split into this many layers stacked one behind the other, drawn back to front
+	// so every layer covers the one before it, roughly the overdraw of the screen they cover
+	unsigned int depth_complexity;
+
+	// Scales every instance, and with it the size of its triangles on screen
+	float instance_scale;
+
+	// Procedural textures shared out between the instances, 0 uses the meshes' own textures
+	unsigned int texture_count;
+
+	// Entities with only an update component, to weigh world updates against rendering
+	unsigned int idle_entity_count;
+
+	Bench_Stress_Mesh mesh;
+
+	// Spins every instance, otherwise instances are static geometry and binned once
+	bool animated;
+
+	unsigned int seed;
+} Bench_Stress_Scene_Options;
+
+typedef struct Bench_Stress_Scene {
+	unsigned int texture_count;
+	Plt_Texture **textures;
+} Bench_Stress_Scene;
+
+// Lays instances out in a grid facing down -z from the origin, so every layer fills the same part of the screen
+Bench_Stress_Scene *bench_stress_scene_create(Plt_World *world, Bench_Assets *assets, Bench_Stress_Scene_Options options);
+void bench_stress_scene_destroy(Bench_Stress_Scene **scene);
+
+// Adds the camera the benchmark moves along its path
+Plt_Entity_ID bench_add_camera(Plt_World *world);
@@ -0,0 +1,530 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "platypus/platypus.h"
+#include "platypus/base/plt_platform.h"
+#include "bench_scene.h"
+
+// Renders scripted camera paths through a fixed scene headlessly and reports how long each
+// renderer stage took as JSON. Every frame is simulated with the same delta time and scenes
+// are generated from a fixed seed, so two runs render exactly the same frames.
+
+#define BENCH_DELTA_TIME (1000.0f / 60.0f)
+
+// Edge length of the rasteriser's tiles in pixels, for overdraw over the tiles it redrew
+#define BENCH_TILE_SIZE 16
+
+typedef enum Bench_Camera_Path {
+	Bench_Camera_Path_Orbit,
+	Bench_Camera_Path_Dolly,
+	Bench_Camera_Path_Sweep,
+	Bench_Camera_Path_Fixed,
+	Bench_Camera_Path_Count
+} Bench_Camera_Path;
+
+static const char *bench_camera_path_names[Bench_Camera_Path_Count] = {
+	"orbit",
+	"dolly",
+	"sweep",
+	"fixed"
+};
+
+typedef enum Bench_Scene_Type {
+	Bench_Scene_Type_Example,
+	Bench_Scene_Type_Stress,
+	Bench_Scene_Type_Count
+} Bench_Scene_Type;
+
+static const char *bench_scene_type_names[Bench_Scene_Type_Count] = {
+	"example",
+	"stress"
+};
+
+static const char *bench_stress_mesh_names[Bench_Stress_Mesh_Count] = {
+	"platypus",
+	"gun",
+	"mixed"
+};
+
+typedef struct Bench_Options {
+	unsigned int frame_count;
+	unsigned int warmup_frame_count;
+	unsigned int width, height;
+	unsigned int seed;
+
+	// 0 uses one rasteriser thread per core
+	unsigned int thread_count;
+
+	Bench_Scene_Type scene_type;
+	unsigned int prop_count;
+	Bench_Stress_Scene_Options stress;
+
+	// Bench_Camera_Path_Count picks the scene's own default
+	Bench_Camera_Path camera_path;
+	const char *assets_path;
+	const char *output_path;
+
+	// Chrome trace of the measured frames, only the most recent events each thread kept are written
+	const char *trace_path;
+} Bench_Options;
+
+typedef struct Bench_Stage_Summary {
+	float mean_ms;
+	float p50_ms;
+	float p99_ms;
+} Bench_Stage_Summary;
+
+typedef enum Bench_Stage {
+	Bench_Stage_Vertex_Processor,
+	Bench_Stage_Triangle_Processor,
+	Bench_Stage_Rasteriser,
+	Bench_Stage_Direct_Draw,
+	Bench_Stage_Execute,
+	Bench_Stage_Frame,
+	Bench_Stage_Count
+} Bench_Stage;
+
+// Renderer stats summed over the measured frames
+typedef struct Bench_Pipeline_Totals {
+	double vertices_processed;
+	double triangles_submitted;
+	double triangles_culled_behind_camera;
+	double triangles_culled_zero_area;
+	double triangles_culled_back_face;
+	double triangles_binned;
+	double bin_overflow_count;
+	double mean_bin_entries;
+	unsigned int max_bin_entries;
+	double tiles_rasterised;
+	double full_coverage_entries;
+	double partial_coverage_entries;
+	double pixels_tested;
+	double pixels_written;
+} Bench_Pipeline_Totals;
+
+static const char *bench_stage_names[Bench_Stage_Count] = {
+	"vertex_processor",
+	"triangle_processor",
+	"rasteriser",
+	"direct_draw",
+	"execute",
+	"frame"
+};
+
+// MARK: Camera Paths
+
+// Camera looking at the origin from position
+static Plt_Transform bench_camera_look_at_origin(Plt_Vector3f position) {
+	float yaw = atan2f(position.x, position.z);
+	return plt_transform_create(position, plt_quaternion_create_from_euler(plt_vector3f_make(0, yaw, 0)), plt_vector3f_make(1, 1, 1));
+}
+
+// t runs from 0 to 1 over the benchmark
+static Plt_Transform bench_camera_path_transform(Bench_Camera_Path path, float t) {
+	switch (path) {
+		case Bench_Camera_Path_Orbit: {
+			float angle = t * 2.0f * PLT_PI;
+			return bench_camera_look_at_origin(plt_vector3f_make(sinf(angle) * 5.0f, -0.5f, cosf(angle) * 5.0f));
+		}
+
+		// Closes in on the platypus until it fills the screen, so triangles grow over the run
+		case Bench_Camera_Path_Dolly: {
+			float distance = 12.0f + (1.5f - 12.0f) * t;
+			return bench_camera_look_at_origin(plt_vector3f_make(0, -0.5f, distance));
+		}
+
+		// Pans back and forth from a fixed point, so geometry moves through the screen's tiles
+		case Bench_Camera_Path_Sweep: {
+			float yaw = sinf(t * 2.0f * PLT_PI) * 0.8f;
+			return plt_transform_create(plt_vector3f_make(0, -0.5f, 5.0f), plt_quaternion_create_from_euler(plt_vector3f_make(0, yaw, 0)), plt_vector3f_make(1, 1, 1));
+		}
+
+		case Bench_Camera_Path_Fixed:
+			return bench_camera_look_at_origin(plt_vector3f_make(0, -0.5f, 5.0f));
+
+		default:
+			return bench_camera_look_at_origin(plt_vector3f_make(0, -0.5f, 5.0f));
+	}
+}
+
+// MARK: Statistics
+
+// Monotonic, wall clock time can jump mid-run
+static double bench_get_time_ms() {
+	return plt_platform_get_time_ns() / 1000000.0;
+}
+
+static int bench_compare_floats(const void *a, const void *b) {
+	float fa = *(const float *)a;
+	float fb = *(const float *)b;
+	return (fa > fb) - (fa < fb);
+}
+
+// Nearest rank percentile, sorts samples in place
+static float bench_percentile(float *sorted_samples, unsigned int count, float percentile) {
+	unsigned int rank = (unsigned int)ceilf(percentile / 100.0f * count);
+	rank = rank > 0 ? rank - 1 : 0;
+	return sorted_samples[rank < count ? rank : count - 1];
+}
+
+static Bench_Stage_Summary bench_summarise(float *samples, unsigned int count) {
+	double total = 0.0;
+	for (unsigned int i = 0; i < count; ++i) {
+		total += samples[i];
+	}
+
+	qsort(samples, count, sizeof(float), bench_compare_floats);
+	return (Bench_Stage_Summary) {
+		.mean_ms = total / count,
+		.p50_ms = bench_percentile(samples, count, 50.0f),
+		.p99_ms = bench_percentile(samples, count, 99.0f)
+	};
+}
+
+static void bench_add_pipeline_stats(Bench_Pipeline_Totals *totals, Plt_Renderer_Stats stats) {
+	totals->vertices_processed += stats.vertices_processed;
+	totals->triangles_submitted += stats.triangles_submitted;
+	totals->triangles_culled_behind_camera += stats.triangles_culled_behind_camera;
+	totals->triangles_culled_zero_area += stats.triangles_culled_zero_area;
+	totals->triangles_culled_back_face += stats.triangles_culled_back_face;
+	totals->triangles_binned += stats.triangles_binned;
+	totals->bin_overflow_count += stats.bin_overflow_count;
+	totals->mean_bin_entries += stats.mean_bin_entries;
+	totals->max_bin_entries = plt_max(totals->max_bin_entries, stats.max_bin_entries);
+	totals->tiles_rasterised += stats.tiles_rasterised;
+	totals->full_coverage_entries += stats.full_coverage_entries;
+	totals->partial_coverage_entries += stats.partial_coverage_entries;
+	totals->pixels_tested += stats.pixels_tested;
+	totals->pixels_written += stats.pixels_written;
+}
+
+// MARK: Options
+
+static void bench_print_usage(const char *executable) {
+	fprintf(stderr, "Usage: %s [options]\n", executable);
+	fprintf(stderr, "  --frames <count>          Frames measured (default 600)\n");
+	fprintf(stderr, "  --warmup <count>          Frames rendered before measuring (default 60)\n");
+	fprintf(stderr, "  --size <w> <h>            Framebuffer size (default 860 640)\n");
+	fprintf(stderr, "  --threads <count>         Rasteriser threads, 0 for one per core (default 0)\n");
+	fprintf(stderr, "  --path <name>             Camera path: orbit, dolly, sweep or fixed\n");
+	fprintf(stderr, "                            (default orbit for the example scene, fixed for stress)\n");
+	fprintf(stderr, "  --seed <seed>             Scene generation seed (default 1)\n");
+	fprintf(stderr, "  --scene <name>            Scene: example or stress (default example)\n");
+	fprintf(stderr, "  --props <count>           Example scene: props scattered around it (default 16)\n");
+	fprintf(stderr, "  --instances <count>       Stress scene: mesh instances, at most %d (default 64)\n", BENCH_STRESS_SCENE_MAX_INSTANCES);
+	fprintf(stderr, "  --depth <layers>          Stress scene: layers instances are stacked in (default 1)\n");
+	fprintf(stderr, "  --instance-scale <scale>  Stress scene: instance size (default 1)\n");
+	fprintf(stderr, "  --textures <count>        Stress scene: generated textures, 0 uses the meshes' own (default 0)\n");
+	fprintf(stderr, "  --idle-entities <count>   Stress scene: entities that only update (default 0)\n");
+	fprintf(stderr, "  --mesh <name>             Stress scene: platypus, gun or mixed (default mixed)\n");
+	fprintf(stderr, "  --static                  Stress scene: don't animate instances, bin them once\n");
+	fprintf(stderr, "  --assets <directory>      Asset directory (default assets)\n");
+	fprintf(stderr, "  --output <file>           Write the JSON report to a file rather than stdout\n");
+	fprintf(stderr, "  --trace <file>            Write a Chrome trace of the measured frames\n");
+}
+
+// Index of name in names, or count if it isn't there
+static unsigned int bench_find_name(const char *name, const char **names, unsigned int count) {
+	for (unsigned int i = 0; i < count; ++i) {
+		if (strcmp(name, names[i]) == 0) {
+			return i;
+		}
+	}
+	return count;
+}
+
+static bool bench_parse_options(int argc, char **argv, Bench_Options *options) {
+	*options = (Bench_Options) {
+		.frame_count = 600,
+		.warmup_frame_count = 60,
+		.width = 860,
+		.height = 640,
+		.seed = 1,
+		.thread_count = 0,
+		.scene_type = Bench_Scene_Type_Example,
+		.prop_count = 16,
+		.stress = {
+			.instance_count = 64,
+			.depth_complexity = 1,
+			.instance_scale = 1.0f,
+			.texture_count = 0,
+			.idle_entity_count = 0,
+			.mesh = Bench_Stress_Mesh_Mixed,
+			.animated = true
+		},
+		.camera_path = Bench_Camera_Path_Count,
+		.assets_path = "assets",
+		.output_path = NULL,
+		.trace_path = NULL
+	};
+
+	for (int i = 1; i < argc; ++i) {
+		const char *option = argv[i];
+		int remaining = argc - i - 1;
+
+		if ((strcmp(option, "--frames") == 0) && (remaining >= 1)) {
+			options->frame_count = strtoul(argv[++i], NULL, 10);
+		} else if ((strcmp(option, "--warmup") == 0) && (remaining >= 1)) {
+			options->warmup_frame_count = strtoul(argv[++i], NULL, 10);
+		} else if ((strcmp(option, "--size") == 0) && (remaining >= 2)) {
+			options->width = strtoul(argv[++i], NULL, 10);
+			options->height = strtoul(argv[++i], NULL, 10);
+		} else if ((strcmp(option, "--threads") == 0) && (remaining >= 1)) {
+			options->thread_count = strtoul(argv[++i], NULL, 10);
+		} else if ((strcmp(option, "--seed") == 0) && (remaining >= 1)) {
+			options->seed = strtoul(argv[++i], NULL, 10);
+		} else if ((strcmp(option, "--props") == 0) && (remaining >= 1)) {
+			options->prop_count = strtoul(argv[++i], NULL, 10);
+		} else if ((strcmp(option, "--instances") == 0) && (remaining >= 1)) {
+			options->stress.instance_count = strtoul(argv[++i], NULL, 10);
+		} else if ((strcmp(option, "--depth") == 0) && (remaining >= 1)) {
+			options->stress.depth_complexity = strtoul(argv[++i], NULL, 10);
+		} else if ((strcmp(option, "--instance-scale") == 0) && (remaining >= 1)) {
+			options->stress.instance_scale = strtof(argv[++i], NULL);
+		} else if ((strcmp(option, "--textures") == 0) && (remaining >= 1)) {
+			options->stress.texture_count = strtoul(argv[++i], NULL, 10);
+		} else if ((strcmp(option, "--idle-entities") == 0) && (remaining >= 1)) {
+			options->stress.idle_entity_count = strtoul(argv[++i], NULL, 10);
+		} else if (strcmp(option, "--static") == 0) {
+			options->stress.animated = false;
+		} else if ((strcmp(option, "--assets") == 0) && (remaining >= 1)) {
+			options->assets_path = argv[++i];
+		} else if ((strcmp(option, "--output") == 0) && (remaining >= 1)) {
+			options->output_path = argv[++i];
+		} else if ((strcmp(option, "--trace") == 0) && (remaining >= 1)) {
+			options->trace_path = argv[++i];
+		} else if ((strcmp(option, "--path") == 0) && (remaining >= 1)) {
+			const char *name = argv[++i];
+			options->camera_path = bench_find_name(name, bench_camera_path_names, Bench_Camera_Path_Count);
+			if (options->camera_path == Bench_Camera_Path_Count) {
+				fprintf(stderr, "Unknown camera path '%s'.\n", name);
+				return false;
+			}
+		} else if ((strcmp(option, "--scene") == 0) && (remaining >= 1)) {
+			const char *name = argv[++i];
+			options->scene_type = bench_find_name(name, bench_scene_type_names, Bench_Scene_Type_Count);
+			if (options->scene_type == Bench_Scene_Type_Count) {
+				fprintf(stderr, "Unknown scene '%s'.\n", name);
+				return false;
+			}
+		} else if ((strcmp(option, "--mesh") == 0) && (remaining >= 1)) {
+			const char *name = argv[++i];
+			options->stress.mesh = bench_find_name(name, bench_stress_mesh_names, Bench_Stress_Mesh_Count);
+			if (options->stress.mesh == Bench_Stress_Mesh_Count) {
+				fprintf(stderr, "Unknown mesh '%s'.\n", name);
+				return false;
+			}
+		} else {
+			fprintf(stderr, "Unknown or incomplete option '%s'.\n", option);
+			return false;
+		}
+	}
+
+	if ((options->frame_count == 0) || (options->width == 0) || (options->height == 0)) {
+		fprintf(stderr, "Frame count and framebuffer size must be greater than 0.\n");
+		return false;
+	}
+
+	if (options->stress.instance_count > BENCH_STRESS_SCENE_MAX_INSTANCES) {
+		fprintf(stderr, "Stress scenes can have at most %d instances.\n", BENCH_STRESS_SCENE_MAX_INSTANCES);
+		return false;
+	}
+
+	// Leave room for the camera
+	if (options->stress.instance_count + options->stress.idle_entity_count >= PLT_WORLD_ENTITY_CAPACITY - 1) {
+		fprintf(stderr, "Stress scenes can have at most %d entities.\n", PLT_WORLD_ENTITY_CAPACITY - 2);
+		return false;
+	}
+
+	if (options->camera_path == Bench_Camera_Path_Count) {
+		options->camera_path = (options->scene_type == Bench_Scene_Type_Stress) ? Bench_Camera_Path_Fixed : Bench_Camera_Path_Orbit;
+	}
+	options->stress.seed = options->seed;
+
+	return true;
+}
+
+// MARK: Report
+
+static void bench_write_scene(FILE *output, Bench_Options *options) {
+	fprintf(output, "\t\"scene\": {\n");
+	fprintf(output, "\t\t\"type\": \"%s\",\n", bench_scene_type_names[options->scene_type]);
+	if (options->scene_type == Bench_Scene_Type_Stress) {
+		Bench_Stress_Scene_Options *stress = &options->stress;
+		fprintf(output, "\t\t\"instances\": %u,\n", stress->instance_count);
+		fprintf(output, "\t\t\"depth_complexity\": %u,\n", stress->depth_complexity);
+		fprintf(output, "\t\t\"instance_scale\": %.3f,\n", stress->instance_scale);
+		fprintf(output, "\t\t\"textures\": %u,\n", stress->texture_count);
+		fprintf(output, "\t\t\"idle_entities\": %u,\n", stress->idle_entity_count);
+		fprintf(output, "\t\t\"mesh\": \"%s\",\n", bench_stress_mesh_names[stress->mesh]);
+		fprintf(output, "\t\t\"animated\": %s\n", stress->animated ? "true" : "false");
+	} else {
+		fprintf(output, "\t\t\"props\": %u\n", options->prop_count);
+	}
+	fprintf(output, "\t},\n");
+}
+
+// Per frame means, except max_bin_entries which is the most any tile held in any frame
+static void bench_write_pipeline(FILE *output, Bench_Options *options, Bench_Pipeline_Totals *totals) {
+	double frame_count = options->frame_count;
+	double rasterised_pixels = totals->tiles_rasterised * BENCH_TILE_SIZE * BENCH_TILE_SIZE;
+
+	fprintf(output, "\t\"pipeline\": {\n");
+	fprintf(output, "\t\t\"vertices_processed\": %.1f,\n", totals->vertices_processed / frame_count);
+	fprintf(output, "\t\t\"triangles_submitted\": %.1f,\n", totals->triangles_submitted / frame_count);
+	fprintf(output, "\t\t\"triangles_culled_behind_camera\": %.1f,\n", totals->triangles_culled_behind_camera / frame_count);
+	fprintf(output, "\t\t\"triangles_culled_zero_area\": %.1f,\n", totals->triangles_culled_zero_area / frame_count);
+	fprintf(output, "\t\t\"triangles_culled_back_face\": %.1f,\n", totals->triangles_culled_back_face / frame_count);
+	fprintf(output, "\t\t\"triangles_binned\": %.1f,\n", totals->triangles_binned / frame_count);
+	fprintf(output, "\t\t\"bin_overflow\": %.1f,\n", totals->bin_overflow_count / frame_count);
+	fprintf(output, "\t\t\"mean_bin_entries\": %.3f,\n", totals->mean_bin_entries / frame_count);
+	fprintf(output, "\t\t\"max_bin_entries\": %u,\n", totals->max_bin_entries);
+	fprintf(output, "\t\t\"tiles_rasterised\": %.1f,\n", totals->tiles_rasterised / frame_count);
+	fprintf(output, "\t\t\"full_coverage_entries\": %.1f,\n", totals->full_coverage_entries / frame_count);
+	fprintf(output, "\t\t\"partial_coverage_entries\": %.1f,\n", totals->partial_coverage_entries / frame_count);
+	fprintf(output, "\t\t\"pixels_tested\": %.1f,\n", totals->pixels_tested / frame_count);
+	fprintf(output, "\t\t\"pixels_written\": %.1f,\n", totals->pixels_written / frame_count);
+	fprintf(output, "\t\t\"overdraw\": %.3f\n", (rasterised_pixels > 0) ? totals->pixels_written / rasterised_pixels : 0.0);
+	fprintf(output, "\t},\n");
+}
+
+static void bench_write_report(FILE *output, Bench_Options *options, unsigned int thread_count, Bench_Stage_Summary *summaries, Bench_Pipeline_Totals *pipeline_totals, double triangle_count, double elapsed_ms) {
+	double elapsed_seconds = elapsed_ms / 1000.0;
+
+	fprintf(output, "{\n");
+	bench_write_scene(output, options);
+	fprintf(output, "\t\"camera_path\": \"%s\",\n", bench_camera_path_names[options->camera_path]);
+	fprintf(output, "\t\"seed\": %u,\n", options->seed);
+	fprintf(output, "\t\"threads\": %u,\n", thread_count);
+	fprintf(output, "\t\"frames\": %u,\n", options->frame_count);
+	fprintf(output, "\t\"warmup_frames\": %u,\n", options->warmup_frame_count);
+	fprintf(output, "\t\"width\": %u,\n", options->width);
+	fprintf(output, "\t\"height\": %u,\n", options->height);
+	fprintf(output, "\t\"triangles_per_frame\": %.1f,\n", triangle_count / options->frame_count);
+	fprintf(output, "\t\"frames_per_second\": %.3f,\n", options->frame_count / elapsed_seconds);
+	fprintf(output, "\t\"triangles_per_second\": %.1f,\n", triangle_count / elapsed_seconds);
+	bench_write_pipeline(output, options, pipeline_totals);
+	fprintf(output, "\t\"stages\": {\n");
+	for (unsigned int s = 0; s < Bench_Stage_Count; ++s) {
+		fprintf(output, "\t\t\"%s\": { \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p99_ms\": %.4f }%s\n", bench_stage_names[s], summaries[s].mean_ms, summaries[s].p50_ms, summaries[s].p99_ms, (s + 1 < Bench_Stage_Count) ? "," : "");
+	}
+	fprintf(output, "\t}\n");
+	fprintf(output, "}\n");
+}
+
+// MARK: Main
+
+int main(int argc, char **argv) {
+	Bench_Options options;
+	if (!bench_parse_options(argc, argv, &options)) {
+		bench_print_usage(argv[0]);
+		return 1;
+	}
+
+	plt_trace_set_thread_name("Main Thread");
+	Bench_Assets assets = bench_load_assets(options.assets_path);
+
+	Plt_Renderer *renderer = plt_renderer_create_headless((Plt_Framebuffer){ NULL, options.width, options.height });
+	plt_renderer_set_thread_count(renderer, options.thread_count);
+
+	Plt_World *world = plt_world_create();
+	Bench_Stress_Scene *stress_scene = NULL;
+	if (options.scene_type == Bench_Scene_Type_Stress) {
+		stress_scene = bench_stress_scene_create(world, &assets, options.stress);
+	} else {
+		bench_build_example_scene(world, &assets, options.prop_count, options.seed);
+	}
+	Plt_Entity_ID camera_entity = bench_add_camera(world);
+
+	float *samples[Bench_Stage_Count];
+	for (unsigned int s = 0; s < Bench_Stage_Count; ++s) {
+		samples[s] = malloc(sizeof(float) * options.frame_count);
+	}
+
+	Bench_Pipeline_Totals pipeline_totals = { 0 };
+	double triangle_count = 0.0;
+	double elapsed_ms = 0.0;
+	unsigned int total_frame_count = options.warmup_frame_count + options.frame_count;
+	for (unsigned int frame = 0; frame < total_frame_count; ++frame) {
+		Plt_Frame_State state = {
+			.delta_time = BENCH_DELTA_TIME,
+			.application_time = frame * BENCH_DELTA_TIME,
+			.input_state = NULL
+		};
+
+		// Warmup frames hold the camera at the start of the path
+		bool is_measured = frame >= options.warmup_frame_count;
+		if (options.trace_path && (frame == options.warmup_frame_count)) {
+			plt_trace_set_enabled(true);
+		}
+		unsigned int measured_frame = is_measured ? frame - options.warmup_frame_count : 0;
+		float t = measured_frame / (float)options.frame_count;
+		plt_world_entity_set_transform(world, camera_entity, bench_camera_path_transform(options.camera_path, t));
+
+		double frame_start_ms = bench_get_time_ms();
+		plt_trace_begin("Frame");
+		plt_world_update(world, state);
+		plt_renderer_clear(renderer, plt_color8_make(0, 0, 0, 255));
+		plt_world_render(world, state, renderer);
+		char text[32];
+		snprintf(text, sizeof(text), "FRAME:%u", frame);
+		plt_renderer_direct_draw_text(renderer, (Plt_Vector2i){0, 0}, assets.font, text);
+		plt_renderer_execute(renderer);
+		plt_renderer_present(renderer);
+		plt_trace_end("Frame");
+		double frame_ms = bench_get_time_ms() - frame_start_ms;
+
+		if (!is_measured) {
+			continue;
+		}
+
+		Plt_Renderer_Frame_Timings timings = plt_renderer_get_frame_timings(renderer);
+		samples[Bench_Stage_Vertex_Processor][measured_frame] = timings.vertex_processor_ms;
+		samples[Bench_Stage_Triangle_Processor][measured_frame] = timings.triangle_processor_ms;
+		samples[Bench_Stage_Rasteriser][measured_frame] = timings.rasteriser_ms;
+		samples[Bench_Stage_Direct_Draw][measured_frame] = timings.direct_draw_ms;
+		samples[Bench_Stage_Execute][measured_frame] = timings.total_ms;
+		samples[Bench_Stage_Frame][measured_frame] = frame_ms;
+		triangle_count += timings.triangle_count;
+		bench_add_pipeline_stats(&pipeline_totals, plt_renderer_get_stats(renderer));
+		elapsed_ms += frame_ms;
+	}
+
+	if (options.trace_path) {
+		plt_trace_set_enabled(false);
+		if (!plt_trace_export_chrome_json(options.trace_path)) {
+			fprintf(stderr, "Couldn't write the trace to '%s'.\n", options.trace_path);
+		}
+	}
+
+	Bench_Stage_Summary summaries[Bench_Stage_Count];
+	for (unsigned int s = 0; s < Bench_Stage_Count; ++s) {
+		summaries[s] = bench_summarise(samples[s], options.frame_count);
+		free(samples[s]);
+	}
+
+	FILE *output = stdout;
+	if (options.output_path) {
+		output = fopen(options.output_path, "w");
+		if (!output) {
+			fprintf(stderr, "Couldn't open '%s' for writing.\n", options.output_path);
+			return 1;
+		}
+	}
+	bench_write_report(output, &options, plt_renderer_get_thread_count(renderer), summaries, &pipeline_totals, triangle_count, elapsed_ms);
+	if (output != stdout) {
+		fclose(output);
+	}
+
+	plt_world_destroy(world);
+	if (stress_scene) {
+		bench_stress_scene_destroy(&stress_scene);
+	}
+	plt_renderer_destroy(&renderer);
+	bench_destroy_assets(&assets);
+
+	return 0;
+}
@@ -17,28 +17,6 @@ void plt_register_spinning_component(Plt_World *world) {
 	plt_world_register_component(world, PLT_COMPONENT_SPINNING, 0, NULL, _spinning_update, NULL);
 }
 
-#define PLT_COMPONENT_FPS_VIEWER "fps_viewer"
-typedef struct Plt_Component_FPS_Viewer_Data {
-	Plt_Font *font;
-} Plt_Component_FPS_Viewer_Data;
-void _fps_viewer_render(Plt_World *world, Plt_Entity_ID entity_id, void *instance_data, Plt_Frame_State state, Plt_Renderer *renderer) {
-	Plt_Component_FPS_Viewer_Data *data = instance_data;
-	char text[32];
-	sprintf(text, "FPS:%d", (int)(1000 / state.delta_time));
-	plt_renderer_direct_draw_text(renderer, (Plt_Vector2i){0, 0}, data->font, text);
-}
-void plt_register_fps_viewer_component(Plt_World *world) {
-	plt_world_register_component(world, PLT_COMPONENT_FPS_VIEWER, sizeof(Plt_Component_FPS_Viewer_Data), NULL, NULL, _fps_viewer_render);
-}
-void plt_component_fps_viewer_set_font(Plt_World *world, Plt_Entity_ID entity_id, Plt_Font *font) {
-	Plt_Component_FPS_Viewer_Data *data = plt_world_get_component_instance_data(world, entity_id, PLT_COMPONENT_FPS_VIEWER);
-	if (!data) {
-		return;
-	}
-	
-	data->font = font;
-}
-
 int main(int argc, char **argv) {
 	Plt_Application *app = plt_application_create("Platypus - Spinning Platypus", 860, 640, 1, Plt_Application_Option_None);
 	Plt_Renderer *renderer = plt_application_get_renderer(app);
@@ -55,7 +33,6 @@ int main(int argc, char **argv) {
 	// Create world
 	Plt_World *world = plt_world_create();
 	plt_register_spinning_component(world);
-	plt_register_fps_viewer_component(world);
 	plt_application_set_world(app, world);
 	
 	// Create world objects
@@ -73,15 +50,17 @@ int main(int argc, char **argv) {
 	plt_world_entity_add_component(world, terrain_entity, PLT_COMPONENT_MESH_RENDERER);
 	plt_component_mesh_renderer_set_mesh(world, terrain_entity, terrain_mesh);
 	plt_component_mesh_renderer_set_texture(world, terrain_entity, lava_texture);
+	plt_component_mesh_renderer_set_static(world, terrain_entity, true);
 	
 	Plt_Entity_ID camera_entity = plt_world_create_entity(world, "camera", PLT_ENTITY_ID_NONE);
 	plt_world_entity_set_transform(world, camera_entity, plt_transform_create(plt_vector3f_make(0, -0.5f, 5.0f), plt_quaternion_create_from_euler(plt_vector3f_make(0, 0, 0)), plt_vector3f_make(1.0f, 1.0f, 1.0f)));
 	plt_world_entity_add_component(world, camera_entity, "flying_camera_controller");
 	plt_world_entity_add_component(world, camera_entity, PLT_COMPONENT_CAMERA);
 	
-	Plt_Entity_ID fps_viewer = plt_world_create_entity(world, "fps_viewer", PLT_ENTITY_ID_NONE);
-	plt_world_entity_add_component(world, fps_viewer, PLT_COMPONENT_FPS_VIEWER);
-	plt_component_fps_viewer_set_font(world, fps_viewer, font);
+	Plt_Entity_ID performance_hud = plt_world_create_entity(world, "performance_hud", PLT_ENTITY_ID_NONE);
+	plt_world_entity_add_component(world, performance_hud, PLT_COMPONENT_PERFORMANCE_HUD);
+	plt_component_performance_hud_set_font(world, performance_hud, font);
+	plt_component_performance_hud_set_target_fps(world, performance_hud, plt_application_get_target_fps(app));
 
 	// Application run loop
 	while (!plt_application_should_close(app)) {
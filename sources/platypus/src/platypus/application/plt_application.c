@@ -8,21 +8,36 @@
 #include "platypus/renderer/plt_renderer.h"
 #include "platypus/world/plt_world.h"
 #include "platypus/input/plt_input_state.h"
+#include "platypus/application/plt_frame_scheduler.h"
 
+#include "platypus/base/thread/plt_thread.h"
 #include "platypus/base/plt_platform.h"
 #include "platypus/base/plt_macros.h"
+#include "platypus/base/plt_simd.h"
 
-#if PLT_PLATFORM_WINDOWS
-#include <time.h>
-#include <windows.h>
-#elif PLT_PLATFORM_UNIX
-#include <unistd.h>
-#include <time.h>
-#endif
+// Beyond this many changed regions the whole window is presented
+#define PLT_APPLICATION_MAX_DIRTY_RECTS 256
+
+// Below this many framebuffer pixels integer scale presents are blitted on the calling thread
+#define PLT_APPLICATION_THREADED_BLIT_MIN_PIXELS 32768
+
+// Dynamic resolution snaps the render scale to this step, so small swings don't resize every frame
+#define PLT_DYNAMIC_RESOLUTION_SCALE_STEP 0.125f
+
+// Frames to wait after a scale change before judging the new resolution
+#define PLT_DYNAMIC_RESOLUTION_COOLDOWN_FRAMES 8
+
+// Share of the frame budget rendering may use, and the share below which it sharpens again
+#define PLT_DYNAMIC_RESOLUTION_HEADROOM 0.9f
+#define PLT_DYNAMIC_RESOLUTION_SHARPEN_THRESHOLD 0.6f
 
 typedef struct Plt_Application {
 	SDL_Window *window;
 
+	// Window surface last presented to, its contents are lost when SDL recreates it
+	SDL_Surface *window_surface;
+	void *window_pixels;
+
 	SDL_Surface *framebuffer_surface;
 	Plt_Framebuffer framebuffer;
 
@@ -34,24 +49,69 @@ typedef struct Plt_Application {
 
 	unsigned int target_fps;
 	float target_frame_ms;
+	Plt_Frame_Scheduler frame_scheduler;
 
 	double millis_at_creation;
-	double millis_at_since_last_update;
-	double millis_since_world_last_update;
 
-	unsigned int scale;
+	// Window pixels per framebuffer pixel, only fractional while dynamic resolution is on
+	float scale;
 	Plt_Color8 clear_color;
+
+	// Dynamic resolution governor
+	bool dynamic_resolution;
+	float min_scale;
+	float max_scale;
+	float smoothed_render_ms;
+	unsigned int scale_cooldown;
+
+	// Source column for each window column for fractional scales
+	unsigned int *blit_columns;
+	unsigned int blit_columns_width;
+	float blit_columns_scale;
+
+	// Integer scale presents are split across these threads, each taking a band of every region
+	Plt_Thread_Pool *blit_thread_pool;
+	unsigned int blit_thread_count;
+	const Plt_Rect *blit_regions;
+	const SDL_Rect *blit_window_rects;
+	unsigned int blit_region_count;
+
+	// Pipelined frames are executed on this thread while the next is recorded
+	bool pipelined_frames;
+	bool frame_in_flight;
+	Plt_Thread_Pool *render_thread_pool;
+	float render_thread_ms;
 } Plt_Application;
 
 double plt_application_current_milliseconds();
 void plt_application_render(Plt_Application *application);
 void plt_application_update_framebuffer(Plt_Application *application);
+void plt_application_update_render_scale(Plt_Application *application, float update_ms, float render_ms);
+void *_blit_thread(unsigned int thread_id, void *thread_data);
+void *_render_thread(unsigned int thread_id, void *thread_data);
+float plt_application_finish_pipelined_frame(Plt_Application *application);
+void plt_application_update_pipelined(Plt_Application *application, Plt_Frame_State frame_state);
 
 Plt_Application *plt_application_create(const char *title, unsigned int width, unsigned int height, unsigned int scale, Plt_Application_Option options) {
 	Plt_Application *application = malloc(sizeof(Plt_Application));
+	plt_trace_set_thread_name("Main Thread");
 
 	application->clear_color = plt_color8_make(80,80,80,255);
-	application->scale = scale;
+	application->scale = plt_max(scale, 1);
+	application->dynamic_resolution = false;
+	application->min_scale = 1.0f;
+	application->max_scale = 4.0f;
+	application->smoothed_render_ms = 0.0f;
+	application->scale_cooldown = 0;
+	application->blit_columns = NULL;
+	application->blit_columns_width = 0;
+	application->blit_columns_scale = 0.0f;
+	application->blit_regions = NULL;
+	application->blit_window_rects = NULL;
+	application->blit_region_count = 0;
+	application->pipelined_frames = false;
+	application->frame_in_flight = false;
+	application->render_thread_ms = 0.0f;
 	
 	if (SDL_Init(0)) {
 		plt_abort("Failed initialising SDL.\n");
@@ -76,21 +136,34 @@ Plt_Application *plt_application_create(const char *title, unsigned int width, u
 	};
 	application->renderer = plt_renderer_create(application, application->framebuffer);
 
+	application->blit_thread_count = plt_platform_get_core_count();
+	plt_assert(application->blit_thread_count > 0, "No cores detected on device\n");
+	application->blit_thread_pool = plt_thread_pool_create(_blit_thread, application, application->blit_thread_count);
+	application->render_thread_pool = plt_thread_pool_create(_render_thread, application, 1);
+
 	plt_input_state_initialise(&application->input_state);
 
 	application->millis_at_creation = plt_application_current_milliseconds();
-	application->millis_at_since_last_update = plt_application_current_milliseconds();
-	application->millis_since_world_last_update = plt_application_current_milliseconds();
+	plt_frame_scheduler_initialise(&application->frame_scheduler, 60);
 	plt_application_set_target_fps(application, 60);
 
 	application->framebuffer_surface = NULL;
+	application->window_surface = NULL;
+	application->window_pixels = NULL;
 	plt_application_update_framebuffer(application);
 
 	return application;
 }
 
 void plt_application_destroy(Plt_Application **application) {
+	plt_application_finish_pipelined_frame(*application);
+	plt_thread_pool_destroy(&(*application)->render_thread_pool);
 	plt_renderer_destroy(&(*application)->renderer);
+	plt_thread_pool_destroy(&(*application)->blit_thread_pool);
+	if ((*application)->blit_columns) {
+		free((*application)->blit_columns);
+	}
+	plt_frame_scheduler_destroy(&(*application)->frame_scheduler);
 	SDL_DestroyWindow((*application)->window);
 	free(*application);
 	*application = NULL;
@@ -101,16 +174,16 @@ bool plt_application_should_close(Plt_Application *application) {
 }
 
 void plt_application_update(Plt_Application *application) {
-	double current_millis = plt_application_current_milliseconds();
-	float delta_time = current_millis - application->millis_since_world_last_update;
-	application->millis_since_world_last_update = current_millis;
+	float delta_time = plt_frame_scheduler_begin_frame(&application->frame_scheduler);
+	plt_trace_begin("Frame");
 	
 	Plt_Frame_State frame_state = {
 		.delta_time = delta_time,
-		.application_time = plt_application_get_milliseconds_since_creation(application),
+		.application_time = application->frame_scheduler.elapsed_ms,
 		.input_state = &application->input_state
 	};
 	
+	plt_trace_begin("Poll Input");
 	application->input_state.mouse_movement = (Plt_Vector2f){0, 0};
 	SDL_Event event;
 	while (SDL_PollEvent(&event)) {
@@ -129,33 +202,96 @@ void plt_application_update(Plt_Application *application) {
 			plt_input_state_set_mouse_button_up(&application->input_state, plt_mouse_button_from_sdl_mouse_index(event.button.button));
 		}
 	}
+	plt_trace_end("Poll Input");
 
-	plt_application_update_framebuffer(application);
+	if (application->pipelined_frames) {
+		plt_application_update_pipelined(application, frame_state);
+	} else {
+		plt_application_update_framebuffer(application);
+
+		if (application->world) {
+			double update_start = plt_application_current_milliseconds();
+			plt_world_update(application->world, frame_state);
+
+			double render_start = plt_application_current_milliseconds();
+			plt_renderer_clear(application->renderer, application->clear_color);
+			plt_world_render(application->world, frame_state, application->renderer);
+			plt_renderer_execute(application->renderer);
+			plt_trace_begin("Present");
+			plt_renderer_present(application->renderer);
+			plt_trace_end("Present");
+			double render_end = plt_application_current_milliseconds();
+
+			if (application->dynamic_resolution) {
+				plt_application_update_render_scale(application, render_start - update_start, render_end - render_start);
+			}
+		}
+	}
+	plt_trace_end("Frame");
 
+	plt_trace_begin("Wait For Next Frame");
+	plt_frame_scheduler_wait_for_next_frame(&application->frame_scheduler);
+	plt_trace_end("Wait For Next Frame");
+}
+
+void *_render_thread(unsigned int thread_id, void *thread_data) {
+	Plt_Application *application = thread_data;
+	plt_trace_set_thread_name("Render Thread");
+	double start = plt_application_current_milliseconds();
+	plt_renderer_execute_submitted(application->renderer);
+	application->render_thread_ms = plt_application_current_milliseconds() - start;
+	return NULL;
+}
+
+// Waits for the frame rendering in the background and presents it, returns the time spent presenting
+float plt_application_finish_pipelined_frame(Plt_Application *application) {
+	if (!application->frame_in_flight) {
+		return 0.0f;
+	}
+
+	plt_trace_begin("Wait For Render Thread");
+	plt_thread_pool_wait_until_complete(application->render_thread_pool);
+	plt_trace_end("Wait For Render Thread");
+	application->frame_in_flight = false;
+
+	plt_trace_begin("Present");
+	double present_start = plt_application_current_milliseconds();
+	plt_renderer_present(application->renderer);
+	double present_ms = plt_application_current_milliseconds() - present_start;
+	plt_trace_end("Present");
+	return present_ms;
+}
+
+void plt_application_update_pipelined(Plt_Application *application, Plt_Frame_State frame_state) {
+	// Simulate and record this frame while the last one is still rasterising
 	if (application->world) {
 		plt_world_update(application->world, frame_state);
-
 		plt_renderer_clear(application->renderer, application->clear_color);
 		plt_world_render(application->world, frame_state, application->renderer);
-		plt_renderer_execute(application->renderer);
-		plt_renderer_present(application->renderer);
 	}
 
-	double time = plt_application_current_milliseconds();
-	double frame_time = time - application->millis_at_since_last_update;
-	double wait_time_ms = plt_max(application->target_frame_ms - frame_time, 0);
-#if PLT_PLATFORM_WINDOWS
-	Sleep(wait_time_ms);
-#else
-	usleep(wait_time_ms * 880);
-#endif
-	application->millis_at_since_last_update = plt_application_current_milliseconds();
+	bool finished_frame = application->frame_in_flight;
+	float present_ms = plt_application_finish_pipelined_frame(application);
+
+	// Nothing is rendering now, so the framebuffer can safely change
+	plt_application_update_framebuffer(application);
+
+	if (application->world) {
+		plt_renderer_submit(application->renderer);
+		plt_thread_pool_signal_data_ready(application->render_thread_pool);
+		application->frame_in_flight = true;
+	}
+
+	// Updates overlap rendering, so rendering gets the whole frame
+	if (application->dynamic_resolution && finished_frame) {
+		plt_application_update_render_scale(application, 0.0f, application->render_thread_ms + present_ms);
+	}
 }
 
 void plt_application_update_framebuffer(Plt_Application *application) {
 	SDL_Surface *window_surface = SDL_GetWindowSurface(application->window);
 
-	if (application->scale == 1) {
+	if (application->scale == 1.0f) {
 		application->framebuffer = (Plt_Framebuffer) {
 			.pixels = window_surface->pixels,
 			.width = window_surface->w,
@@ -184,6 +320,13 @@ void plt_application_update_framebuffer(Plt_Application *application) {
 	}
 	
 	plt_renderer_update_framebuffer(application->renderer, application->framebuffer);
+	
+	// Unchanged tiles are only skipped while the window keeps what was presented last
+	if ((window_surface != application->window_surface) || (window_surface->pixels != application->window_pixels)) {
+		application->window_surface = window_surface;
+		application->window_pixels = window_surface->pixels;
+		plt_renderer_invalidate_framebuffer(application->renderer);
+	}
 }
 
 SDL_Window *plt_application_get_sdl_window(Plt_Application *application) {
@@ -207,6 +350,7 @@ Plt_World *plt_application_get_world(Plt_Application *application) {
 }
 
 void plt_application_set_target_fps(Plt_Application *application, unsigned int fps) {
+	plt_frame_scheduler_set_target_fps(&application->frame_scheduler, fps);
 	application->target_fps = fps;
 	application->target_frame_ms = 1000.0f/(float)fps;
 }
@@ -215,57 +359,285 @@ unsigned int plt_application_get_target_fps(Plt_Application *application) {
 	return application->target_fps;
 }
 
+void plt_application_set_frame_pacing(Plt_Application *application, Plt_Frame_Pacing pacing) {
+	plt_frame_scheduler_set_pacing(&application->frame_scheduler, pacing);
+}
+
+Plt_Frame_Timing plt_application_get_frame_timing(Plt_Application *application) {
+	return plt_frame_scheduler_get_timing(&application->frame_scheduler);
+}
+
+void plt_application_set_dynamic_resolution(Plt_Application *application, bool enabled) {
+	application->dynamic_resolution = enabled;
+	application->smoothed_render_ms = 0.0f;
+	application->scale_cooldown = 0;
+}
+
+void plt_application_set_render_scale_bounds(Plt_Application *application, float min_scale, float max_scale) {
+	plt_assert((min_scale >= 1.0f) && (max_scale >= min_scale), "Render scale bounds must satisfy 1 <= min <= max.\n");
+	application->min_scale = min_scale;
+	application->max_scale = max_scale;
+	if (application->dynamic_resolution) {
+		application->scale = plt_clamp(application->scale, min_scale, max_scale);
+	}
+}
+
+float plt_application_get_render_scale(Plt_Application *application) {
+	return application->scale;
+}
+
+void plt_application_set_pipelined_frames(Plt_Application *application, bool enabled) {
+	if (!enabled) {
+		plt_application_finish_pipelined_frame(application);
+	}
+	application->pipelined_frames = enabled;
+}
+
+// Rendered pixels go with 1 / scale^2, so the scale that fits the budget is the square root of how far over it we are
+void plt_application_update_render_scale(Plt_Application *application, float update_ms, float render_ms) {
+	if (application->smoothed_render_ms == 0.0f) {
+		application->smoothed_render_ms = render_ms;
+	}
+	application->smoothed_render_ms = application->smoothed_render_ms * 0.8f + render_ms * 0.2f;
+
+	if (application->scale_cooldown > 0) {
+		--application->scale_cooldown;
+		return;
+	}
+
+	float budget = plt_max(application->target_frame_ms - update_ms, 1.0f) * PLT_DYNAMIC_RESOLUTION_HEADROOM;
+	float smoothed = application->smoothed_render_ms;
+	float desired;
+	if (smoothed > budget) {
+		desired = application->scale * sqrtf(smoothed / budget);
+	} else if (smoothed < budget * PLT_DYNAMIC_RESOLUTION_SHARPEN_THRESHOLD) {
+		// Aim a little under budget when sharpening so we don't immediately bounce back
+		desired = application->scale * sqrtf(smoothed / (budget * 0.8f));
+	} else {
+		return;
+	}
+
+	desired = roundf(desired / PLT_DYNAMIC_RESOLUTION_SCALE_STEP) * PLT_DYNAMIC_RESOLUTION_SCALE_STEP;
+	desired = plt_clamp(desired, application->min_scale, application->max_scale);
+	if (desired == application->scale) {
+		return;
+	}
+
+	// Predict render time at the new resolution until it has been measured
+	float ratio = application->scale / desired;
+	application->smoothed_render_ms = smoothed * ratio * ratio;
+	application->scale = desired;
+	application->scale_cooldown = PLT_DYNAMIC_RESOLUTION_COOLDOWN_FRAMES;
+}
+
 double plt_application_current_milliseconds() {
-#if PLT_PLATFORM_WINDOWS
-	clock_t c = clock();
-	double elapsed = ((double)c) / CLOCKS_PER_SEC * 1000.0;
-	return elapsed;
-#elif PLT_PLATFORM_UNIX
-	struct timespec curTime;
-	clock_gettime(CLOCK_MONOTONIC, &curTime);
-	return (curTime.tv_sec * 1000.0) + (curTime.tv_nsec / 1000000.0);
-#endif
+	return plt_platform_get_time_ns() / 1000000.0;
 }
 
 float plt_application_get_milliseconds_since_creation(Plt_Application *application) {
 	return plt_application_current_milliseconds() - application->millis_at_creation;
 }
 
-// TODO: Create macro-defined versions of this for different scales
-void plt_application_fast_blit(Plt_Application *application) {
+// Nearest neighbour stretch for fractional scales, every window pixel takes the framebuffer pixel under its centre
+SDL_Rect plt_application_fractional_blit(Plt_Application *application, Plt_Rect region) {
 	Plt_Color8 *src_pixels = application->framebuffer.pixels;
 	unsigned int src_width = application->framebuffer.width;
 	unsigned int src_height = application->framebuffer.height;
 	
+	SDL_Surface *dest_surface = SDL_GetWindowSurface(application->window);
+	Plt_Color8 *dest_pixels = dest_surface->pixels;
+	int dest_width = dest_surface->w;
+	int dest_height = dest_surface->h;
+	
+	float scale = application->scale;
+	if ((application->blit_columns_width != dest_width) || (application->blit_columns_scale != scale)) {
+		if (application->blit_columns) {
+			free(application->blit_columns);
+		}
+		application->blit_columns = malloc(sizeof(unsigned int) * dest_width);
+		for (int x = 0; x < dest_width; ++x) {
+			application->blit_columns[x] = plt_min((unsigned int)((x + 0.5f) / scale), src_width - 1);
+		}
+		application->blit_columns_width = dest_width;
+		application->blit_columns_scale = scale;
+	}
+	const unsigned int *columns = application->blit_columns;
+	
+	// Window pixels whose centres land in the region, plus one either side to absorb rounding
+	int dest_min_x = plt_max((int)ceilf(region.x * scale - 0.5f) - 1, 0);
+	int dest_min_y = plt_max((int)ceilf(region.y * scale - 0.5f) - 1, 0);
+	int dest_max_x = plt_min((int)ceilf((region.x + region.width) * scale - 0.5f) + 1, dest_width);
+	int dest_max_y = plt_min((int)ceilf((region.y + region.height) * scale - 0.5f) + 1, dest_height);
+	if ((dest_min_x >= dest_max_x) || (dest_min_y >= dest_max_y)) {
+		return (SDL_Rect){ 0, 0, 0, 0 };
+	}
+	unsigned int dest_region_width = dest_max_x - dest_min_x;
+	
+	unsigned int previous_sy = src_height;
+	Plt_Color8 *previous_row = NULL;
+	for (int y = dest_min_y; y < dest_max_y; ++y) {
+		unsigned int sy = plt_min((unsigned int)((y + 0.5f) / scale), src_height - 1);
+		Plt_Color8 *dest_row = dest_pixels + y * dest_width + dest_min_x;
+		
+		// Consecutive window rows often sample the same framebuffer row
+		if (sy == previous_sy) {
+			memcpy(dest_row, previous_row, sizeof(Plt_Color8) * dest_region_width);
+			continue;
+		}
+		
+		const Plt_Color8 *src_row = src_pixels + sy * src_width;
+		for (unsigned int x = 0; x < dest_region_width; ++x) {
+			dest_row[x] = src_row[columns[dest_min_x + x]];
+		}
+		previous_sy = sy;
+		previous_row = dest_row;
+	}
+	
+	return (SDL_Rect){ dest_min_x, dest_min_y, dest_region_width, dest_max_y - dest_min_y };
+}
+
+// Stretches a framebuffer row across dest_count window pixels, four source pixels at a time.
+// The framebuffer is rounded up, so the last source pixel may only partly fit
+#define PLT_APPLICATION_DEFINE_STRETCH_ROW(factor) \
+static inline void plt_application_stretch_row_##factor##x(Plt_Color8 *dest, const Plt_Color8 *src, unsigned int dest_count) { \
+	unsigned int x = 0; \
+	for (; (x + 4) * factor <= dest_count; x += 4) { \
+		simd_int4_store_repeat##factor((int *)(dest + x * factor), simd_int4_load_unaligned((const int *)(src + x))); \
+	} \
+	for (unsigned int i = x * factor; i < dest_count; ++i) { \
+		dest[i] = src[i / factor]; \
+	} \
+}
+
+PLT_APPLICATION_DEFINE_STRETCH_ROW(2)
+PLT_APPLICATION_DEFINE_STRETCH_ROW(3)
+PLT_APPLICATION_DEFINE_STRETCH_ROW(4)
+
+// Window region covered by a framebuffer region at an integer scale
+SDL_Rect plt_application_get_window_rect(Plt_Application *application, Plt_Rect region) {
+	SDL_Surface *dest_surface = SDL_GetWindowSurface(application->window);
+	unsigned int scale_factor = application->scale;
+	
+	unsigned int dest_x = region.x * scale_factor;
+	unsigned int dest_y = region.y * scale_factor;
+	return (SDL_Rect) {
+		dest_x,
+		dest_y,
+		plt_min(region.width * scale_factor, dest_surface->w - dest_x),
+		plt_min(region.height * scale_factor, dest_surface->h - dest_y)
+	};
+}
+
+// Stretches framebuffer rows [first_row, last_row) of the region onto the window
+void plt_application_integer_blit_rows(Plt_Application *application, Plt_Rect region, SDL_Rect window_rect, unsigned int first_row, unsigned int last_row) {
+	Plt_Color8 *src_pixels = application->framebuffer.pixels;
+	unsigned int src_width = application->framebuffer.width;
+	
 	SDL_Surface *dest_surface = SDL_GetWindowSurface(application->window);
 	Plt_Color8 *dest_pixels = dest_surface->pixels;
 	unsigned int dest_width = dest_surface->w;
-	unsigned int dest_height = dest_surface->h;
 	
-	unsigned int scale_factor = dest_width/src_width;
+	unsigned int scale_factor = application->scale;
+	unsigned int dest_region_width = window_rect.w;
+	unsigned int dest_region_height = window_rect.h;
 	
-	for (unsigned int y = 0; y < src_height; ++y) {
-		unsigned int dy = y * scale_factor;
+	for (unsigned int row = first_row; row < last_row; ++row) {
+		unsigned int y = row * scale_factor;
+		if (y >= dest_region_height) {
+			break;
+		}
+		
+		const Plt_Color8 *src_row = src_pixels + (region.y + row) * src_width + region.x;
+		Plt_Color8 *dest_row = dest_pixels + (window_rect.y + y) * dest_width + window_rect.x;
 		
 		// Draw stretched row
-		for (unsigned int x = 0; x < src_width; ++x) {
-			unsigned int dx = x * scale_factor;
-			for (unsigned int i = 0; i < scale_factor; ++i) {
-				dest_pixels[dy * dest_width + dx + i] = src_pixels[y * src_width + x];
-			}
+		switch (scale_factor) {
+			case 2:
+				plt_application_stretch_row_2x(dest_row, src_row, dest_region_width);
+				break;
+			case 3:
+				plt_application_stretch_row_3x(dest_row, src_row, dest_region_width);
+				break;
+			case 4:
+				plt_application_stretch_row_4x(dest_row, src_row, dest_region_width);
+				break;
+			default:
+				for (unsigned int x = 0; x < dest_region_width; ++x) {
+					dest_row[x] = src_row[x / scale_factor];
+				}
+				break;
 		}
 		
 		// Repeat it
-		for (unsigned int i = 1; i < scale_factor; ++i) {
-			memcpy(dest_pixels + (dy + i) * dest_width, dest_pixels + dy * dest_width, sizeof(Plt_Color8) * dest_width);
+		for (unsigned int i = 1; (i < scale_factor) && (y + i < dest_region_height); ++i) {
+			memcpy(dest_row + i * dest_width, dest_row, sizeof(Plt_Color8) * dest_region_width);
+		}
+	}
+}
+
+// Each blit thread takes the same share of rows from every region
+void plt_application_integer_blit_share(Plt_Application *application, unsigned int thread_id, unsigned int thread_count) {
+	for (unsigned int i = 0; i < application->blit_region_count; ++i) {
+		Plt_Rect region = application->blit_regions[i];
+		unsigned int first_row = region.height * thread_id / thread_count;
+		unsigned int last_row = region.height * (thread_id + 1) / thread_count;
+		plt_application_integer_blit_rows(application, region, application->blit_window_rects[i], first_row, last_row);
+	}
+}
+
+void *_blit_thread(unsigned int thread_id, void *thread_data) {
+	Plt_Application *application = thread_data;
+	plt_trace_set_thread_name("Blit Worker");
+	plt_trace_begin("Blit");
+	plt_application_integer_blit_share(application, thread_id, application->blit_thread_count);
+	plt_trace_end("Blit");
+	return NULL;
+}
+
+// Stretches the given framebuffer regions onto the window, filling in the window region each covered
+void plt_application_fast_blit(Plt_Application *application, const Plt_Rect *regions, SDL_Rect *window_rects, unsigned int region_count) {
+	if (application->scale != floorf(application->scale)) {
+		for (unsigned int i = 0; i < region_count; ++i) {
+			window_rects[i] = plt_application_fractional_blit(application, regions[i]);
 		}
+		return;
+	}
+	
+	unsigned int pixel_count = 0;
+	for (unsigned int i = 0; i < region_count; ++i) {
+		window_rects[i] = plt_application_get_window_rect(application, regions[i]);
+		pixel_count += regions[i].width * regions[i].height;
+	}
+	
+	application->blit_regions = regions;
+	application->blit_window_rects = window_rects;
+	application->blit_region_count = region_count;
+	
+	// Waking the pool costs more than a handful of tiles
+	if (pixel_count < PLT_APPLICATION_THREADED_BLIT_MIN_PIXELS) {
+		plt_application_integer_blit_share(application, 0, 1);
+	} else {
+		plt_thread_pool_signal_data_ready(application->blit_thread_pool);
+		plt_thread_pool_wait_until_complete(application->blit_thread_pool);
 	}
 }
 
 void plt_application_present(Plt_Application *application) {
-	if (application->scale != 1) {
-		plt_application_fast_blit(application);
+	Plt_Rect dirty_rects[PLT_APPLICATION_MAX_DIRTY_RECTS];
+	unsigned int dirty_rect_count = plt_renderer_get_dirty_rects(application->renderer, dirty_rects, PLT_APPLICATION_MAX_DIRTY_RECTS);
+	if (dirty_rect_count == 0) {
+		return;
+	}
+	
+	SDL_Rect window_rects[PLT_APPLICATION_MAX_DIRTY_RECTS];
+	if (application->scale != 1.0f) {
+		plt_application_fast_blit(application, dirty_rects, window_rects, dirty_rect_count);
+	} else {
+		for (unsigned int i = 0; i < dirty_rect_count; ++i) {
+			Plt_Rect rect = dirty_rects[i];
+			window_rects[i] = (SDL_Rect){ rect.x, rect.y, rect.width, rect.height };
+		}
 	}
 
-	SDL_UpdateWindowSurface(application->window);
+	SDL_UpdateWindowSurfaceRects(application->window, window_rects, dirty_rect_count);
 }
@@ -0,0 +1,195 @@
+#include "plt_frame_scheduler.h"
+
+#include <math.h>
+#include <errno.h>
+#include "platypus/base/plt_platform.h"
+#include "platypus/base/plt_macros.h"
+
+#if PLT_PLATFORM_WINDOWS
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#elif PLT_PLATFORM_UNIX
+#include <time.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <xmmintrin.h>
+#endif
+
+// Sleeps are only trusted to wake within this long of when they were asked to, the rest of a wait is spun
+#if PLT_PLATFORM_WINDOWS
+#define PLT_FRAME_SCHEDULER_SPIN_NS 2000000ull
+#else
+#define PLT_FRAME_SCHEDULER_SPIN_NS 1000000ull
+#endif
+
+void plt_frame_scheduler_initialise(Plt_Frame_Scheduler *scheduler, unsigned int target_fps) {
+	scheduler->pacing = Plt_Frame_Pacing_Capped;
+	scheduler->next_frame_ns = 0;
+	scheduler->last_frame_begin_ns = plt_platform_get_time_ns();
+	scheduler->frame_count = 0;
+	scheduler->elapsed_ms = 0.0;
+	scheduler->missed_deadline_count = 0;
+	scheduler->frame_history_count = 0;
+	scheduler->frame_history_next = 0;
+	plt_frame_scheduler_set_target_fps(scheduler, target_fps);
+
+	// Sleep() only wakes on the system timer tick (15.6ms by default), which is most of a frame, so
+	// waits go through a high resolution timer instead. It needs Windows 10 1803, older versions fall back to Sleep()
+#if PLT_PLATFORM_WINDOWS
+	scheduler->wait_timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#else
+	scheduler->wait_timer = NULL;
+#endif
+}
+
+void plt_frame_scheduler_destroy(Plt_Frame_Scheduler *scheduler) {
+#if PLT_PLATFORM_WINDOWS
+	if (scheduler->wait_timer) {
+		CloseHandle(scheduler->wait_timer);
+	}
+#endif
+	scheduler->wait_timer = NULL;
+}
+
+void plt_frame_scheduler_set_target_fps(Plt_Frame_Scheduler *scheduler, unsigned int target_fps) {
+	plt_assert(target_fps > 0, "Target FPS must be greater than 0, use Plt_Frame_Pacing_Uncapped to run uncapped.\n");
+	scheduler->target_frame_ns = 1000000000ull / target_fps;
+}
+
+void plt_frame_scheduler_set_pacing(Plt_Frame_Scheduler *scheduler, Plt_Frame_Pacing pacing) {
+	scheduler->pacing = pacing;
+	scheduler->next_frame_ns = 0;
+}
+
+float plt_frame_scheduler_begin_frame(Plt_Frame_Scheduler *scheduler) {
+	uint64_t now = plt_platform_get_time_ns();
+	float interval_ms = (now - scheduler->last_frame_begin_ns) / 1000000.0f;
+	scheduler->last_frame_begin_ns = now;
+
+	// The first interval covers start up rather than a frame
+	if (scheduler->frame_count > 0) {
+		scheduler->frame_history_ms[scheduler->frame_history_next] = interval_ms;
+		scheduler->frame_history_next = (scheduler->frame_history_next + 1) % PLT_FRAME_SCHEDULER_HISTORY_LENGTH;
+		scheduler->frame_history_count = plt_min(scheduler->frame_history_count + 1, PLT_FRAME_SCHEDULER_HISTORY_LENGTH);
+	}
+	scheduler->frame_count++;
+
+	// Deadlines follow on from each other so the cadence holds, unless this frame started
+	// so late that the next is already due, then pacing restarts from now
+	scheduler->next_frame_ns += scheduler->target_frame_ns;
+	if (scheduler->next_frame_ns <= now) {
+		scheduler->next_frame_ns = now + scheduler->target_frame_ns;
+	}
+
+	float delta_time = interval_ms;
+	if (scheduler->pacing == Plt_Frame_Pacing_Benchmark) {
+		delta_time = scheduler->target_frame_ns / 1000000.0f;
+	}
+	scheduler->elapsed_ms += delta_time;
+	return delta_time;
+}
+
+static inline void plt_frame_scheduler_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+	_mm_pause();
+#elif defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#elif PLT_PLATFORM_WINDOWS
+	YieldProcessor();
+#endif
+}
+
+static void plt_frame_scheduler_sleep_until(Plt_Frame_Scheduler *scheduler, uint64_t time_ns) {
+	// Only the Windows wait uses the scheduler's timer
+	(void)scheduler;
+
+#if PLT_PLATFORM_LINUX
+	struct timespec deadline = {
+		.tv_sec = time_ns / 1000000000ull,
+		.tv_nsec = time_ns % 1000000000ull
+	};
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {}
+#elif PLT_PLATFORM_UNIX
+	uint64_t now = plt_platform_get_time_ns();
+	if (time_ns > now) {
+		struct timespec duration = {
+			.tv_sec = (time_ns - now) / 1000000000ull,
+			.tv_nsec = (time_ns - now) % 1000000000ull
+		};
+		nanosleep(&duration, NULL);
+	}
+#elif PLT_PLATFORM_WINDOWS
+	HANDLE timer = scheduler->wait_timer;
+	uint64_t now = plt_platform_get_time_ns();
+	if (time_ns <= now) {
+		return;
+	}
+
+	if (timer) {
+		// Relative due times are negative, in 100ns units
+		LARGE_INTEGER due_time = { .QuadPart = -(LONGLONG)((time_ns - now) / 100ull) };
+		if (SetWaitableTimerEx(timer, &due_time, 0, NULL, NULL, NULL, 0)) {
+			WaitForSingleObject(timer, INFINITE);
+			return;
+		}
+	}
+	Sleep((DWORD)((time_ns - now) / 1000000ull));
+#endif
+}
+
+void plt_frame_scheduler_wait_for_next_frame(Plt_Frame_Scheduler *scheduler) {
+	if (scheduler->pacing != Plt_Frame_Pacing_Capped) {
+		return;
+	}
+
+	uint64_t now = plt_platform_get_time_ns();
+	if (now >= scheduler->next_frame_ns) {
+		scheduler->missed_deadline_count++;
+		return;
+	}
+
+	// Sleep through most of the wait, then spin so waking up late doesn't eat into the next frame
+	if (scheduler->next_frame_ns - now > PLT_FRAME_SCHEDULER_SPIN_NS) {
+		plt_frame_scheduler_sleep_until(scheduler, scheduler->next_frame_ns - PLT_FRAME_SCHEDULER_SPIN_NS);
+	}
+	while (plt_platform_get_time_ns() < scheduler->next_frame_ns) {
+		plt_frame_scheduler_relax();
+	}
+}
+
+Plt_Frame_Timing plt_frame_scheduler_get_timing(Plt_Frame_Scheduler *scheduler) {
+	Plt_Frame_Timing timing = {
+		.last_frame_ms = 0.0f,
+		.mean_frame_ms = 0.0f,
+		.max_frame_ms = 0.0f,
+		.jitter_ms = 0.0f,
+		.missed_deadline_count = scheduler->missed_deadline_count
+	};
+
+	unsigned int count = scheduler->frame_history_count;
+	if (count == 0) {
+		return timing;
+	}
+
+	unsigned int last = (scheduler->frame_history_next + PLT_FRAME_SCHEDULER_HISTORY_LENGTH - 1) % PLT_FRAME_SCHEDULER_HISTORY_LENGTH;
+	timing.last_frame_ms = scheduler->frame_history_ms[last];
+
+	float total = 0.0f;
+	for (unsigned int i = 0; i < count; ++i) {
+		total += scheduler->frame_history_ms[i];
+		timing.max_frame_ms = plt_max(timing.max_frame_ms, scheduler->frame_history_ms[i]);
+	}
+	timing.mean_frame_ms = total / count;
+
+	float variance = 0.0f;
+	for (unsigned int i = 0; i < count; ++i) {
+		float deviation = scheduler->frame_history_ms[i] - timing.mean_frame_ms;
+		variance += deviation * deviation;
+	}
+	timing.jitter_ms = sqrtf(variance / count);
+
+	return timing;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include "platypus/platypus.h"
+
+// Frame intervals kept for the jitter statistics
+#define PLT_FRAME_SCHEDULER_HISTORY_LENGTH 120
+
+typedef struct Plt_Frame_Scheduler {
+	Plt_Frame_Pacing pacing;
+
+	// Length of a frame at the target FPS, also the fixed delta time handed out when benchmarking
+	uint64_t target_frame_ns;
+
+	// Absolute time the next frame should begin at, frames are paced against this rather
+	// than the end of the last wait so oversleeping doesn't accumulate
+	uint64_t next_frame_ns;
+
+	uint64_t last_frame_begin_ns;
+	uint64_t frame_count;
+	unsigned int missed_deadline_count;
+
+	// Sum of the delta times handed out
+	double elapsed_ms;
+
+	// Ring of the most recent frame intervals
+	float frame_history_ms[PLT_FRAME_SCHEDULER_HISTORY_LENGTH];
+	unsigned int frame_history_count;
+	unsigned int frame_history_next;
+
+	// High resolution waitable timer sleeps wait on (Windows only), NULL where unavailable
+	void *wait_timer;
+} Plt_Frame_Scheduler;
+
+void plt_frame_scheduler_initialise(Plt_Frame_Scheduler *scheduler, unsigned int target_fps);
+
+// Releases what initialise acquired, the scheduler itself belongs to the caller
+void plt_frame_scheduler_destroy(Plt_Frame_Scheduler *scheduler);
+void plt_frame_scheduler_set_target_fps(Plt_Frame_Scheduler *scheduler, unsigned int target_fps);
+void plt_frame_scheduler_set_pacing(Plt_Frame_Scheduler *scheduler, Plt_Frame_Pacing pacing);
+
+// Starts a frame, returning the delta time to simulate it with (milliseconds)
+float plt_frame_scheduler_begin_frame(Plt_Frame_Scheduler *scheduler);
+
+// Blocks until the next frame is due, returns straight away unless capped
+void plt_frame_scheduler_wait_for_next_frame(Plt_Frame_Scheduler *scheduler);
+
+Plt_Frame_Timing plt_frame_scheduler_get_timing(Plt_Frame_Scheduler *scheduler);
@@ -28,6 +28,9 @@ void plt_linear_allocator_destroy(Plt_Linear_Allocator **allocator) {
 }
 
 void *plt_linear_allocator_alloc(Plt_Linear_Allocator *allocator, size_t length) {
+	// Keep every allocation aligned for SIMD loads/stores
+	length = (length + PLT_LINEAR_ALLOCATOR_ALIGNMENT - 1) & ~(size_t)(PLT_LINEAR_ALLOCATOR_ALIGNMENT - 1);
+
 	plt_assert(allocator->heap_ptr + length < allocator->capacity, "Linear allocator exhausted.");
 	void *allocation = ((char *)allocator->heap) + allocator->heap_ptr;
 	allocator->heap_ptr += length;
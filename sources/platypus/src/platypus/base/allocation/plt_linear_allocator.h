@@ -3,6 +3,8 @@
 #include "platypus/platypus.h"
 #include <stdlib.h>
 
+#define PLT_LINEAR_ALLOCATOR_ALIGNMENT 16
+
 typedef struct Plt_Linear_Allocator Plt_Linear_Allocator;
 
 Plt_Linear_Allocator *plt_linear_allocator_create(size_t capacity);
@@ -1,10 +1,7 @@
 #pragma once
 
-// Toggle debug timer console output
-#define PLT_DEBUG_TIMERS 0
-
-// Toggle rendering thread IDs by colour
-#define PLT_DEBUG_RASTER_THREAD_ID 0
+// Compile in trace event recording, events are still only recorded once enabled with plt_trace_set_enabled
+#define PLT_TRACE_EVENTS 1
 
 // Toggle debug rendering of collision shapes 
 #define PLT_DEBUG_COLLIDERS 1
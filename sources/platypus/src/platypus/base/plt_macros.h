@@ -45,20 +45,3 @@ static inline double plt_get_millis() {
 	return (curTime.tv_sec * 1000.0) + (curTime.tv_nsec / 1000000.0);
 #endif
 }
-
-#if PLT_DEBUG_TIMERS
-	static int _plt_timer_depth = 0;
-
-	#define plt_timer_start(timer_name) \
-	_plt_timer_depth++; \
-	double timer_name = plt_get_millis();
-
-	#define plt_timer_end(timer_name, string_name) \
-	_plt_timer_depth--; \
-	for (int i = 0; i < _plt_timer_depth; ++i) { printf("  "); } \
-	if (_plt_timer_depth > 0) { printf("- "); }\
-	printf("%s completed in %.2lfms\n", string_name, plt_get_millis() - timer_name);
-#else
-	#define plt_timer_start(timer_name)
-	#define plt_timer_end(timer_name, string_name)
-#endif
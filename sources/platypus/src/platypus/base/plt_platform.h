@@ -12,13 +12,30 @@
 #define PLT_PLATFORM_UNKNOWN 1
 #endif
 
+#include <stdlib.h>
+#include <stdint.h>
+
 #if PLT_PLATFORM_UNIX
 #include <unistd.h>
+#include <time.h>
 #elif PLT_PLATFORM_WINDOWS
 #include <windows.h>
+#include <psapi.h>
+#include <malloc.h>
+#include <intrin.h>
+#endif
+
+#if PLT_PLATFORM_MACOS
+#include <mach/mach.h>
+#elif PLT_PLATFORM_LINUX
+#include <stdio.h>
 #endif
 
-const static unsigned int plt_platform_get_core_count() {
+#if (defined(__x86_64__) || defined(__i386__)) && !PLT_PLATFORM_WINDOWS
+#include <x86intrin.h>
+#endif
+
+static inline unsigned int plt_platform_get_core_count() {
 #if PLT_PLATFORM_UNIX
 	return sysconf(_SC_NPROCESSORS_ONLN);
 #elif PLT_PLATFORM_WINDOWS
@@ -29,4 +46,88 @@ const static unsigned int plt_platform_get_core_count() {
 	// Unsupported platform, return 1 by default.
 	return 1;
 #endif
-}
\ No newline at end of file
+}
+
+// Alignment must be a power of two multiple of sizeof(void *), free with plt_platform_aligned_free
+static inline void *plt_platform_aligned_alloc(size_t size, size_t alignment) {
+#if PLT_PLATFORM_WINDOWS
+	return _aligned_malloc(size, alignment);
+#else
+	void *allocation = NULL;
+	if (posix_memalign(&allocation, alignment, size) != 0) {
+		return NULL;
+	}
+	return allocation;
+#endif
+}
+
+static inline void plt_platform_aligned_free(void *allocation) {
+#if PLT_PLATFORM_WINDOWS
+	_aligned_free(allocation);
+#else
+	free(allocation);
+#endif
+}
+
+// Monotonic clock (nanoseconds)
+static inline uint64_t plt_platform_get_time_ns() {
+#if PLT_PLATFORM_WINDOWS
+	static LARGE_INTEGER frequency = { 0 };
+	if (frequency.QuadPart == 0) {
+		QueryPerformanceFrequency(&frequency);
+	}
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+
+	// Split the conversion so the counter can't overflow when scaled
+	uint64_t seconds = counter.QuadPart / frequency.QuadPart;
+	uint64_t remainder = counter.QuadPart % frequency.QuadPart;
+	return seconds * 1000000000ull + remainder * 1000000000ull / frequency.QuadPart;
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * 1000000000ull + time.tv_nsec;
+#endif
+}
+
+// Cycle counter (timer ticks on ARM), only meaningful as the difference between two reads on the same thread
+static inline uint64_t plt_platform_get_cycle_count() {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#elif defined(__aarch64__)
+	uint64_t ticks;
+	__asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+	return ticks;
+#else
+	return plt_platform_get_time_ns();
+#endif
+}
+
+// Physical memory the process is using (bytes), 0 where it can't be queried
+static inline size_t plt_platform_get_resident_memory() {
+#if PLT_PLATFORM_MACOS
+	mach_task_basic_info_data_t info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+	if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+		return 0;
+	}
+	return info.resident_size;
+#elif PLT_PLATFORM_LINUX
+	FILE *file = fopen("/proc/self/statm", "r");
+	if (!file) {
+		return 0;
+	}
+	unsigned long total_pages, resident_pages;
+	int read_count = fscanf(file, "%lu %lu", &total_pages, &resident_pages);
+	fclose(file);
+	return (read_count == 2) ? (size_t)resident_pages * sysconf(_SC_PAGESIZE) : 0;
+#elif PLT_PLATFORM_WINDOWS
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return 0;
+	}
+	return counters.WorkingSetSize;
+#else
+	return 0;
+#endif
+}
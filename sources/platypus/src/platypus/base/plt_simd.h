@@ -1,4 +1,6 @@
 #pragma once
+#include <math.h>
+#include <string.h>
 #include "plt_platform.h"
 
 #ifdef __aarch64__
@@ -32,16 +34,41 @@ typedef struct simd_float4 {
 static simd_float4 simd_float4_create(float x, float y, float z, float w);
 static simd_float4 simd_float4_create_scalar(float v);
 static simd_float4 simd_float4_load(float *p);
+static void simd_float4_store(float *p, simd_float4 v);
 
 // a + b
 static simd_float4 simd_float4_add(simd_float4 a, simd_float4 b);
 
+// a - b
+static simd_float4 simd_float4_subtract(simd_float4 a, simd_float4 b);
+
+// a * b
+static simd_float4 simd_float4_multiply(simd_float4 a, simd_float4 b);
+
+// a / b
+static simd_float4 simd_float4_divide(simd_float4 a, simd_float4 b);
+
 // a + b * c
 static simd_float4 simd_float4_multiply_add(simd_float4 a, simd_float4 b, simd_float4 c);
 
 // a[0] + a[1] + a[2] + a[3]
 static float simd_float4_add_across(simd_float4 v);
 
+// max(a, b)
+static simd_float4 simd_float4_max(simd_float4 a, simd_float4 b);
+
+// |v|
+static simd_float4 simd_float4_abs(simd_float4 v);
+
+// |magnitude| with the sign of sign
+static simd_float4 simd_float4_copy_sign(simd_float4 magnitude, simd_float4 sign);
+
+// Approximately 1 / sqrt(v), refined with one Newton-Raphson step (~23 bits)
+static simd_float4 simd_float4_reciprocal_sqrt(simd_float4 v);
+
+// Bit i of the result is set when a[i] <= b[i]
+static int simd_float4_less_equal_mask(simd_float4 a, simd_float4 b);
+
 // MARK: Int
 
 typedef struct simd_int4 {
@@ -63,11 +90,32 @@ typedef struct simd_int4 {
 static simd_int4 simd_int4_create(int x, int y, int z, int w);
 static simd_int4 simd_int4_create_scalar(int v);
 static simd_int4 simd_int4_load(int *p);
+static void simd_int4_store(int *p, simd_int4 v);
+
+// Unaligned load
+static simd_int4 simd_int4_load_unaligned(const int *p);
+
+// Unaligned store of each lane repeated 2, 3 or 4 times in a row (8, 12 or 16 ints)
+static void simd_int4_store_repeat2(int *p, simd_int4 v);
+static void simd_int4_store_repeat3(int *p, simd_int4 v);
+static void simd_int4_store_repeat4(int *p, simd_int4 v);
+
+// Widen four consecutive 16-bit unsigned or 8-bit signed values
+static simd_int4 simd_int4_load_u16(const unsigned short *p);
+static simd_int4 simd_int4_load_s8(const signed char *p);
 
 static simd_int4 simd_int4_add(simd_int4 a, simd_int4 b);
 static simd_int4 simd_int4_subtract(simd_int4 a, simd_int4 b);
 static simd_int4 simd_int4_multiply(simd_int4 a, simd_int4 b);
 
+// Truncates towards zero
+static simd_int4 simd_int4_from_float4(simd_float4 v);
+static simd_float4 simd_float4_from_int4(simd_int4 v);
+
+// Bilinearly blends four packed 8-bit x4 texels (x = top left, y = top right, z = bottom left, w = bottom right)
+// with 8-bit fractional weights fx, fy in [0, 256), all four channels at once in 16-bit lanes
+static unsigned int simd_int4_bilinear_u8(simd_int4 texels, unsigned int fx, unsigned int fy);
+
 // MARK: Implementation
 
 #ifdef PLT_PLATFORM_WINDOWS
@@ -83,13 +131,23 @@ simd_inline simd_float4 simd_float4_create(float x, float y, float z, float w) {
 }
 
 simd_inline simd_float4 simd_float4_create_scalar(float v) {
+	#ifdef NEON
+	return (simd_float4){ .neon_v = vdupq_n_f32(v) };
+	#elif SSE
+	return (simd_float4){ .sse_v = _mm_set1_ps(v) };
+	#else
 	return (simd_float4){v, v, v, v};
+	#endif
 }
 
 simd_inline simd_float4 simd_float4_load(float *p) {
 	return *((simd_float4 *)p);
 }
 
+simd_inline void simd_float4_store(float *p, simd_float4 v) {
+	*((simd_float4 *)p) = v;
+}
+
 simd_inline simd_float4 simd_float4_add(simd_float4 a, simd_float4 b) {
 	#ifdef NEON
 	return (simd_float4){ .neon_v = vaddq_f32(a.neon_v, b.neon_v) };
@@ -100,6 +158,36 @@ simd_inline simd_float4 simd_float4_add(simd_float4 a, simd_float4 b) {
 	#endif
 }
 
+simd_inline simd_float4 simd_float4_subtract(simd_float4 a, simd_float4 b) {
+	#ifdef NEON
+	return (simd_float4){ .neon_v = vsubq_f32(a.neon_v, b.neon_v) };
+	#elif SSE
+	return (simd_float4) { .sse_v = _mm_sub_ps(a.sse_v, b.sse_v) };
+	#else
+	return (simd_float4){ a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w };
+	#endif
+}
+
+simd_inline simd_float4 simd_float4_multiply(simd_float4 a, simd_float4 b) {
+	#ifdef NEON
+	return (simd_float4){ .neon_v = vmulq_f32(a.neon_v, b.neon_v) };
+	#elif SSE
+	return (simd_float4) { .sse_v = _mm_mul_ps(a.sse_v, b.sse_v) };
+	#else
+	return (simd_float4){ a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w };
+	#endif
+}
+
+simd_inline simd_float4 simd_float4_divide(simd_float4 a, simd_float4 b) {
+	#ifdef NEON
+	return (simd_float4){ .neon_v = vdivq_f32(a.neon_v, b.neon_v) };
+	#elif SSE
+	return (simd_float4) { .sse_v = _mm_div_ps(a.sse_v, b.sse_v) };
+	#else
+	return (simd_float4){ a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w };
+	#endif
+}
+
 simd_inline float simd_float4_add_across(simd_float4 v) {
 	#ifdef NEON
 	return vaddvq_f32(v.neon_v);
@@ -108,6 +196,61 @@ simd_inline float simd_float4_add_across(simd_float4 v) {
 	#endif
 }
 
+simd_inline simd_float4 simd_float4_max(simd_float4 a, simd_float4 b) {
+	#ifdef NEON
+	return (simd_float4){ .neon_v = vmaxq_f32(a.neon_v, b.neon_v) };
+	#elif SSE
+	return (simd_float4) { .sse_v = _mm_max_ps(a.sse_v, b.sse_v) };
+	#else
+	return (simd_float4){ fmaxf(a.x, b.x), fmaxf(a.y, b.y), fmaxf(a.z, b.z), fmaxf(a.w, b.w) };
+	#endif
+}
+
+simd_inline simd_float4 simd_float4_abs(simd_float4 v) {
+	#ifdef NEON
+	return (simd_float4){ .neon_v = vabsq_f32(v.neon_v) };
+	#elif SSE
+	return (simd_float4) { .sse_v = _mm_andnot_ps(_mm_set1_ps(-0.0f), v.sse_v) };
+	#else
+	return (simd_float4){ fabsf(v.x), fabsf(v.y), fabsf(v.z), fabsf(v.w) };
+	#endif
+}
+
+simd_inline simd_float4 simd_float4_copy_sign(simd_float4 magnitude, simd_float4 sign) {
+	#ifdef NEON
+	return (simd_float4){ .neon_v = vbslq_f32(vdupq_n_u32(0x80000000), sign.neon_v, vabsq_f32(magnitude.neon_v)) };
+	#elif SSE
+	__m128 sign_mask = _mm_set1_ps(-0.0f);
+	return (simd_float4) { .sse_v = _mm_or_ps(_mm_and_ps(sign_mask, sign.sse_v), _mm_andnot_ps(sign_mask, magnitude.sse_v)) };
+	#else
+	return (simd_float4){ copysignf(magnitude.x, sign.x), copysignf(magnitude.y, sign.y), copysignf(magnitude.z, sign.z), copysignf(magnitude.w, sign.w) };
+	#endif
+}
+
+simd_inline simd_float4 simd_float4_reciprocal_sqrt(simd_float4 v) {
+	#ifdef NEON
+	float32x4_t estimate = vrsqrteq_f32(v.neon_v);
+	return (simd_float4){ .neon_v = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(v.neon_v, estimate), estimate)) };
+	#elif SSE
+	// estimate * (1.5 - 0.5 * v * estimate^2)
+	__m128 estimate = _mm_rsqrt_ps(v.sse_v);
+	__m128 half_v_estimate_squared = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), v.sse_v), _mm_mul_ps(estimate, estimate));
+	return (simd_float4) { .sse_v = _mm_mul_ps(estimate, _mm_sub_ps(_mm_set1_ps(1.5f), half_v_estimate_squared)) };
+	#else
+	return (simd_float4){ 1.0f / sqrtf(v.x), 1.0f / sqrtf(v.y), 1.0f / sqrtf(v.z), 1.0f / sqrtf(v.w) };
+	#endif
+}
+
+simd_inline simd_float4 simd_float4_from_int4(simd_int4 v) {
+	#ifdef NEON
+	return (simd_float4){ .neon_v = vcvtq_f32_s32(v.neon_v) };
+	#elif SSE
+	return (simd_float4){ .sse_v = _mm_cvtepi32_ps(v.sse_v) };
+	#else
+	return (simd_float4){ (float)v.x, (float)v.y, (float)v.z, (float)v.w };
+	#endif
+}
+
 simd_inline simd_float4 simd_float4_multiply_add(simd_float4 a, simd_float4 b, simd_float4 c) {
 	#ifdef NEON
 	return (simd_float4) { .neon_v = vmlaq_f32(a.neon_v, b.neon_v, c.neon_v) };
@@ -119,6 +262,17 @@ simd_inline simd_float4 simd_float4_multiply_add(simd_float4 a, simd_float4 b, s
 	#endif
 }
 
+simd_inline int simd_float4_less_equal_mask(simd_float4 a, simd_float4 b) {
+	#ifdef NEON
+	const uint32_t bits[4] = { 1, 2, 4, 8 };
+	return vaddvq_u32(vandq_u32(vcleq_f32(a.neon_v, b.neon_v), vld1q_u32(bits)));
+	#elif SSE
+	return _mm_movemask_ps(_mm_cmple_ps(a.sse_v, b.sse_v));
+	#else
+	return (a.x <= b.x) | ((a.y <= b.y) << 1) | ((a.z <= b.z) << 2) | ((a.w <= b.w) << 3);
+	#endif
+}
+
 simd_inline simd_int4 simd_int4_create(int x, int y, int z, int w) {
 	return (simd_int4){x, y, z, w};
 }
@@ -131,6 +285,85 @@ simd_inline simd_int4 simd_int4_load(int *p) {
 	return *((simd_int4 *)p);
 }
 
+simd_inline void simd_int4_store(int *p, simd_int4 v) {
+	*((simd_int4 *)p) = v;
+}
+
+simd_inline simd_int4 simd_int4_load_unaligned(const int *p) {
+	#ifdef NEON
+	return (simd_int4){ .neon_v = vld1q_s32(p) };
+	#elif SSE
+	return (simd_int4){ .sse_v = _mm_loadu_si128((const __m128i *)p) };
+	#else
+	return (simd_int4){ p[0], p[1], p[2], p[3] };
+	#endif
+}
+
+simd_inline void simd_int4_store_repeat2(int *p, simd_int4 v) {
+	#ifdef NEON
+	vst2q_s32(p, (int32x4x2_t){{ v.neon_v, v.neon_v }});
+	#elif SSE
+	_mm_storeu_si128((__m128i *)p, _mm_unpacklo_epi32(v.sse_v, v.sse_v));
+	_mm_storeu_si128((__m128i *)(p + 4), _mm_unpackhi_epi32(v.sse_v, v.sse_v));
+	#else
+	for (unsigned int i = 0; i < 8; ++i) {
+		p[i] = v.v[i / 2];
+	}
+	#endif
+}
+
+simd_inline void simd_int4_store_repeat3(int *p, simd_int4 v) {
+	#ifdef NEON
+	vst3q_s32(p, (int32x4x3_t){{ v.neon_v, v.neon_v, v.neon_v }});
+	#elif SSE
+	_mm_storeu_si128((__m128i *)p, _mm_shuffle_epi32(v.sse_v, _MM_SHUFFLE(1, 0, 0, 0)));
+	_mm_storeu_si128((__m128i *)(p + 4), _mm_shuffle_epi32(v.sse_v, _MM_SHUFFLE(2, 2, 1, 1)));
+	_mm_storeu_si128((__m128i *)(p + 8), _mm_shuffle_epi32(v.sse_v, _MM_SHUFFLE(3, 3, 3, 2)));
+	#else
+	for (unsigned int i = 0; i < 12; ++i) {
+		p[i] = v.v[i / 3];
+	}
+	#endif
+}
+
+simd_inline void simd_int4_store_repeat4(int *p, simd_int4 v) {
+	#ifdef NEON
+	vst4q_s32(p, (int32x4x4_t){{ v.neon_v, v.neon_v, v.neon_v, v.neon_v }});
+	#elif SSE
+	_mm_storeu_si128((__m128i *)p, _mm_shuffle_epi32(v.sse_v, _MM_SHUFFLE(0, 0, 0, 0)));
+	_mm_storeu_si128((__m128i *)(p + 4), _mm_shuffle_epi32(v.sse_v, _MM_SHUFFLE(1, 1, 1, 1)));
+	_mm_storeu_si128((__m128i *)(p + 8), _mm_shuffle_epi32(v.sse_v, _MM_SHUFFLE(2, 2, 2, 2)));
+	_mm_storeu_si128((__m128i *)(p + 12), _mm_shuffle_epi32(v.sse_v, _MM_SHUFFLE(3, 3, 3, 3)));
+	#else
+	for (unsigned int i = 0; i < 16; ++i) {
+		p[i] = v.v[i / 4];
+	}
+	#endif
+}
+
+simd_inline simd_int4 simd_int4_load_u16(const unsigned short *p) {
+	#ifdef NEON
+	return (simd_int4){ .neon_v = vreinterpretq_s32_u32(vmovl_u16(vld1_u16(p))) };
+	#elif SSE
+	return (simd_int4){ .sse_v = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)p)) };
+	#else
+	return (simd_int4){ p[0], p[1], p[2], p[3] };
+	#endif
+}
+
+simd_inline simd_int4 simd_int4_load_s8(const signed char *p) {
+	#ifdef NEON
+	int8x8_t bytes = vreinterpret_s8_u32(vld1_dup_u32((const uint32_t *)p));
+	return (simd_int4){ .neon_v = vmovl_s16(vget_low_s16(vmovl_s8(bytes))) };
+	#elif SSE
+	int bits;
+	memcpy(&bits, p, sizeof(bits));
+	return (simd_int4){ .sse_v = _mm_cvtepi8_epi32(_mm_cvtsi32_si128(bits)) };
+	#else
+	return (simd_int4){ p[0], p[1], p[2], p[3] };
+	#endif
+}
+
 simd_inline simd_int4 simd_int4_add(simd_int4 a, simd_int4 b) {
 	#ifdef NEON
 	return (simd_int4){ .neon_v = vaddq_s32(a.neon_v, b.neon_v) };
@@ -160,3 +393,41 @@ simd_inline simd_int4 simd_int4_multiply(simd_int4 a, simd_int4 b) {
 	return (simd_int4){ a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w };
 	#endif
 }
+
+simd_inline simd_int4 simd_int4_from_float4(simd_float4 v) {
+	#ifdef NEON
+	return (simd_int4){ .neon_v = vcvtq_s32_f32(v.neon_v) };
+	#elif SSE
+	return (simd_int4){ .sse_v = _mm_cvttps_epi32(v.sse_v) };
+	#else
+	return (simd_int4){ (int)v.x, (int)v.y, (int)v.z, (int)v.w };
+	#endif
+}
+
+simd_inline unsigned int simd_int4_bilinear_u8(simd_int4 texels, unsigned int fx, unsigned int fy) {
+	#ifdef NEON
+	uint8x16_t bytes = vreinterpretq_u8_s32(texels.neon_v);
+	uint16x8_t top = vmovl_u8(vget_low_u8(bytes));
+	uint16x8_t bottom = vmovl_u8(vget_high_u8(bytes));
+	uint16x8_t vertical = vshrq_n_u16(vmlaq_n_u16(vmulq_n_u16(top, 256 - fy), bottom, fy), 8);
+	uint16x8_t horizontal = vmulq_u16(vertical, vcombine_u16(vdup_n_u16(256 - fx), vdup_n_u16(fx)));
+	uint16x4_t blended = vshr_n_u16(vadd_u16(vget_low_u16(horizontal), vget_high_u16(horizontal)), 8);
+	return vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(blended, blended))), 0);
+	#elif SSE
+	__m128i zero = _mm_setzero_si128();
+	__m128i top = _mm_unpacklo_epi8(texels.sse_v, zero);
+	__m128i bottom = _mm_unpackhi_epi8(texels.sse_v, zero);
+	__m128i vertical = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(top, _mm_set1_epi16(256 - fy)), _mm_mullo_epi16(bottom, _mm_set1_epi16(fy))), 8);
+	__m128i horizontal = _mm_mullo_epi16(vertical, _mm_set_epi16(fx, fx, fx, fx, 256 - fx, 256 - fx, 256 - fx, 256 - fx));
+	__m128i blended = _mm_srli_epi16(_mm_add_epi16(horizontal, _mm_srli_si128(horizontal, 8)), 8);
+	return _mm_cvtsi128_si32(_mm_packus_epi16(blended, blended));
+	#else
+	unsigned int result = 0;
+	for (unsigned int c = 0; c < 32; c += 8) {
+		unsigned int top = ((texels.x >> c) & 0xFF) * (256 - fx) + ((texels.y >> c) & 0xFF) * fx;
+		unsigned int bottom = ((texels.z >> c) & 0xFF) * (256 - fx) + ((texels.w >> c) & 0xFF) * fx;
+		result |= (((top * (256 - fy) + bottom * fy) >> 16) & 0xFF) << c;
+	}
+	return result;
+	#endif
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "platypus/base/plt_platform.h"
 #include "platypus/base/plt_macros.h"
+#include "platypus/base/trace/plt_trace.h"
 #include <stdlib.h>
 
 #if PLT_PLATFORM_UNIX
@@ -27,6 +28,8 @@ typedef struct Plt_Thread_Pool {
 	Plt_Thread_Pool_Private_Data *thread_private_data;
 
 	Plt_Thread_Signal *data_ready_signal;
+	unsigned int data_ready_generation;
+	bool should_exit;
 	
 	Plt_Thread_Mutex *completed_thread_mutex;
 	unsigned int completed_thread_count;
@@ -100,9 +103,27 @@ typedef struct Plt_Thread_Pool_Private_Data {
 void *_thread_pool_func(void *thread_data) {
 	Plt_Thread_Pool_Private_Data *data = thread_data;
 	Plt_Thread_Pool *pool = data->pool;
+	unsigned int processed_generation = 0;
 		
 	while (true) {
+#if PLT_PLATFORM_UNIX
+		// Wait on the generation counter rather than the bare condition so that a broadcast
+		// sent before this thread reached the wait (or a spurious wakeup) isn't lost/repeated.
+		pthread_mutex_lock(&pool->data_ready_signal->pmutex);
+		while ((pool->data_ready_generation == processed_generation) && !pool->should_exit) {
+			pthread_cond_wait(&pool->data_ready_signal->pcond, &pool->data_ready_signal->pmutex);
+		}
+		processed_generation = pool->data_ready_generation;
+		bool should_exit = pool->should_exit;
+		pthread_mutex_unlock(&pool->data_ready_signal->pmutex);
+#else
 		plt_thread_wait_for_signal(pool->data_ready_signal);
+		bool should_exit = pool->should_exit;
+#endif
+
+		if (should_exit) {
+			break;
+		}
 
 		pool->thread_func(data->thread_id, pool->thread_data);
 		
@@ -111,6 +132,7 @@ void *_thread_pool_func(void *thread_data) {
 		plt_thread_mutex_unlock(pool->completed_thread_mutex);
 	}
 
+	plt_trace_release_thread();
 	return NULL;
 }
 
@@ -121,6 +143,8 @@ Plt_Thread_Pool *plt_thread_pool_create(void *(*func)(unsigned int thread_id, vo
 	pool->thread_data = thread_data;
 	
 	pool->data_ready_signal = plt_thread_signal_create(thread_count);
+	pool->data_ready_generation = 0;
+	pool->should_exit = false;
 	pool->completed_thread_mutex = plt_thread_mutex_create();
 
 	pool->thread_func = func;
@@ -135,9 +159,24 @@ Plt_Thread_Pool *plt_thread_pool_create(void *(*func)(unsigned int thread_id, vo
 	return pool;
 }
 
+// Threads are woken and left to return on their own, cancelling them mid-wait would leave the signal's mutex held
 void plt_thread_pool_destroy(Plt_Thread_Pool **pool) {
+#if PLT_PLATFORM_UNIX
+	pthread_mutex_lock(&(*pool)->data_ready_signal->pmutex);
+	(*pool)->should_exit = true;
+	pthread_cond_broadcast(&(*pool)->data_ready_signal->pcond);
+	pthread_mutex_unlock(&(*pool)->data_ready_signal->pmutex);
+#else
+	(*pool)->should_exit = true;
+	plt_thread_signal_broadcast((*pool)->data_ready_signal);
+#endif
+
 	for (unsigned int i = 0; i < (*pool)->thread_count; ++i) {
-		plt_thread_destroy(&(*pool)->threads[i]);
+		plt_thread_wait_until_complete((*pool)->threads[i]);
+#if PLT_PLATFORM_WINDOWS
+		CloseHandle((*pool)->threads[i]->wthread);
+#endif
+		free((*pool)->threads[i]);
 	}
 	plt_thread_mutex_destroy(&(*pool)->completed_thread_mutex);
 	plt_thread_signal_destroy(&(*pool)->data_ready_signal);
@@ -150,7 +189,14 @@ void plt_thread_pool_destroy(Plt_Thread_Pool **pool) {
 
 void plt_thread_pool_signal_data_ready(Plt_Thread_Pool *pool) {
 	pool->completed_thread_count = 0;
+#if PLT_PLATFORM_UNIX
+	pthread_mutex_lock(&pool->data_ready_signal->pmutex);
+	pool->data_ready_generation++;
+	pthread_cond_broadcast(&pool->data_ready_signal->pcond);
+	pthread_mutex_unlock(&pool->data_ready_signal->pmutex);
+#else
 	plt_thread_signal_broadcast(pool->data_ready_signal);
+#endif
 }
 
 void plt_thread_pool_wait_until_complete(Plt_Thread_Pool *pool) {
@@ -0,0 +1,232 @@
+#include "plt_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "platypus/base/plt_platform.h"
+#include "platypus/base/plt_defines.h"
+#include "platypus/base/plt_macros.h"
+
+#if PLT_PLATFORM_WINDOWS
+#define PLT_TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#define PLT_TRACE_THREAD_LOCAL _Thread_local
+#endif
+
+typedef enum Plt_Trace_Event_Type {
+	Plt_Trace_Event_Type_Begin,
+	Plt_Trace_Event_Type_End,
+	Plt_Trace_Event_Type_Counter
+} Plt_Trace_Event_Type;
+
+typedef struct Plt_Trace_Event {
+	uint64_t timestamp_ns;
+	const char *name;
+	double value;
+	Plt_Trace_Event_Type type;
+} Plt_Trace_Event;
+
+// Only its own thread writes to a buffer. Events are written before write_count is published, so
+// anything older than write_count - PLT_TRACE_BUFFER_CAPACITY may already have been written over.
+// Once its thread exits a buffer is handed to the next new thread, which only keeps events from first_event on
+typedef struct Plt_Trace_Buffer {
+	struct Plt_Trace_Buffer *next;
+	atomic_bool in_use;
+	_Atomic unsigned int thread_index;
+	_Atomic(const char *) thread_name;
+
+	_Atomic uint64_t first_event;
+	_Atomic uint64_t write_count;
+	Plt_Trace_Event events[PLT_TRACE_BUFFER_CAPACITY];
+} Plt_Trace_Buffer;
+
+static atomic_bool plt_trace_enabled = false;
+
+// Buffers are pushed on the first event from a thread when none are free and live until the process exits,
+// threads leaving through plt_trace_release_thread free theirs up for reuse
+static _Atomic(Plt_Trace_Buffer *) plt_trace_buffers = NULL;
+static atomic_uint plt_trace_thread_count = 0;
+
+static PLT_TRACE_THREAD_LOCAL Plt_Trace_Buffer *plt_trace_thread_buffer = NULL;
+static PLT_TRACE_THREAD_LOCAL const char *plt_trace_thread_name = NULL;
+
+void plt_trace_set_enabled(bool enabled) {
+	atomic_store(&plt_trace_enabled, enabled);
+}
+
+bool plt_trace_is_enabled() {
+	return atomic_load_explicit(&plt_trace_enabled, memory_order_relaxed);
+}
+
+static Plt_Trace_Buffer *plt_trace_get_thread_buffer() {
+	if (plt_trace_thread_buffer) {
+		return plt_trace_thread_buffer;
+	}
+
+	// Take over the buffer of a thread that has exited, its old events are dropped
+	for (Plt_Trace_Buffer *buffer = atomic_load(&plt_trace_buffers); buffer; buffer = buffer->next) {
+		bool expected = false;
+		if (!atomic_load_explicit(&buffer->in_use, memory_order_relaxed) && atomic_compare_exchange_strong(&buffer->in_use, &expected, true)) {
+			atomic_store(&buffer->thread_index, atomic_fetch_add(&plt_trace_thread_count, 1));
+			atomic_store(&buffer->thread_name, plt_trace_thread_name);
+			atomic_store(&buffer->first_event, atomic_load_explicit(&buffer->write_count, memory_order_relaxed));
+			plt_trace_thread_buffer = buffer;
+			return buffer;
+		}
+	}
+
+	Plt_Trace_Buffer *buffer = malloc(sizeof(Plt_Trace_Buffer));
+	atomic_init(&buffer->in_use, true);
+	atomic_init(&buffer->thread_index, atomic_fetch_add(&plt_trace_thread_count, 1));
+	atomic_init(&buffer->thread_name, plt_trace_thread_name);
+	atomic_init(&buffer->first_event, 0);
+	atomic_init(&buffer->write_count, 0);
+
+	buffer->next = atomic_load(&plt_trace_buffers);
+	while (!atomic_compare_exchange_weak(&plt_trace_buffers, &buffer->next, buffer)) {}
+
+	plt_trace_thread_buffer = buffer;
+	return buffer;
+}
+
+static void plt_trace_record(Plt_Trace_Event_Type type, const char *name, double value) {
+#if PLT_TRACE_EVENTS
+	if (!atomic_load_explicit(&plt_trace_enabled, memory_order_relaxed)) {
+		return;
+	}
+
+	Plt_Trace_Buffer *buffer = plt_trace_get_thread_buffer();
+	uint64_t index = atomic_load_explicit(&buffer->write_count, memory_order_relaxed);
+	buffer->events[index & (PLT_TRACE_BUFFER_CAPACITY - 1)] = (Plt_Trace_Event) {
+		.timestamp_ns = plt_platform_get_time_ns(),
+		.name = name,
+		.value = value,
+		.type = type
+	};
+	atomic_store_explicit(&buffer->write_count, index + 1, memory_order_release);
+#endif
+}
+
+void plt_trace_begin(const char *name) {
+	plt_trace_record(Plt_Trace_Event_Type_Begin, name, 0.0);
+}
+
+void plt_trace_end(const char *name) {
+	plt_trace_record(Plt_Trace_Event_Type_End, name, 0.0);
+}
+
+void plt_trace_counter(const char *name, double value) {
+	plt_trace_record(Plt_Trace_Event_Type_Counter, name, value);
+}
+
+void plt_trace_set_thread_name(const char *name) {
+	plt_trace_thread_name = name;
+	if (plt_trace_thread_buffer) {
+		atomic_store(&plt_trace_thread_buffer->thread_name, name);
+	}
+}
+
+void plt_trace_release_thread() {
+	if (plt_trace_thread_buffer) {
+		atomic_store_explicit(&plt_trace_thread_buffer->in_use, false, memory_order_release);
+		plt_trace_thread_buffer = NULL;
+	}
+	plt_trace_thread_name = NULL;
+}
+
+static void plt_trace_write_json_string(FILE *file, const char *string) {
+	fputc('"', file);
+	for (const char *c = string; *c; ++c) {
+		if ((*c == '"') || (*c == '\\')) {
+			fputc('\\', file);
+			fputc(*c, file);
+		} else if ((unsigned char)*c < 0x20) {
+			fprintf(file, "\\u%04x", *c);
+		} else {
+			fputc(*c, file);
+		}
+	}
+	fputc('"', file);
+}
+
+// Copies out the events of a buffer that are still intact, oldest first. Returns how many were copied
+static unsigned int plt_trace_copy_events(Plt_Trace_Buffer *buffer, Plt_Trace_Event *events) {
+	uint64_t end = atomic_load_explicit(&buffer->write_count, memory_order_acquire);
+	uint64_t start = (end > PLT_TRACE_BUFFER_CAPACITY) ? end - PLT_TRACE_BUFFER_CAPACITY : 0;
+	start = plt_max(start, plt_min(atomic_load(&buffer->first_event), end));
+	for (uint64_t i = start; i < end; ++i) {
+		events[i - start] = buffer->events[i & (PLT_TRACE_BUFFER_CAPACITY - 1)];
+	}
+
+	// The thread kept recording while copying, drop any events it may have been writing over. The fence keeps
+	// the plain event reads above from being reordered after this load on weakly ordered CPUs
+	atomic_thread_fence(memory_order_acquire);
+	uint64_t written_during_copy = atomic_load_explicit(&buffer->write_count, memory_order_relaxed);
+	uint64_t first_intact = (written_during_copy + 1 > PLT_TRACE_BUFFER_CAPACITY) ? written_during_copy + 1 - PLT_TRACE_BUFFER_CAPACITY : 0;
+	if (first_intact <= start) {
+		return end - start;
+	}
+	if (first_intact >= end) {
+		return 0;
+	}
+
+	unsigned int dropped_count = first_intact - start;
+	for (uint64_t i = first_intact; i < end; ++i) {
+		events[i - first_intact] = events[i - start];
+	}
+	return (end - start) - dropped_count;
+}
+
+bool plt_trace_export_chrome_json(const char *path) {
+	FILE *file = fopen(path, "w");
+	if (!file) {
+		return false;
+	}
+
+	Plt_Trace_Event *events = malloc(sizeof(Plt_Trace_Event) * PLT_TRACE_BUFFER_CAPACITY);
+	bool first_event = true;
+
+	fprintf(file, "{\"traceEvents\":[\n");
+	for (Plt_Trace_Buffer *buffer = atomic_load(&plt_trace_buffers); buffer; buffer = buffer->next) {
+		unsigned int thread_index = atomic_load(&buffer->thread_index);
+		const char *thread_name = atomic_load(&buffer->thread_name);
+		if (thread_name) {
+			fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first_event ? "" : ",\n", thread_index);
+			plt_trace_write_json_string(file, thread_name);
+			fprintf(file, "}}");
+			first_event = false;
+		}
+
+		// The oldest slices may have lost their begin to the ring wrapping, skip ends with nothing to close
+		unsigned int depth = 0;
+		unsigned int event_count = plt_trace_copy_events(buffer, events);
+		for (unsigned int i = 0; i < event_count; ++i) {
+			Plt_Trace_Event event = events[i];
+			const char *phase = "C";
+			if (event.type == Plt_Trace_Event_Type_Begin) {
+				phase = "B";
+				++depth;
+			} else if (event.type == Plt_Trace_Event_Type_End) {
+				if (depth == 0) {
+					continue;
+				}
+				phase = "E";
+				--depth;
+			}
+
+			fprintf(file, "%s{\"ph\":\"%s\",\"name\":", first_event ? "" : ",\n", phase);
+			plt_trace_write_json_string(file, event.name);
+			fprintf(file, ",\"pid\":1,\"tid\":%u,\"ts\":%llu.%03u", thread_index, (unsigned long long)(event.timestamp_ns / 1000), (unsigned int)(event.timestamp_ns % 1000));
+			if (event.type == Plt_Trace_Event_Type_Counter) {
+				fprintf(file, ",\"args\":{\"value\":%.17g}", event.value);
+			}
+			fprintf(file, "}");
+			first_event = false;
+		}
+	}
+	fprintf(file, "\n],\"displayTimeUnit\":\"ns\"}\n");
+
+	free(events);
+	return fclose(file) == 0;
+}
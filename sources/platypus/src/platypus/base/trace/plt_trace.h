@@ -0,0 +1,9 @@
+#pragma once
+
+#include "platypus/platypus.h"
+
+// Events each thread keeps, older events are overwritten. Must be a power of two
+#define PLT_TRACE_BUFFER_CAPACITY 16384
+
+// Called by threads on their way out, so the next thread to record reuses their event buffer
+void plt_trace_release_thread();
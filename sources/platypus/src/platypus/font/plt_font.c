@@ -26,12 +26,14 @@ void plt_font_destroy(Plt_Font **font) {
 }
 
 Plt_Font *plt_font_load(const char *path) {
+	plt_trace_begin("Load Font");
 	Plt_Font *font = malloc(sizeof(Plt_Font));
 	
 	Plt_Texture *texture = plt_texture_load(path);
 	font->texture = texture;
 	font->atlas_size = plt_texture_get_size(texture);
 
+	plt_trace_end("Load Font");
 	return font;
 }
 
@@ -1,6 +1,7 @@
 #include "plt_math.h"
 
 #include <math.h>
+#include <string.h>
 #include "platypus/base/plt_macros.h"
 #include "platypus/base/plt_simd.h"
 
@@ -191,6 +192,24 @@ Plt_Matrix4x4f plt_transform_to_matrix(Plt_Transform transform) {
 	return plt_matrix_multiply(translate, plt_matrix_multiply(rotate, scale));
 }
 
+Plt_Transform plt_transform_interpolate(Plt_Transform a, Plt_Transform b, float t) {
+	// Blending rounds even when there's nothing to blend, return the ends as they are so unmoved and
+	// settled transforms keep exactly the same bits frame to frame
+	if (t <= 0.0f) {
+		return a;
+	}
+	if ((t >= 1.0f) || (memcmp(&a, &b, sizeof(Plt_Transform)) == 0)) {
+		return b;
+	}
+
+	// plt_vector3f_lerp weights its first argument by the factor
+	return (Plt_Transform) {
+		.translation = plt_vector3f_lerp(b.translation, a.translation, t),
+		.rotation = plt_quaternion_nlerp(a.rotation, b.rotation, t),
+		.scale = plt_vector3f_lerp(b.scale, a.scale, t)
+	};
+}
+
 Plt_Transform plt_transform_translate(Plt_Transform transform, Plt_Vector3f translation) {
 	transform.translation = plt_vector3f_add(transform.translation, translation);
 	return transform;
@@ -412,6 +431,20 @@ Plt_Quaternion plt_quaternion_multiply(Plt_Quaternion a, Plt_Quaternion b) {
 	return plt_quaternion_normalise(result);
 }
 
+Plt_Quaternion plt_quaternion_nlerp(Plt_Quaternion a, Plt_Quaternion b, float t) {
+	// Blend along the shorter arc
+	float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	float bt = (dot < 0.0f) ? -t : t;
+	float at = 1.0f - t;
+	
+	return plt_quaternion_normalise((Plt_Quaternion) {
+		a.x * at + b.x * bt,
+		a.y * at + b.y * bt,
+		a.z * at + b.z * bt,
+		a.w * at + b.w * bt
+	});
+}
+
 Plt_Vector3f plt_quaternion_to_euler(Plt_Quaternion q) {
 	Plt_Vector3f euler_angles;
 	
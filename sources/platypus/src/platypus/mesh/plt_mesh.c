@@ -1,35 +1,75 @@
 #include "plt_mesh.h"
 
 #include <stdlib.h>
+#include <string.h>
+#include "platypus/base/plt_macros.h"
+#include "platypus/base/plt_platform.h"
+
+static unsigned int plt_mesh_last_revision = 0;
+
+void plt_mesh_bump_revision(Plt_Mesh *mesh) {
+	mesh->revision = ++plt_mesh_last_revision;
+}
 
 Plt_Mesh *plt_mesh_create(int vertex_count) {
 	Plt_Mesh *mesh = malloc(sizeof(Plt_Mesh));
 
 	mesh->vertex_count = vertex_count;
+	mesh->padded_vertex_count = (vertex_count + PLT_MESH_VERTEX_PADDING - 1) & ~(PLT_MESH_VERTEX_PADDING - 1);
+	mesh->quantised = false;
+	plt_mesh_bump_revision(mesh);
+
+	// Carve the eight float streams out of a single zeroed block
+	size_t stride = plt_mesh_get_stream_stride(mesh, sizeof(float));
+	char *streams = plt_platform_aligned_alloc(plt_max(stride * 8, PLT_MESH_STREAM_ALIGNMENT), PLT_MESH_STREAM_ALIGNMENT);
+	plt_assert(streams, "Failed allocating mesh streams.\n");
+	memset(streams, 0, stride * 8);
+	mesh->stream_data = streams;
 
-	mesh->position_x = malloc(sizeof(float) * vertex_count);
-	mesh->position_y = malloc(sizeof(float) * vertex_count);
-	mesh->position_z = malloc(sizeof(float) * vertex_count);
+	mesh->position_x = (float *)(streams + stride * 0);
+	mesh->position_y = (float *)(streams + stride * 1);
+	mesh->position_z = (float *)(streams + stride * 2);
 
-	mesh->normal_x = malloc(sizeof(float) * vertex_count);
-	mesh->normal_y = malloc(sizeof(float) * vertex_count);
-	mesh->normal_z = malloc(sizeof(float) * vertex_count);
+	mesh->normal_x = (float *)(streams + stride * 3);
+	mesh->normal_y = (float *)(streams + stride * 4);
+	mesh->normal_z = (float *)(streams + stride * 5);
 
-	mesh->uv_x = malloc(sizeof(float) * vertex_count);
-	mesh->uv_y = malloc(sizeof(float) * vertex_count);
+	mesh->uv_x = (float *)(streams + stride * 6);
+	mesh->uv_y = (float *)(streams + stride * 7);
+
+	mesh->quantised_stream_data = NULL;
+	mesh->quantised_position_x = NULL;
+	mesh->quantised_position_y = NULL;
+	mesh->quantised_position_z = NULL;
+	mesh->quantised_normal_u = NULL;
+	mesh->quantised_normal_v = NULL;
+	mesh->quantised_uv_x = NULL;
+	mesh->quantised_uv_y = NULL;
 
 	return mesh;
 }
 
+void plt_mesh_free_float_streams(Plt_Mesh *mesh) {
+	if (mesh->stream_data) {
+		plt_platform_aligned_free(mesh->stream_data);
+	}
+
+	mesh->stream_data = NULL;
+	mesh->position_x = NULL;
+	mesh->position_y = NULL;
+	mesh->position_z = NULL;
+	mesh->normal_x = NULL;
+	mesh->normal_y = NULL;
+	mesh->normal_z = NULL;
+	mesh->uv_x = NULL;
+	mesh->uv_y = NULL;
+}
+
 void plt_mesh_destroy(Plt_Mesh **mesh) {
-	free((*mesh)->position_x);
-	free((*mesh)->position_y);
-	free((*mesh)->position_z);
-	free((*mesh)->normal_x);
-	free((*mesh)->normal_y);
-	free((*mesh)->normal_z);
-	free((*mesh)->uv_x);
-	free((*mesh)->uv_y);
+	plt_mesh_free_float_streams(*mesh);
+	if ((*mesh)->quantised_stream_data) {
+		plt_platform_aligned_free((*mesh)->quantised_stream_data);
+	}
 
 	free(*mesh);
 	*mesh = NULL;
@@ -176,12 +216,18 @@ Plt_Mesh *plt_mesh_create_cube(Plt_Vector3f size) {
 }
 
 void plt_mesh_set_position(Plt_Mesh *mesh, int index, Plt_Vector3f position) {
+	plt_assert(!mesh->quantised, "Quantised meshes are read-only.\n");
 	mesh->position_x[index] = position.x;
 	mesh->position_y[index] = position.y;
 	mesh->position_z[index] = position.z;
+	plt_mesh_bump_revision(mesh);
 }
 
 Plt_Vector3f plt_mesh_get_position(Plt_Mesh *mesh, int index) {
+	if (mesh->quantised) {
+		return plt_mesh_decode_position(mesh, index);
+	}
+
 	return (Plt_Vector3f) {
 		.x = mesh->position_x[index],
 		.y = mesh->position_y[index],
@@ -190,12 +236,18 @@ Plt_Vector3f plt_mesh_get_position(Plt_Mesh *mesh, int index) {
 }
 
 void plt_mesh_set_normal(Plt_Mesh *mesh, int index, Plt_Vector3f normal) {
+	plt_assert(!mesh->quantised, "Quantised meshes are read-only.\n");
 	mesh->normal_x[index] = normal.x;
 	mesh->normal_y[index] = normal.y;
 	mesh->normal_z[index] = normal.z;
+	plt_mesh_bump_revision(mesh);
 }
 
 Plt_Vector3f plt_mesh_get_normal(Plt_Mesh *mesh, int index) {
+	if (mesh->quantised) {
+		return plt_vector3f_normalize(plt_mesh_decode_normal(mesh, index));
+	}
+
 	return (Plt_Vector3f) {
 		.x = mesh->normal_x[index],
 		.y = mesh->normal_y[index],
@@ -204,13 +256,110 @@ Plt_Vector3f plt_mesh_get_normal(Plt_Mesh *mesh, int index) {
 }
 
 void plt_mesh_set_uv(Plt_Mesh *mesh, int index, Plt_Vector2f uv) {
+	plt_assert(!mesh->quantised, "Quantised meshes are read-only.\n");
 	mesh->uv_x[index] = uv.x;
 	mesh->uv_y[index] = uv.y;
+	plt_mesh_bump_revision(mesh);
 }
 
 Plt_Vector2f plt_mesh_get_uv(Plt_Mesh *mesh, int index) {
+	if (mesh->quantised) {
+		return plt_mesh_decode_uv(mesh, index);
+	}
+
 	return (Plt_Vector2f) {
 		.x = mesh->uv_x[index],
 		.y = mesh->uv_y[index],
 	};
 }
+
+// Maps values onto [0, 65535] across the range of the stream, returning the decode scale
+static float plt_mesh_quantise_stream(const float *values, unsigned int count, unsigned short *output, float *offset) {
+	float min = INFINITY;
+	float max = -INFINITY;
+	for (unsigned int i = 0; i < count; ++i) {
+		min = fminf(min, values[i]);
+		max = fmaxf(max, values[i]);
+	}
+
+	if (!(max > min)) {
+		*offset = (count > 0) ? min : 0.0f;
+		memset(output, 0, sizeof(unsigned short) * count);
+		return 0.0f;
+	}
+
+	float encode_scale = 65535.0f / (max - min);
+	for (unsigned int i = 0; i < count; ++i) {
+		output[i] = (unsigned short)plt_clamp((values[i] - min) * encode_scale + 0.5f, 0.0f, 65535.0f);
+	}
+
+	*offset = min;
+	return (max - min) / 65535.0f;
+}
+
+static inline signed char plt_mesh_quantise_snorm8(float value) {
+	return (signed char)lroundf(plt_clamp(value, -1.0f, 1.0f) * 127.0f);
+}
+
+void plt_mesh_quantise(Plt_Mesh *mesh) {
+	if (mesh->quantised) {
+		return;
+	}
+
+	unsigned int vertex_count = mesh->vertex_count;
+
+	// Five 16-bit streams followed by two 8-bit ones, in one zeroed block like the float streams
+	size_t stride_16 = plt_mesh_get_stream_stride(mesh, sizeof(unsigned short));
+	size_t stride_8 = plt_mesh_get_stream_stride(mesh, sizeof(signed char));
+	size_t size = plt_max(stride_16 * 5 + stride_8 * 2, PLT_MESH_STREAM_ALIGNMENT);
+	char *streams = plt_platform_aligned_alloc(size, PLT_MESH_STREAM_ALIGNMENT);
+	plt_assert(streams, "Failed allocating quantised mesh streams.\n");
+	memset(streams, 0, size);
+	mesh->quantised_stream_data = streams;
+
+	mesh->quantised_position_x = (unsigned short *)(streams + stride_16 * 0);
+	mesh->quantised_position_y = (unsigned short *)(streams + stride_16 * 1);
+	mesh->quantised_position_z = (unsigned short *)(streams + stride_16 * 2);
+	mesh->quantised_uv_x = (unsigned short *)(streams + stride_16 * 3);
+	mesh->quantised_uv_y = (unsigned short *)(streams + stride_16 * 4);
+	mesh->quantised_normal_u = (signed char *)(streams + stride_16 * 5);
+	mesh->quantised_normal_v = (signed char *)(streams + stride_16 * 5 + stride_8);
+
+	mesh->position_scale.x = plt_mesh_quantise_stream(mesh->position_x, vertex_count, mesh->quantised_position_x, &mesh->position_offset.x);
+	mesh->position_scale.y = plt_mesh_quantise_stream(mesh->position_y, vertex_count, mesh->quantised_position_y, &mesh->position_offset.y);
+	mesh->position_scale.z = plt_mesh_quantise_stream(mesh->position_z, vertex_count, mesh->quantised_position_z, &mesh->position_offset.z);
+
+	mesh->uv_scale.x = plt_mesh_quantise_stream(mesh->uv_x, vertex_count, mesh->quantised_uv_x, &mesh->uv_offset.x);
+	mesh->uv_scale.y = plt_mesh_quantise_stream(mesh->uv_y, vertex_count, mesh->quantised_uv_y, &mesh->uv_offset.y);
+
+	// Project onto the octahedron |x| + |y| + |z| = 1, folding the lower half over the upper
+	for (unsigned int i = 0; i < vertex_count; ++i) {
+		float x = mesh->normal_x[i];
+		float y = mesh->normal_y[i];
+		float z = mesh->normal_z[i];
+		float length = fabsf(x) + fabsf(y) + fabsf(z);
+		if (length > 0.0f) {
+			x /= length;
+			y /= length;
+			z /= length;
+		}
+
+		if (z < 0.0f) {
+			float folded_x = (1.0f - fabsf(y)) * ((x >= 0.0f) ? 1.0f : -1.0f);
+			float folded_y = (1.0f - fabsf(x)) * ((y >= 0.0f) ? 1.0f : -1.0f);
+			x = folded_x;
+			y = folded_y;
+		}
+
+		mesh->quantised_normal_u[i] = plt_mesh_quantise_snorm8(x);
+		mesh->quantised_normal_v[i] = plt_mesh_quantise_snorm8(y);
+	}
+
+	plt_mesh_free_float_streams(mesh);
+	mesh->quantised = true;
+	plt_mesh_bump_revision(mesh);
+}
+
+bool plt_mesh_is_quantised(Plt_Mesh *mesh) {
+	return mesh->quantised;
+}
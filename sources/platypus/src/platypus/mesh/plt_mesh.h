@@ -1,10 +1,30 @@
 #pragma once
 
+#include <math.h>
 #include "platypus/platypus.h"
 
+// Every attribute stream starts on a cache line
+#define PLT_MESH_STREAM_ALIGNMENT 64
+
+// Streams are zero padded to a multiple of this many vertices so SIMD loops need no scalar tail
+#define PLT_MESH_VERTEX_PADDING 16
+
 typedef struct Plt_Mesh {
 	int vertex_count;
 
+	// vertex_count rounded up to PLT_MESH_VERTEX_PADDING
+	unsigned int padded_vertex_count;
+
+	// Unique across every mesh ever created and bumped on each edit, lets caches spot stale data
+	unsigned int revision;
+
+	// Quantised meshes drop the float streams in favour of the compact ones below
+	bool quantised;
+
+	// All float streams live in one aligned allocation, as do all quantised streams
+	void *stream_data;
+	void *quantised_stream_data;
+
 	float *position_x;
 	float *position_y;
 	float *position_z;
@@ -15,4 +35,57 @@ typedef struct Plt_Mesh {
 
 	float *uv_x;
 	float *uv_y;
-} Plt_Mesh;
\ No newline at end of file
+
+	// 16-bit normalised positions, position = position_offset + value * position_scale
+	unsigned short *quantised_position_x;
+	unsigned short *quantised_position_y;
+	unsigned short *quantised_position_z;
+	Plt_Vector3f position_scale;
+	Plt_Vector3f position_offset;
+
+	// Octahedral encoded normals, 8-bit signed normalised
+	signed char *quantised_normal_u;
+	signed char *quantised_normal_v;
+
+	// 16-bit normalised UVs, uv = uv_offset + value * uv_scale
+	unsigned short *quantised_uv_x;
+	unsigned short *quantised_uv_y;
+	Plt_Vector2f uv_scale;
+	Plt_Vector2f uv_offset;
+} Plt_Mesh;
+
+// Bytes between consecutive streams of the given element size
+static inline size_t plt_mesh_get_stream_stride(const Plt_Mesh *mesh, size_t element_size) {
+	size_t size = mesh->padded_vertex_count * element_size;
+	return (size + PLT_MESH_STREAM_ALIGNMENT - 1) & ~(size_t)(PLT_MESH_STREAM_ALIGNMENT - 1);
+}
+
+void plt_mesh_bump_revision(Plt_Mesh *mesh);
+
+// MARK: Quantised attribute decoding
+
+static inline Plt_Vector3f plt_mesh_decode_position(const Plt_Mesh *mesh, unsigned int index) {
+	return (Plt_Vector3f) {
+		.x = mesh->position_offset.x + mesh->quantised_position_x[index] * mesh->position_scale.x,
+		.y = mesh->position_offset.y + mesh->quantised_position_y[index] * mesh->position_scale.y,
+		.z = mesh->position_offset.z + mesh->quantised_position_z[index] * mesh->position_scale.z
+	};
+}
+
+// Unfolds the octahedron, the result points the right way but isn't unit length
+static inline Plt_Vector3f plt_mesh_decode_normal(const Plt_Mesh *mesh, unsigned int index) {
+	float x = mesh->quantised_normal_u[index] * (1.0f / 127.0f);
+	float y = mesh->quantised_normal_v[index] * (1.0f / 127.0f);
+	float z = 1.0f - fabsf(x) - fabsf(y);
+	float fold = fmaxf(-z, 0.0f);
+	x += (x >= 0.0f) ? -fold : fold;
+	y += (y >= 0.0f) ? -fold : fold;
+	return (Plt_Vector3f){ x, y, z };
+}
+
+static inline Plt_Vector2f plt_mesh_decode_uv(const Plt_Mesh *mesh, unsigned int index) {
+	return (Plt_Vector2f) {
+		.x = mesh->uv_offset.x + mesh->quantised_uv_x[index] * mesh->uv_scale.x,
+		.y = mesh->uv_offset.y + mesh->quantised_uv_y[index] * mesh->uv_scale.y
+	};
+}
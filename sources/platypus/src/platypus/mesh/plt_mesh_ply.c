@@ -212,6 +212,7 @@ Plt_Mesh *plt_mesh_load_ply(const char *path) {
 		.face_attrib_count = 0
 	};
 
+	plt_trace_begin("Load Mesh");
 	FILE *f = fopen(path, "r");
 	
 	if(!f) {
@@ -350,6 +351,24 @@ Plt_Mesh *plt_mesh_load_ply(const char *path) {
 		uvs[i].y = 1.0f - values[layout.vertex_attrib_uv_y]; // UV.y must be flipped
 	}
 	
+	// Point clouds have no faces, use the vertices as-is
+	if (layout.face_count == 0) {
+		Plt_Mesh *mesh = plt_mesh_create(layout.vertex_count);
+		for (unsigned int i = 0; i < layout.vertex_count; ++i) {
+			plt_mesh_set_position(mesh, i, positions[i]);
+			plt_mesh_set_normal(mesh, i, normals[i]);
+			plt_mesh_set_uv(mesh, i, uvs[i]);
+		}
+
+		free(positions);
+		free(normals);
+		free(uvs);
+		free(indices);
+
+		plt_trace_end("Load Mesh");
+		return mesh;
+	}
+	
 	// Read in indices
 	unsigned int index_count = 0;
 	for (unsigned int i = 0; i < layout.face_count; ++i) {
@@ -390,5 +409,6 @@ Plt_Mesh *plt_mesh_load_ply(const char *path) {
 	free(uvs);
 	free(indices);
 		
+	plt_trace_end("Load Mesh");
 	return mesh;
 }
@@ -1,6 +1,8 @@
 #include "platypus/application/plt_application.c"
+#include "platypus/application/plt_frame_scheduler.c"
 #include "platypus/base/allocation/plt_linear_allocator.c"
 #include "platypus/base/thread/plt_thread.c"
+#include "platypus/base/trace/plt_trace.c"
 #include "platypus/color/plt_color.c"
 #include "platypus/font/plt_font.c"
 #include "platypus/framebuffer/plt_framebuffer.c"
@@ -10,6 +12,8 @@
 #include "platypus/mesh/plt_mesh.c"
 #include "platypus/mesh/plt_mesh_ply.c"
 #include "platypus/renderer/plt_renderer.c"
+#include "platypus/renderer/pipeline/plt_billboard_processor.c"
+#include "platypus/renderer/pipeline/plt_point_processor.c"
 #include "platypus/renderer/pipeline/plt_triangle_processor.c"
 #include "platypus/renderer/pipeline/plt_triangle_rasteriser.c"
 #include "platypus/renderer/pipeline/plt_vertex_processor.c"
@@ -19,4 +23,5 @@
 #include "platypus/world/base_components/collider/plt_component_collider.c"
 #include "platypus/world/base_components/mesh_renderer/plt_component_mesh_renderer.c"
 #include "platypus/world/base_components/flying_camera_controller/plt_component_flying_camera_controller.c"
+#include "platypus/world/base_components/performance_hud/plt_component_performance_hud.c"
 #include "platypus/world/plt_world.c"
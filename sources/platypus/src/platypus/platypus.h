@@ -2,6 +2,8 @@
 #define PLATYPUS_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
 
 // MARK: Math
 
@@ -85,6 +87,9 @@ Plt_Matrix4x4f plt_matrix_perspective_make(float aspect_ratio, float fov, float
 
 Plt_Transform plt_transform_create(Plt_Vector3f translation, Plt_Quaternion rotation, Plt_Vector3f scale);
 Plt_Transform plt_transform_invert(Plt_Transform transform);
+
+// a at t = 0, b at t = 1, exactly, and exactly a when a and b are the same
+Plt_Transform plt_transform_interpolate(Plt_Transform a, Plt_Transform b, float t);
 Plt_Matrix4x4f plt_transform_to_matrix(Plt_Transform transform);
 Plt_Transform plt_transform_translate(Plt_Transform transform, Plt_Vector3f translation);
 Plt_Transform plt_transform_rotate(Plt_Transform transform, Plt_Quaternion rotation);
@@ -142,6 +147,9 @@ Plt_Quaternion plt_quaternion_invert(Plt_Quaternion q);
 Plt_Quaternion plt_quaternion_normalise(Plt_Quaternion q);
 Plt_Quaternion plt_quaternion_add(Plt_Quaternion a, Plt_Quaternion b);
 Plt_Quaternion plt_quaternion_multiply(Plt_Quaternion a, Plt_Quaternion b);
+
+// Normalised linear blend, a at t = 0, b at t = 1
+Plt_Quaternion plt_quaternion_nlerp(Plt_Quaternion a, Plt_Quaternion b, float t);
 Plt_Vector3f plt_quaternion_to_euler(Plt_Quaternion q);
 Plt_Vector3f plt_quaternion_rotate_vector(Plt_Quaternion q, Plt_Vector3f v);
 Plt_Matrix4x4f plt_quaternion_to_matrix(Plt_Quaternion q);
@@ -170,6 +178,7 @@ typedef struct Plt_Frame_State {
 	// Time since appliation was started (milliseconds)
 	float application_time;
 
+	// NULL when rendering headless
 	Plt_Input_State *input_state;
 } Plt_Frame_State;
 
@@ -187,6 +196,9 @@ typedef struct Plt_Entity {
 	unsigned long long components;
 	const char *name;
 	Plt_Transform transform;
+
+	// Transform at the start of the last fixed tick, rendering blends from this to transform
+	Plt_Transform previous_transform;
 } Plt_Entity;
 
 typedef struct Plt_Component_Table_Entry {
@@ -227,8 +239,18 @@ typedef struct Plt_World {
 	unsigned int component_count;
 	Plt_Component components[PLT_WORLD_COMPONENT_CAPACITY];
 
+	// Fixed timestep, zero when updates follow the frame delta time
+	float fixed_timestep_ms;
+	unsigned int max_ticks_per_update;
+	float accumulated_ms;
+	float interpolation_alpha;
+
+	// Mouse movement from frames that haven't been ticked yet
+	Plt_Vector2f accumulated_mouse_movement;
+
 	// Runtime state
 	bool is_updating;
+	bool is_rendering;
 } Plt_World;
 
 Plt_World *plt_world_create();
@@ -237,6 +259,16 @@ void plt_world_destroy(Plt_World *world);
 void plt_world_update(Plt_World *world, Plt_Frame_State state);
 void plt_world_render(Plt_World *world, Plt_Frame_State state, Plt_Renderer *renderer);
 
+// Runs component updates at a fixed rate, however long frames take, with at most max_ticks_per_update ticks
+// per plt_world_update, any time beyond that is dropped so a slow frame can't snowball into slower updates.
+// Entity transforms are interpolated between the last two ticks while rendering. Mouse movement is per frame,
+// so it's held over frames without a tick and handed to the first tick of an update, later ticks see none.
+// A tick rate of 0 returns to one update per frame
+void plt_world_set_fixed_timestep(Plt_World *world, float tick_rate, unsigned int max_ticks_per_update);
+
+// How far rendering is between the last two ticks, 1 without a fixed timestep
+float plt_world_get_interpolation_alpha(Plt_World *world);
+
 Plt_Entity_ID plt_world_create_entity(Plt_World *world, const char *name, Plt_Entity_ID parent_id);
 void plt_world_destroy_entity(Plt_World *world, Plt_Entity_ID entity_id);
 
@@ -276,11 +308,15 @@ typedef struct Plt_Object_Type_Mesh_Renderer_Data {
 	Plt_Mesh *mesh;
 	Plt_Texture *texture;
 	Plt_Color8 color;
+	bool is_static;
 } Plt_Object_Type_Mesh_Renderer_Data;
 
 void plt_component_mesh_renderer_set_mesh(Plt_World *world, Plt_Entity_ID entity_id, Plt_Mesh *mesh);
 void plt_component_mesh_renderer_set_texture(Plt_World *world, Plt_Entity_ID entity_id, Plt_Texture *texture);
 
+// Static meshes are drawn as static geometry, see plt_renderer_set_static_geometry
+void plt_component_mesh_renderer_set_static(Plt_World *world, Plt_Entity_ID entity_id, bool is_static);
+
 // Billboard Renderer
 typedef struct Plt_Object_Type_Billboard_Renderer_Data {
 	Plt_Vector2f size;
@@ -312,6 +348,38 @@ typedef struct Plt_Object_Type_Flying_Camera_Controller_Data {
 	float yaw;
 } Plt_Object_Type_Flying_Camera_Controller_Data;
 
+// Performance HUD
+// Draws a graph of recent frame times over the target frame time, where the renderer's time went, what it
+// drew, how busy each raster worker was and the process's memory use. Stage timings and stats are the
+// renderer's last executed frame, which lags a frame behind when frames are pipelined
+#define PLT_COMPONENT_PERFORMANCE_HUD "performance_hud"
+#define PLT_PERFORMANCE_HUD_HISTORY_LENGTH 120
+
+typedef struct Plt_Font Plt_Font;
+typedef struct Plt_Object_Type_Performance_Hud_Data {
+	// Nothing is drawn without a font
+	Plt_Font *font;
+	Plt_Vector2i position;
+
+	// Bars over the target frame time are drawn red, the graph's scale is twice the target
+	float target_frame_ms;
+
+	// Ring of frame times (milliseconds), next_index is the oldest once full
+	float frame_ms_history[PLT_PERFORMANCE_HUD_HISTORY_LENGTH];
+	unsigned int history_count;
+	unsigned int next_index;
+
+	// Reading the memory use goes through the OS, so it's only sampled every few frames (bytes, zero if unknown)
+	size_t resident_memory;
+	unsigned int frames_until_memory_sample;
+} Plt_Object_Type_Performance_Hud_Data;
+
+void plt_component_performance_hud_set_font(Plt_World *world, Plt_Entity_ID entity_id, Plt_Font *font);
+void plt_component_performance_hud_set_position(Plt_World *world, Plt_Entity_ID entity_id, Plt_Vector2i position);
+
+// Defaults to 60, 0 keeps the default for uncapped applications
+void plt_component_performance_hud_set_target_fps(Plt_World *world, Plt_Entity_ID entity_id, unsigned int fps);
+
 // Collider
 #define PLT_COMPONENT_COLLIDER "collider"
 typedef struct Plt_Object_Type_Collider_Data {
@@ -347,13 +415,120 @@ typedef struct Plt_Lighting_Setup {
 	Plt_Vector3f ambient_lighting;
 } Plt_Lighting_Setup;
 
+typedef struct Plt_Framebuffer {
+	Plt_Color8 *pixels;
+	unsigned int width, height;
+} Plt_Framebuffer;
+
 typedef struct Plt_Renderer Plt_Renderer;
 typedef struct Plt_Mesh Plt_Mesh;
 typedef struct Plt_Texture Plt_Texture;
 typedef struct Plt_Font Plt_Font;
+
+// Headless renderers draw into memory without an application or any SDL video. The pixels belong
+// to the caller, unless framebuffer.pixels is NULL and the renderer allocates them itself
+Plt_Renderer *plt_renderer_create_headless(Plt_Framebuffer framebuffer);
+void plt_renderer_destroy(Plt_Renderer **renderer);
+
+// Retargets the renderer, NULL pixels allocate a framebuffer of the given size owned by the renderer
+void plt_renderer_set_framebuffer(Plt_Renderer *renderer, Plt_Framebuffer framebuffer);
+Plt_Framebuffer plt_renderer_get_framebuffer(Plt_Renderer *renderer);
+
+// Tiles that would come out the same as last frame aren't redrawn, so changes made
+// to the framebuffer's pixels outside the renderer must be reported here
+void plt_renderer_invalidate_framebuffer(Plt_Renderer *renderer);
+
 void plt_renderer_clear(Plt_Renderer *renderer, Plt_Color8 clear_color);
+
+// Draws everything recorded since the last execute into the framebuffer
+void plt_renderer_execute(Plt_Renderer *renderer);
+
+// Shows the framebuffer in the application's window, does nothing for headless renderers
 void plt_renderer_present(Plt_Renderer *renderer);
 
+// Where the last executed frame's time went (milliseconds). The triangle processor covers setup and
+// binning for meshes, points and billboards, direct draws cover lines and direct textures
+typedef struct Plt_Renderer_Frame_Timings {
+	float vertex_processor_ms;
+	float triangle_processor_ms;
+	float rasteriser_ms;
+	float direct_draw_ms;
+	float total_ms;
+
+	// Triangles drawn from meshes, static geometry included
+	unsigned int triangle_count;
+} Plt_Renderer_Frame_Timings;
+Plt_Renderer_Frame_Timings plt_renderer_get_frame_timings(Plt_Renderer *renderer);
+
+#define PLT_RENDERER_STATS_MAX_WORKERS 32
+
+// What each pipeline stage did with the last executed frame. Static geometry is only set up and
+// binned on frames it changes, but its bin entries are rasterised every frame
+typedef struct Plt_Renderer_Stats {
+	unsigned int draw_call_count;
+
+	// Vertices of triangle meshes run through the vertex processor
+	unsigned int vertices_processed;
+
+	// Every triangle set up is either culled or binned
+	unsigned int triangles_submitted;
+	unsigned int triangles_culled_behind_camera;
+	unsigned int triangles_culled_zero_area;
+	unsigned int triangles_culled_back_face;
+	unsigned int triangles_binned;
+
+	// Bin entries dropped because their tile's bin was already full
+	unsigned int bin_overflow_count;
+
+	// Triangle bin entries per tile, static and dynamic
+	unsigned int tile_count;
+	unsigned int max_bin_entries;
+	float mean_bin_entries;
+
+	// Tiles whose contents changed and were redrawn, only these count towards coverage and pixels
+	unsigned int tiles_rasterised;
+
+	// Bin entries covering their whole tile skip per pixel edge tests, partial entries don't
+	unsigned int full_coverage_entries;
+	unsigned int partial_coverage_entries;
+
+	// Triangle, billboard and point pixels that reached the depth test, and those that passed it.
+	// Written pixels over the rasterised tiles' area is the overdraw
+	uint64_t pixels_tested;
+	uint64_t pixels_written;
+
+	// Time each raster worker spent on the frame's tiles, against rasteriser_ms it's how evenly they were shared out
+	unsigned int worker_count;
+	float worker_busy_ms[PLT_RENDERER_STATS_MAX_WORKERS];
+} Plt_Renderer_Stats;
+Plt_Renderer_Stats plt_renderer_get_stats(Plt_Renderer *renderer);
+
+// Threads the rasteriser shares tiles out between, 0 uses one per core (the default). Only call between frames
+void plt_renderer_set_thread_count(Plt_Renderer *renderer, unsigned int thread_count);
+unsigned int plt_renderer_get_thread_count(Plt_Renderer *renderer);
+
+// Replaces or tints the rendered scene to show where rasterisation time goes. Every tile is redrawn
+// while a view is selected, so tile skipping doesn't hide any of the work
+typedef enum Plt_Renderer_Debug_View {
+	Plt_Renderer_Debug_View_None,
+
+	// Times each pixel was written by triangles, from blue for once through to red for 8 or more
+	Plt_Renderer_Debug_View_Overdraw,
+
+	// Tiles tinted by the triangles binned into them, relative to the busiest tile
+	Plt_Renderer_Debug_View_Tile_Triangle_Count,
+
+	// Tiles tinted by the cycles spent rasterising them, relative to the slowest tile
+	Plt_Renderer_Debug_View_Tile_Time,
+
+	// Tiles tinted by the raster worker that rendered them
+	Plt_Renderer_Debug_View_Worker,
+
+	Plt_Renderer_Debug_View_Count
+} Plt_Renderer_Debug_View;
+void plt_renderer_set_debug_view(Plt_Renderer *renderer, Plt_Renderer_Debug_View debug_view);
+Plt_Renderer_Debug_View plt_renderer_get_debug_view(Plt_Renderer *renderer);
+
 void plt_renderer_direct_draw_pixel(Plt_Renderer *renderer, Plt_Vector2i position, unsigned int depth, Plt_Color8 color);
 void plt_renderer_direct_draw_colored_rect(Plt_Renderer *renderer, Plt_Rect rect, unsigned int depth, Plt_Color8 color);
 void plt_renderer_direct_draw_texture(Plt_Renderer *renderer, Plt_Rect rect, unsigned int depth, Plt_Texture *texture);
@@ -369,6 +544,10 @@ void plt_renderer_set_point_size(Plt_Renderer *renderer, unsigned int size);
 void plt_renderer_set_lighting_model(Plt_Renderer *renderer, Plt_Lighting_Model model);
 void plt_renderer_set_render_color(Plt_Renderer *renderer, Plt_Color8 color);
 void plt_renderer_set_lighting_setup(Plt_Renderer* renderer, Plt_Lighting_Setup setup);
+
+// Triangle meshes drawn while enabled are binned once and kept across frames, until the set of
+// static draws, their transforms, the camera, the lighting or the framebuffer size changes
+void plt_renderer_set_static_geometry(Plt_Renderer *renderer, bool static_geometry);
 void plt_renderer_bind_texture(Plt_Renderer *renderer, Plt_Texture *texture);
 
 void plt_renderer_set_model_matrix(Plt_Renderer *renderer, Plt_Matrix4x4f matrix);
@@ -384,6 +563,30 @@ typedef enum Plt_Application_Option {
 	Plt_Application_Option_Fullscreen = 1 << 0
 } Plt_Application_Option;
 
+typedef enum Plt_Frame_Pacing {
+	// Waits out the rest of each frame to hold the target FPS
+	Plt_Frame_Pacing_Capped,
+
+	// Runs frames back to back, delta time follows the clock
+	Plt_Frame_Pacing_Uncapped,
+
+	// Runs frames back to back but simulates each as exactly one target frame, so runs are repeatable
+	Plt_Frame_Pacing_Benchmark
+} Plt_Frame_Pacing;
+
+// Frame delivery over the most recent frames (milliseconds)
+typedef struct Plt_Frame_Timing {
+	float last_frame_ms;
+	float mean_frame_ms;
+	float max_frame_ms;
+
+	// Standard deviation of frame times
+	float jitter_ms;
+
+	// Frames that overran the target frame time while capped
+	unsigned int missed_deadline_count;
+} Plt_Frame_Timing;
+
 typedef struct Plt_Application Plt_Application;
 Plt_Application *plt_application_create(const char *title, unsigned int width, unsigned int height, unsigned int scale, Plt_Application_Option options);
 void plt_application_destroy(Plt_Application **application);
@@ -401,8 +604,22 @@ Plt_World *plt_application_get_world(Plt_Application *application);
 void plt_application_set_target_fps(Plt_Application *application, unsigned int fps);
 unsigned int plt_application_get_target_fps(Plt_Application *application);
 
+void plt_application_set_frame_pacing(Plt_Application *application, Plt_Frame_Pacing pacing);
+Plt_Frame_Timing plt_application_get_frame_timing(Plt_Application *application);
+
 float plt_application_get_milliseconds_since_creation(Plt_Application *application);
 
+// Dynamic resolution adjusts the render scale (window pixels per rendered pixel) every few frames
+// to keep render time inside the target frame time, staying within [min_scale, max_scale]
+void plt_application_set_dynamic_resolution(Plt_Application *application, bool enabled);
+void plt_application_set_render_scale_bounds(Plt_Application *application, float min_scale, float max_scale);
+float plt_application_get_render_scale(Plt_Application *application);
+
+// Pipelined frames simulate and record the next frame while the last one is rasterised in the background,
+// at the cost of a frame of latency. Meshes and textures drawn last frame must not be edited or destroyed
+// during update and render
+void plt_application_set_pipelined_frames(Plt_Application *application, bool enabled);
+
 // MARK: Input
 
 typedef struct Plt_Input_State Plt_Input_State;
@@ -468,6 +685,11 @@ Plt_Mesh *plt_mesh_create_cube(Plt_Vector3f size);
 
 Plt_Mesh *plt_mesh_load_ply(const char *path);
 
+// Store attributes compactly (16-bit positions and UVs, 8-bit octahedral normals), about a third of the memory
+// Quantised meshes are read-only
+void plt_mesh_quantise(Plt_Mesh *mesh);
+bool plt_mesh_is_quantised(Plt_Mesh *mesh);
+
 void plt_mesh_set_position(Plt_Mesh *mesh, int index, Plt_Vector3f position);
 Plt_Vector3f plt_mesh_get_position(Plt_Mesh *mesh, int index);
 
@@ -480,23 +702,75 @@ Plt_Vector2f plt_mesh_get_uv(Plt_Mesh *mesh, int index);
 // MARK: Texture
 
 typedef struct Plt_Texture Plt_Texture;
+
+typedef enum Plt_Texture_Option {
+	Plt_Texture_Option_None = 0,
+
+	// Store texels in 4x4 blocks so samples along any UV direction stay within a cache line
+	Plt_Texture_Option_Tiled = 1 << 0,
+
+	// Quantise to a 256 colour palette and store 8-bit indices, a quarter of the memory and bandwidth
+	Plt_Texture_Option_Palettised = 1 << 1
+} Plt_Texture_Option;
+
+typedef enum Plt_Texture_Address_Mode {
+	// Repeat the texture outside of [0, 1]
+	Plt_Texture_Address_Mode_Wrap,
+
+	// Repeat the edge texels outside of [0, 1]
+	Plt_Texture_Address_Mode_Clamp
+} Plt_Texture_Address_Mode;
+
+typedef enum Plt_Texture_Filter {
+	Plt_Texture_Filter_Nearest,
+
+	// Blend the four closest texels
+	Plt_Texture_Filter_Bilinear
+} Plt_Texture_Filter;
+
 Plt_Texture *plt_texture_create(Plt_Size size);
 void plt_texture_destroy(Plt_Texture **texture);
 
 Plt_Texture *plt_texture_create_with_bytes_nocopy(Plt_Size size, void *bytes);
 Plt_Texture *plt_texture_load(const char *path);
+Plt_Texture *plt_texture_load_with_options(const char *path, Plt_Texture_Option options);
+
+// Rebuild the mip chain from level 0, textures loaded from disk have one generated automatically
+void plt_texture_generate_mipmaps(Plt_Texture *texture);
+unsigned int plt_texture_get_mip_level_count(Plt_Texture *texture);
+
+// Quantise every level to a shared 256 colour palette, palettised textures are read-only
+void plt_texture_palettise(Plt_Texture *texture);
+bool plt_texture_is_palettised(Plt_Texture *texture);
 
 Plt_Color8 plt_texture_get_pixel(Plt_Texture *texture, Plt_Vector2i pos);
 void plt_texture_set_pixel(Plt_Texture *texture, Plt_Vector2i pos, Plt_Color8 value);
 
+// Sample at a UV coordinate using the texture's filter and address mode
 Plt_Color8 plt_texture_sample(Plt_Texture *texture, Plt_Vector2f pos);
 
 void plt_texture_clear(Plt_Texture *texture, Plt_Color8 value);
 
 Plt_Size plt_texture_get_size(Plt_Texture *texture);
+bool plt_texture_is_power_of_two(Plt_Texture *texture);
+
+void plt_texture_set_address_mode(Plt_Texture *texture, Plt_Texture_Address_Mode mode);
+Plt_Texture_Address_Mode plt_texture_get_address_mode(Plt_Texture *texture);
+
+void plt_texture_set_filter(Plt_Texture *texture, Plt_Texture_Filter filter);
+Plt_Texture_Filter plt_texture_get_filter(Plt_Texture *texture);
+
 Plt_Vector2f plt_texture_get_texel_size(Plt_Texture *texture);
+
+// Level 0 texels in the texture's storage layout, only row-major for textures that weren't loaded tiled
+// Palettised textures have no BGRA texels and return NULL
+// Call plt_texture_mark_modified() once done writing through the pointer
 Plt_Color8 *plt_texture_get_pixels(Plt_Texture *texture);
 
+// Flags level 0 as changed so the renderer picks the new texels up, rebuilding the mip chain if there is one
+// Needed after writing through plt_texture_get_pixels(), or after plt_texture_set_pixel()/plt_texture_clear() on a mipmapped texture
+void plt_texture_mark_modified(Plt_Texture *texture);
+
 // MARK: Font
 
 typedef struct Plt_Font Plt_Font;
@@ -510,4 +784,23 @@ Plt_Size plt_font_get_character_size(Plt_Font *font);
 Plt_Rect plt_font_get_rect_for_character(Plt_Font *font, char c);
 Plt_Size plt_font_get_size_of_string(Plt_Font *font, const char *string);
 
+// MARK: Tracing
+
+// Every thread records into its own ring buffer, keeping its most recent events. Nothing is recorded
+// until tracing is enabled. Names aren't copied, so they must stay valid until the trace is exported
+void plt_trace_set_enabled(bool enabled);
+bool plt_trace_is_enabled();
+
+// Begin and end pairs nest into slices on the calling thread's timeline
+void plt_trace_begin(const char *name);
+void plt_trace_end(const char *name);
+void plt_trace_counter(const char *name, double value);
+
+// Labels the calling thread's timeline
+void plt_trace_set_thread_name(const char *name);
+
+// Writes every thread's recorded events in the Chrome trace event format, which chrome://tracing and Perfetto open.
+// Safe to call while other threads are recording, events overwritten during the export are left out
+bool plt_trace_export_chrome_json(const char *path);
+
 #endif
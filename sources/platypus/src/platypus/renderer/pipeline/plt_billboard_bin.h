@@ -0,0 +1,28 @@
+#pragma once
+
+#include "platypus/platypus.h"
+
+typedef struct Plt_Billboard_Bin_Data_Buffer {
+	unsigned int billboard_count;
+
+	// Unclipped screen rect of each quad
+	int *screen_x;
+	int *screen_y;
+	int *width;
+	int *height;
+
+	float *depth;
+	Plt_Color8 *color;
+
+	// Quads are sorted by texture so each tile walks them in texture batches
+	Plt_Texture **texture;
+	unsigned int *mip_level;
+
+	// 16.16 fixed point texel step per pixel in the selected mip level
+	unsigned int *texel_step_x;
+	unsigned int *texel_step_y;
+
+	// Quads binned per tile, tile i owns tile_billboard_indices[tile_offsets[i]..tile_offsets[i + 1]]
+	unsigned int *tile_offsets;
+	unsigned int *tile_billboard_indices;
+} Plt_Billboard_Bin_Data_Buffer;
@@ -0,0 +1,198 @@
+#include "plt_billboard_processor.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "platypus/base/allocation/plt_linear_allocator.h"
+#include "platypus/renderer/plt_renderer.h"
+#include "platypus/texture/plt_texture.h"
+#include "plt_triangle_rasteriser.h"
+#include "plt_triangle_bin.h"
+#include "plt_billboard_bin.h"
+
+// Keeps extreme close-ups from overflowing integer screen coordinates
+#define PLT_BILLBOARD_MAX_EXTENT 16777216.0f
+
+// Everything the stage works with lives in the frame allocator, the processor only exists so it's
+// created and owned like the other pipeline stages. C structs can't be empty
+typedef struct Plt_Billboard_Processor {
+	char unused;
+} Plt_Billboard_Processor;
+
+typedef struct Plt_Billboard_Sort_Key {
+	Plt_Texture *texture;
+	unsigned int draw_call_index;
+} Plt_Billboard_Sort_Key;
+
+Plt_Billboard_Processor *plt_billboard_processor_create() {
+	Plt_Billboard_Processor *processor = malloc(sizeof(Plt_Billboard_Processor));
+	return processor;
+}
+
+void plt_billboard_processor_destroy(Plt_Billboard_Processor **processor) {
+	free(*processor);
+	*processor = NULL;
+}
+
+static int plt_billboard_processor_compare_sort_keys(const void *a, const void *b) {
+	const Plt_Billboard_Sort_Key *key_a = a;
+	const Plt_Billboard_Sort_Key *key_b = b;
+
+	if (key_a->texture != key_b->texture) {
+		return ((uintptr_t)key_a->texture < (uintptr_t)key_b->texture) ? -1 : 1;
+	}
+
+	// Keep submission order within a texture batch
+	return (int)key_a->draw_call_index - (int)key_b->draw_call_index;
+}
+
+static inline void plt_billboard_processor_get_tile_range(int screen_x, int screen_y, int width, int height, Plt_Size tile_dimensions, Plt_Vector2i *tile_min, Plt_Vector2i *tile_max) {
+	tile_min->x = plt_clamp(screen_x / PLT_TRIANGLE_BIN_SIZE, 0, (int)tile_dimensions.width - 1);
+	tile_min->y = plt_clamp(screen_y / PLT_TRIANGLE_BIN_SIZE, 0, (int)tile_dimensions.height - 1);
+	tile_max->x = plt_clamp((screen_x + width - 1) / PLT_TRIANGLE_BIN_SIZE, 0, (int)tile_dimensions.width - 1);
+	tile_max->y = plt_clamp((screen_y + height - 1) / PLT_TRIANGLE_BIN_SIZE, 0, (int)tile_dimensions.height - 1);
+}
+
+void plt_billboard_processor_process_draw_calls(Plt_Billboard_Processor *processor, Plt_Linear_Allocator *allocator, Plt_Renderer_Draw_Call *draw_calls, unsigned int draw_call_count, Plt_Vector2i viewport, Plt_Triangle_Rasteriser *rasteriser) {
+	Plt_Size tile_dimensions = plt_rasteriser_get_triangle_bin_dimensions(rasteriser);
+	unsigned int tile_count = tile_dimensions.width * tile_dimensions.height;
+	if (tile_count == 0) {
+		return;
+	}
+
+	// Step 1: Gather billboard draw calls and sort them into texture batches
+	Plt_Billboard_Sort_Key *sort_keys = NULL;
+	unsigned int key_count = 0;
+	for (unsigned int i = 0; i < draw_call_count; ++i) {
+		if (draw_calls[i].type != Plt_Renderer_Draw_Call_Type_Draw_Billboard) {
+			continue;
+		}
+
+		if (!sort_keys) {
+			sort_keys = plt_linear_allocator_alloc(allocator, sizeof(Plt_Billboard_Sort_Key) * (draw_call_count - i));
+		}
+		sort_keys[key_count++] = (Plt_Billboard_Sort_Key){ draw_calls[i].texture, i };
+	}
+
+	if (key_count == 0) {
+		return;
+	}
+	qsort(sort_keys, key_count, sizeof(Plt_Billboard_Sort_Key), plt_billboard_processor_compare_sort_keys);
+
+	// Output
+	Plt_Billboard_Bin_Data_Buffer *data_buffer = plt_linear_allocator_alloc(allocator, sizeof(Plt_Billboard_Bin_Data_Buffer));
+	int *screen_x = plt_linear_allocator_alloc(allocator, sizeof(int) * key_count);
+	int *screen_y = plt_linear_allocator_alloc(allocator, sizeof(int) * key_count);
+	int *width = plt_linear_allocator_alloc(allocator, sizeof(int) * key_count);
+	int *height = plt_linear_allocator_alloc(allocator, sizeof(int) * key_count);
+	float *depth = plt_linear_allocator_alloc(allocator, sizeof(float) * key_count);
+	Plt_Color8 *colors = plt_linear_allocator_alloc(allocator, sizeof(Plt_Color8) * key_count);
+	Plt_Texture **textures = plt_linear_allocator_alloc(allocator, sizeof(Plt_Texture *) * key_count);
+	unsigned int *mip_level = plt_linear_allocator_alloc(allocator, sizeof(unsigned int) * key_count);
+	unsigned int *texel_step_x = plt_linear_allocator_alloc(allocator, sizeof(unsigned int) * key_count);
+	unsigned int *texel_step_y = plt_linear_allocator_alloc(allocator, sizeof(unsigned int) * key_count);
+	unsigned int *tile_offsets = plt_linear_allocator_alloc(allocator, sizeof(unsigned int) * (tile_count + 1));
+	memset(tile_offsets, 0, sizeof(unsigned int) * (tile_count + 1));
+
+	// Step 2: Project, cull and count quads per tile
+	unsigned int billboard_count = 0;
+	for (unsigned int i = 0; i < key_count; ++i) {
+		Plt_Renderer_Draw_Call *draw_call = &draw_calls[sort_keys[i].draw_call_index];
+
+		Plt_Vector4f view_position = plt_matrix_multiply_vector4f(plt_matrix_multiply(draw_call->view, draw_call->model), plt_vector4f_make(0, 0, 0, 1));
+		Plt_Vector4f clip_position = plt_matrix_multiply_vector4f(draw_call->projection, view_position);
+
+		// In front of the camera and within the depth range
+		if ((clip_position.w < 1e-6f) || (clip_position.z < 0.0f) || (clip_position.z > clip_position.w)) {
+			continue;
+		}
+
+		// Quads face the camera, so their extent scales with the projection's focal lengths
+		float inverse_w = 1.0f / clip_position.w;
+		float center_x = (clip_position.x * inverse_w * 0.5f + 0.5f) * viewport.x;
+		float center_y = (clip_position.y * inverse_w * 0.5f + 0.5f) * viewport.y;
+		float half_width = fminf(fabsf(draw_call->billboard_size.x * draw_call->projection.columns[0][0]) * inverse_w * 0.25f * viewport.x, PLT_BILLBOARD_MAX_EXTENT);
+		float half_height = fminf(fabsf(draw_call->billboard_size.y * draw_call->projection.columns[1][1]) * inverse_w * 0.25f * viewport.y, PLT_BILLBOARD_MAX_EXTENT);
+		if ((fabsf(center_x) > PLT_BILLBOARD_MAX_EXTENT) || (fabsf(center_y) > PLT_BILLBOARD_MAX_EXTENT)) {
+			continue;
+		}
+
+		int min_x = (int)floorf(center_x - half_width);
+		int min_y = (int)floorf(center_y - half_height);
+		int max_x = (int)ceilf(center_x + half_width);
+		int max_y = (int)ceilf(center_y + half_height);
+		if ((max_x <= min_x) || (max_y <= min_y) || (max_x <= 0) || (max_y <= 0) || (min_x >= viewport.x) || (min_y >= viewport.y)) {
+			continue;
+		}
+
+		unsigned int o = billboard_count++;
+		screen_x[o] = min_x;
+		screen_y[o] = min_y;
+		width[o] = max_x - min_x;
+		height[o] = max_y - min_y;
+		depth[o] = 1.0f / clip_position.z;
+		colors[o] = draw_call->color;
+		textures[o] = draw_call->texture;
+
+		if (draw_call->texture) {
+			Plt_Texture *texture = draw_call->texture;
+			mip_level[o] = plt_texture_select_mip_level(texture, plt_vector2f_make(1.0f / width[o], 0.0f), plt_vector2f_make(0.0f, 1.0f / height[o]));
+			Plt_Size texture_size = texture->mip_levels[mip_level[o]].size;
+			texel_step_x[o] = (unsigned int)(((float)texture_size.width / (float)width[o]) * 65536.0f);
+			texel_step_y[o] = (unsigned int)(((float)texture_size.height / (float)height[o]) * 65536.0f);
+		} else {
+			mip_level[o] = 0;
+			texel_step_x[o] = texel_step_y[o] = 0;
+		}
+
+		Plt_Vector2i tile_min, tile_max;
+		plt_billboard_processor_get_tile_range(screen_x[o], screen_y[o], width[o], height[o], tile_dimensions, &tile_min, &tile_max);
+		for (int ty = tile_min.y; ty <= tile_max.y; ++ty) {
+			for (int tx = tile_min.x; tx <= tile_max.x; ++tx) {
+				tile_offsets[ty * tile_dimensions.width + tx + 1]++;
+			}
+		}
+	}
+
+	if (billboard_count == 0) {
+		return;
+	}
+
+	// Step 3: Prefix sum tile counts into offsets
+	unsigned int *tile_cursors = plt_linear_allocator_alloc(allocator, sizeof(unsigned int) * tile_count);
+	for (unsigned int i = 0; i < tile_count; ++i) {
+		tile_offsets[i + 1] += tile_offsets[i];
+		tile_cursors[i] = tile_offsets[i];
+	}
+
+	// Step 4: Scatter quad indices into their tiles, preserving texture order
+	unsigned int *tile_billboard_indices = plt_linear_allocator_alloc(allocator, sizeof(unsigned int) * tile_offsets[tile_count]);
+	for (unsigned int i = 0; i < billboard_count; ++i) {
+		Plt_Vector2i tile_min, tile_max;
+		plt_billboard_processor_get_tile_range(screen_x[i], screen_y[i], width[i], height[i], tile_dimensions, &tile_min, &tile_max);
+		for (int ty = tile_min.y; ty <= tile_max.y; ++ty) {
+			for (int tx = tile_min.x; tx <= tile_max.x; ++tx) {
+				tile_billboard_indices[tile_cursors[ty * tile_dimensions.width + tx]++] = i;
+			}
+		}
+	}
+
+	*data_buffer = (Plt_Billboard_Bin_Data_Buffer) {
+		.billboard_count = billboard_count,
+		.screen_x = screen_x,
+		.screen_y = screen_y,
+		.width = width,
+		.height = height,
+		.depth = depth,
+		.color = colors,
+		.texture = textures,
+		.mip_level = mip_level,
+		.texel_step_x = texel_step_x,
+		.texel_step_y = texel_step_y,
+		.tile_offsets = tile_offsets,
+		.tile_billboard_indices = tile_billboard_indices
+	};
+
+	plt_rasteriser_set_billboard_buffer(rasteriser, data_buffer);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "platypus/platypus.h"
+
+typedef struct Plt_Billboard_Processor Plt_Billboard_Processor;
+
+Plt_Billboard_Processor *plt_billboard_processor_create();
+void plt_billboard_processor_destroy(Plt_Billboard_Processor **processor);
+
+typedef struct Plt_Renderer_Draw_Call Plt_Renderer_Draw_Call;
+typedef struct Plt_Triangle_Rasteriser Plt_Triangle_Rasteriser;
+typedef struct Plt_Linear_Allocator Plt_Linear_Allocator;
+void plt_billboard_processor_process_draw_calls(Plt_Billboard_Processor *processor, Plt_Linear_Allocator *allocator, Plt_Renderer_Draw_Call *draw_calls, unsigned int draw_call_count, Plt_Vector2i viewport, Plt_Triangle_Rasteriser *rasteriser);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "platypus/platypus.h"
+
+// Point draw calls the rasteriser's buffer list holds before it's grown, it's reallocated from
+// the frame allocator at twice the size whenever it fills up
+#define PLT_POINT_BIN_INITIAL_BUFFER_CAPACITY 64
+
+typedef struct Plt_Point_Bin_Data_Buffer {
+	unsigned int point_count;
+
+	// Splat size in pixels
+	unsigned int point_size;
+
+	// Top-left pixel of each splat
+	int *screen_x;
+	int *screen_y;
+
+	float *depth;
+	Plt_Color8 *color;
+
+	// Points binned per tile, tile i owns tile_point_indices[tile_offsets[i]..tile_offsets[i + 1]]
+	unsigned int *tile_offsets;
+	unsigned int *tile_point_indices;
+} Plt_Point_Bin_Data_Buffer;
@@ -0,0 +1,196 @@
+#include "plt_point_processor.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "platypus/base/allocation/plt_linear_allocator.h"
+#include "platypus/base/plt_simd.h"
+#include "platypus/mesh/plt_mesh.h"
+#include "plt_triangle_rasteriser.h"
+#include "plt_triangle_bin.h"
+#include "plt_point_bin.h"
+
+// Everything the stage works with lives in the frame allocator, the processor only exists so it's
+// created and owned like the other pipeline stages. C structs can't be empty
+typedef struct Plt_Point_Processor {
+	char unused;
+} Plt_Point_Processor;
+
+Plt_Point_Processor *plt_point_processor_create() {
+	Plt_Point_Processor *processor = malloc(sizeof(Plt_Point_Processor));
+	return processor;
+}
+
+void plt_point_processor_destroy(Plt_Point_Processor **processor) {
+	free(*processor);
+	*processor = NULL;
+}
+
+static inline void plt_point_processor_get_tile_range(int screen_x, int screen_y, unsigned int point_size, Plt_Size tile_dimensions, Plt_Vector2i *tile_min, Plt_Vector2i *tile_max) {
+	tile_min->x = plt_clamp(screen_x / PLT_TRIANGLE_BIN_SIZE, 0, (int)tile_dimensions.width - 1);
+	tile_min->y = plt_clamp(screen_y / PLT_TRIANGLE_BIN_SIZE, 0, (int)tile_dimensions.height - 1);
+	tile_max->x = plt_clamp((screen_x + (int)point_size - 1) / PLT_TRIANGLE_BIN_SIZE, 0, (int)tile_dimensions.width - 1);
+	tile_max->y = plt_clamp((screen_y + (int)point_size - 1) / PLT_TRIANGLE_BIN_SIZE, 0, (int)tile_dimensions.height - 1);
+}
+
+void plt_point_processor_process_mesh(Plt_Point_Processor *processor, Plt_Linear_Allocator *allocator, Plt_Mesh *mesh, Plt_Vector2i viewport, Plt_Matrix4x4f mvp, Plt_Texture *texture, Plt_Color8 color, unsigned int point_size, Plt_Triangle_Rasteriser *rasteriser) {
+	unsigned int vertex_count = mesh->vertex_count;
+	Plt_Size tile_dimensions = plt_rasteriser_get_triangle_bin_dimensions(rasteriser);
+	unsigned int tile_count = tile_dimensions.width * tile_dimensions.height;
+	if ((vertex_count == 0) || (tile_count == 0)) {
+		return;
+	}
+
+	point_size = plt_max(point_size, 1);
+	float half_size = (float)(point_size / 2);
+
+	// Input
+	float *model_positions_x = mesh->position_x;
+	float *model_positions_y = mesh->position_y;
+	float *model_positions_z = mesh->position_z;
+	float *model_uvs_x = mesh->uv_x;
+	float *model_uvs_y = mesh->uv_y;
+
+	// Output
+	Plt_Point_Bin_Data_Buffer *data_buffer = plt_linear_allocator_alloc(allocator, sizeof(Plt_Point_Bin_Data_Buffer));
+	int *screen_x = plt_linear_allocator_alloc(allocator, sizeof(int) * vertex_count);
+	int *screen_y = plt_linear_allocator_alloc(allocator, sizeof(int) * vertex_count);
+	float *depth = plt_linear_allocator_alloc(allocator, sizeof(float) * vertex_count);
+	Plt_Color8 *colors = plt_linear_allocator_alloc(allocator, sizeof(Plt_Color8) * vertex_count);
+	unsigned int *tile_offsets = plt_linear_allocator_alloc(allocator, sizeof(unsigned int) * (tile_count + 1));
+	memset(tile_offsets, 0, sizeof(unsigned int) * (tile_count + 1));
+
+	// Broadcast matrix columns
+	simd_float4 m[4][4];
+	for (unsigned int c = 0; c < 4; ++c) {
+		for (unsigned int r = 0; r < 4; ++r) {
+			m[c][r] = simd_float4_create_scalar(mvp.columns[c][r]);
+		}
+	}
+
+	const simd_float4 zero = simd_float4_create_scalar(0.0f);
+	const simd_float4 one = simd_float4_create_scalar(1.0f);
+	const simd_float4 min_w = simd_float4_create_scalar(1e-6f);
+	const simd_float4 half_viewport_x = simd_float4_create_scalar(viewport.x * 0.5f);
+	const simd_float4 half_viewport_y = simd_float4_create_scalar(viewport.y * 0.5f);
+	const simd_float4 splat_offset_x = simd_float4_create_scalar(viewport.x * 0.5f - half_size);
+	const simd_float4 splat_offset_y = simd_float4_create_scalar(viewport.y * 0.5f - half_size);
+
+	// Quantised attribute decoding
+	const simd_float4 position_scale_x = simd_float4_create_scalar(mesh->position_scale.x);
+	const simd_float4 position_scale_y = simd_float4_create_scalar(mesh->position_scale.y);
+	const simd_float4 position_scale_z = simd_float4_create_scalar(mesh->position_scale.z);
+	const simd_float4 position_offset_x = simd_float4_create_scalar(mesh->position_offset.x);
+	const simd_float4 position_offset_y = simd_float4_create_scalar(mesh->position_offset.y);
+	const simd_float4 position_offset_z = simd_float4_create_scalar(mesh->position_offset.z);
+
+	// Splats whose top-left lies outside of these bounds can't touch the viewport
+	const simd_float4 splat_min = simd_float4_create_scalar(-(float)point_size);
+	const simd_float4 splat_max_x = simd_float4_create_scalar(viewport.x);
+	const simd_float4 splat_max_y = simd_float4_create_scalar(viewport.y);
+
+	// Step 1: Transform, cull and count points per tile
+	unsigned int point_count = 0;
+	for (unsigned int i = 0; i < vertex_count; i += 4) {
+		unsigned int lane_count = plt_min(vertex_count - i, 4);
+
+		// Streams are aligned and padded, the tail loads zeros that get masked off below
+		simd_float4 x, y, z;
+		if (mesh->quantised) {
+			x = simd_float4_multiply_add(position_offset_x, simd_float4_from_int4(simd_int4_load_u16(mesh->quantised_position_x + i)), position_scale_x);
+			y = simd_float4_multiply_add(position_offset_y, simd_float4_from_int4(simd_int4_load_u16(mesh->quantised_position_y + i)), position_scale_y);
+			z = simd_float4_multiply_add(position_offset_z, simd_float4_from_int4(simd_int4_load_u16(mesh->quantised_position_z + i)), position_scale_z);
+		} else {
+			x = simd_float4_load(model_positions_x + i);
+			y = simd_float4_load(model_positions_y + i);
+			z = simd_float4_load(model_positions_z + i);
+		}
+
+		simd_float4 clip_x = simd_float4_multiply_add(simd_float4_multiply_add(simd_float4_multiply_add(m[3][0], m[0][0], x), m[1][0], y), m[2][0], z);
+		simd_float4 clip_y = simd_float4_multiply_add(simd_float4_multiply_add(simd_float4_multiply_add(m[3][1], m[0][1], x), m[1][1], y), m[2][1], z);
+		simd_float4 clip_z = simd_float4_multiply_add(simd_float4_multiply_add(simd_float4_multiply_add(m[3][2], m[0][2], x), m[1][2], y), m[2][2], z);
+		simd_float4 clip_w = simd_float4_multiply_add(simd_float4_multiply_add(simd_float4_multiply_add(m[3][3], m[0][3], x), m[1][3], y), m[2][3], z);
+
+		simd_float4 inverse_w = simd_float4_divide(one, clip_w);
+		simd_float4 splat_x = simd_float4_multiply_add(splat_offset_x, simd_float4_multiply(clip_x, inverse_w), half_viewport_x);
+		simd_float4 splat_y = simd_float4_multiply_add(splat_offset_y, simd_float4_multiply(clip_y, inverse_w), half_viewport_y);
+
+		// Frustum cull: in front of the camera, within the depth range and overlapping the viewport.
+		// Depth is stored as 1/z, so points right on the near plane are culled too
+		int visible = (1 << lane_count) - 1;
+		visible &= simd_float4_less_equal_mask(min_w, clip_w);
+		visible &= ~simd_float4_less_equal_mask(clip_z, zero);
+		visible &= simd_float4_less_equal_mask(clip_z, clip_w);
+		visible &= simd_float4_less_equal_mask(splat_min, splat_x);
+		visible &= simd_float4_less_equal_mask(splat_min, splat_y);
+		visible &= ~simd_float4_less_equal_mask(splat_max_x, splat_x);
+		visible &= ~simd_float4_less_equal_mask(splat_max_y, splat_y);
+		if (!visible) {
+			continue;
+		}
+
+		simd_int4 splat_x_i = simd_int4_from_float4(splat_x);
+		simd_int4 splat_y_i = simd_int4_from_float4(splat_y);
+		simd_float4 inverse_z = simd_float4_divide(one, clip_z);
+
+		for (unsigned int j = 0; j < 4; ++j) {
+			if (!(visible & (1 << j))) {
+				continue;
+			}
+
+			unsigned int o = point_count++;
+			screen_x[o] = splat_x_i.v[j];
+			screen_y[o] = splat_y_i.v[j];
+			depth[o] = inverse_z.v[j];
+			if (texture) {
+				Plt_Vector2f uv = mesh->quantised ? plt_mesh_decode_uv(mesh, i + j) : plt_vector2f_make(model_uvs_x[i + j], model_uvs_y[i + j]);
+				colors[o] = plt_texture_sample(texture, uv);
+			} else {
+				colors[o] = color;
+			}
+
+			Plt_Vector2i tile_min, tile_max;
+			plt_point_processor_get_tile_range(screen_x[o], screen_y[o], point_size, tile_dimensions, &tile_min, &tile_max);
+			for (int ty = tile_min.y; ty <= tile_max.y; ++ty) {
+				for (int tx = tile_min.x; tx <= tile_max.x; ++tx) {
+					tile_offsets[ty * tile_dimensions.width + tx + 1]++;
+				}
+			}
+		}
+	}
+
+	if (point_count == 0) {
+		return;
+	}
+
+	// Step 2: Prefix sum tile counts into offsets
+	unsigned int *tile_cursors = plt_linear_allocator_alloc(allocator, sizeof(unsigned int) * tile_count);
+	for (unsigned int i = 0; i < tile_count; ++i) {
+		tile_offsets[i + 1] += tile_offsets[i];
+		tile_cursors[i] = tile_offsets[i];
+	}
+
+	// Step 3: Scatter point indices into their tiles
+	unsigned int *tile_point_indices = plt_linear_allocator_alloc(allocator, sizeof(unsigned int) * tile_offsets[tile_count]);
+	for (unsigned int i = 0; i < point_count; ++i) {
+		Plt_Vector2i tile_min, tile_max;
+		plt_point_processor_get_tile_range(screen_x[i], screen_y[i], point_size, tile_dimensions, &tile_min, &tile_max);
+		for (int ty = tile_min.y; ty <= tile_max.y; ++ty) {
+			for (int tx = tile_min.x; tx <= tile_max.x; ++tx) {
+				tile_point_indices[tile_cursors[ty * tile_dimensions.width + tx]++] = i;
+			}
+		}
+	}
+
+	*data_buffer = (Plt_Point_Bin_Data_Buffer) {
+		.point_count = point_count,
+		.point_size = point_size,
+		.screen_x = screen_x,
+		.screen_y = screen_y,
+		.depth = depth,
+		.color = colors,
+		.tile_offsets = tile_offsets,
+		.tile_point_indices = tile_point_indices
+	};
+
+	plt_rasteriser_add_point_buffer(rasteriser, allocator, data_buffer);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "platypus/platypus.h"
+
+typedef struct Plt_Point_Processor Plt_Point_Processor;
+
+Plt_Point_Processor *plt_point_processor_create();
+void plt_point_processor_destroy(Plt_Point_Processor **processor);
+
+typedef struct Plt_Mesh Plt_Mesh;
+typedef struct Plt_Triangle_Rasteriser Plt_Triangle_Rasteriser;
+typedef struct Plt_Linear_Allocator Plt_Linear_Allocator;
+void plt_point_processor_process_mesh(Plt_Point_Processor *processor, Plt_Linear_Allocator *allocator, Plt_Mesh *mesh, Plt_Vector2i viewport, Plt_Matrix4x4f mvp, Plt_Texture *texture, Plt_Color8 color, unsigned int point_size, Plt_Triangle_Rasteriser *rasteriser);
@@ -18,10 +18,6 @@
 #error "Must supply RASTER_LIGHTING_MODEL"
 #endif
 
-#ifndef RASTER_DEBUG_THREAD_ID
-#define RASTER_DEBUG_THREAD_ID 0
-#endif
-
 void RASTER_FUNC_NAME(Plt_Triangle_Rasteriser *rasteriser, Plt_Rect region, unsigned int thread_id, Plt_Vertex_Processor_Result vertex_data, Plt_Triangle_Processor_Result triangle_data) {
 	Plt_Renderer *renderer = rasteriser->renderer;
 	Plt_Color8 *framebuffer_pixels = renderer->framebuffer.pixels;
@@ -30,18 +26,6 @@ void RASTER_FUNC_NAME(Plt_Triangle_Rasteriser *rasteriser, Plt_Rect region, unsi
 	int framebuffer_height = renderer->framebuffer.height;
 	Plt_Color8 render_color = renderer->render_color;
 	
-#if RASTER_DEBUG_THREAD_ID
-	Plt_Color8 debug_colors[6] = {
-		plt_color8_make(255, 0, 0, 255),
-		plt_color8_make(0, 255, 0, 255),
-		plt_color8_make(0, 0, 255, 255),
-		plt_color8_make(255, 255, 0, 255),
-		plt_color8_make(255, 0, 255, 255),
-		plt_color8_make(0, 255, 255, 255),
-	};
-	Plt_Color8 debug_color = debug_colors[thread_id % 6];
-#endif
-	
 	Plt_Vector3f normalized_light_direction = plt_vector3f_normalize(renderer->directional_lighting_direction);
 	
 	for (unsigned int i = 0; i < triangle_data.triangle_count; ++i) {
@@ -134,10 +118,6 @@ void RASTER_FUNC_NAME(Plt_Triangle_Rasteriser *rasteriser, Plt_Rect region, unsi
 						tex_color = render_color;
 					#endif
 
-					#if RASTER_DEBUG_THREAD_ID
-						tex_color = debug_color;
-					#endif
-					
 					#if RASTER_LIGHTING_MODEL == 1
 						tex_color = plt_color8_multiply_vector3f(tex_color, pixel_lighting);
 					#endif
@@ -154,7 +134,6 @@ void RASTER_FUNC_NAME(Plt_Triangle_Rasteriser *rasteriser, Plt_Rect region, unsi
 	}
 }
 
-#undef RASTER_DEBUG_THREAD_ID
 #undef RASTER_FUNC_NAME
 #undef RASTER_TEXTURED
 #undef RASTER_LIGHTING_MODEL
@@ -38,6 +38,7 @@ typedef struct Plt_Triangle_Bin_Data_Buffer {
 	Plt_Vector2f *uv0;
 	Plt_Vector2f *uv1;
 	Plt_Vector2f *uv2;
+	unsigned int *mip_level;
 	
 	// Lighting
 	Plt_Vector3f *lighting0;
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <math.h>
 #include "platypus/base/allocation/plt_linear_allocator.h"
+#include "platypus/texture/plt_texture.h"
 #include "plt_triangle_rasteriser.h"
 #include "plt_triangle_bin.h"
 
@@ -57,7 +58,7 @@ bool plt_triangle_processor_is_point_in_triangle(Plt_Vector2i point, simd_int4 b
 	return (bc.x <= 0) && (bc.y <= 0) && (bc.z <= 0);
 }
 
-void plt_triangle_processor_process_vertex_data(Plt_Triangle_Processor *processor, Plt_Linear_Allocator *allocator, Plt_Vector2i viewport, Plt_Texture *texture, Plt_Vertex_Processor_Result vertex_data, Plt_Triangle_Rasteriser *rasteriser) {
+void plt_triangle_processor_process_vertex_data(Plt_Triangle_Processor *processor, Plt_Linear_Allocator *allocator, Plt_Vector2i viewport, Plt_Texture *texture, Plt_Vertex_Processor_Result vertex_data, Plt_Triangle_Rasteriser *rasteriser, Plt_Renderer_Stats *stats) {
 	unsigned int triangle_count = vertex_data.vertex_count / 3;
 	Plt_Size texture_size = plt_texture_get_size(texture);
 	Plt_Vector2f texel_size = plt_texture_get_texel_size(texture);
@@ -91,12 +92,18 @@ void plt_triangle_processor_process_vertex_data(Plt_Triangle_Processor *processo
 	Plt_Vector2f *uv0 = plt_linear_allocator_alloc(allocator, sizeof(Plt_Vector2f) * triangle_count);
 	Plt_Vector2f *uv1 = plt_linear_allocator_alloc(allocator, sizeof(Plt_Vector2f) * triangle_count);
 	Plt_Vector2f *uv2 = plt_linear_allocator_alloc(allocator, sizeof(Plt_Vector2f) * triangle_count);
+	unsigned int *mip_level = plt_linear_allocator_alloc(allocator, sizeof(unsigned int) * triangle_count);
 	
 	// Lighting
 	Plt_Vector3f *lighting0 = plt_linear_allocator_alloc(allocator, sizeof(Plt_Vector3f) * triangle_count);
 	Plt_Vector3f *lighting1 = plt_linear_allocator_alloc(allocator, sizeof(Plt_Vector3f) * triangle_count);
 	Plt_Vector3f *lighting2 = plt_linear_allocator_alloc(allocator, sizeof(Plt_Vector3f) * triangle_count);
 
+	unsigned int culled_behind_camera = 0;
+	unsigned int culled_zero_area = 0;
+	unsigned int culled_back_face = 0;
+	unsigned int bin_overflow_count = 0;
+
 	unsigned int output_triangle_count = 0;
 	for (unsigned int i = 0; i < triangle_count; ++i) {
 		unsigned int o = output_triangle_count;
@@ -104,6 +111,7 @@ void plt_triangle_processor_process_vertex_data(Plt_Triangle_Processor *processo
 
 		// Don't render triangles behind the camera
 		if ((clipspace_w[v] < 0) || (clipspace_w[v + 1] < 0) || (clipspace_w[v + 2] < 0)) {
+			++culled_behind_camera;
 			continue;
 		}
 
@@ -132,6 +140,7 @@ void plt_triangle_processor_process_vertex_data(Plt_Triangle_Processor *processo
 
 		// Cull triangles with zero size
 		if ((bounds_max.x - bounds_min.x == 0) || (bounds_max.y - bounds_min.y == 0)) {
+			++culled_zero_area;
 			continue;
 		}
 		
@@ -140,6 +149,7 @@ void plt_triangle_processor_process_vertex_data(Plt_Triangle_Processor *processo
 		simd_int4 c_center = plt_triangle_processor_orient2d(a_x, a_y, b_x, b_y, simd_int4_create_scalar(center_pixel.x), simd_int4_create_scalar(center_pixel.y));
 		bool backward_facing = (c_center.x > 0) && (c_center.y > 0) && (c_center.z > 0);
 		if (backward_facing) {
+			++culled_back_face;
 			continue;
 		}
 		
@@ -148,7 +158,8 @@ void plt_triangle_processor_process_vertex_data(Plt_Triangle_Processor *processo
 		triangle_area[o] = bc_initial[o].x + bc_initial[o].y + bc_initial[o].z;
 		
 		// Degnerate triangle
-		if (triangle_area == 0) {
+		if (triangle_area[o] == 0) {
+			++culled_zero_area;
 			continue;
 		}
 		
@@ -162,6 +173,19 @@ void plt_triangle_processor_process_vertex_data(Plt_Triangle_Processor *processo
 		uv1[o] = plt_vector2f_make(uv_x[v + 1], uv_y[v + 1]);
 		uv2[o] = plt_vector2f_make(uv_x[v + 2], uv_y[v + 2]);
 		
+		// UVs are interpolated linearly in screen space, so their derivatives (and the LOD of
+		// every 2x2 quad) are constant across the triangle and only need selecting once
+		float inverse_area = 1.0f / triangle_area[o];
+		Plt_Vector2f uv_dx = {
+			(uv0[o].x * bc_increment_x[o].x + uv1[o].x * bc_increment_x[o].y + uv2[o].x * bc_increment_x[o].z) * inverse_area,
+			(uv0[o].y * bc_increment_x[o].x + uv1[o].y * bc_increment_x[o].y + uv2[o].y * bc_increment_x[o].z) * inverse_area
+		};
+		Plt_Vector2f uv_dy = {
+			(uv0[o].x * bc_increment_y[o].x + uv1[o].x * bc_increment_y[o].y + uv2[o].x * bc_increment_y[o].z) * inverse_area,
+			(uv0[o].y * bc_increment_y[o].x + uv1[o].y * bc_increment_y[o].y + uv2[o].y * bc_increment_y[o].z) * inverse_area
+		};
+		mip_level[o] = plt_texture_select_mip_level(texture, uv_dx, uv_dy);
+		
 		// Depth
 		depth0[o] = 1.0f / clipspace_z[v];
 		depth1[o] = 1.0f / clipspace_z[v + 1];
@@ -203,6 +227,8 @@ void plt_triangle_processor_process_vertex_data(Plt_Triangle_Processor *processo
 				Plt_Triangle_Bin *bin = plt_rasteriser_get_triangle_bin(rasteriser, plt_vector2i_make(x, y));
 				if (bin->triangle_count < PLT_TRIANGLE_BIN_MAX_TRIANGLES) {
 					bin->entries[bin->triangle_count++] = bin_entry;
+				} else {
+					++bin_overflow_count;
 				}
 			}
 		}
@@ -210,6 +236,13 @@ void plt_triangle_processor_process_vertex_data(Plt_Triangle_Processor *processo
 		++output_triangle_count;
 	}
 	
+	stats->triangles_submitted += triangle_count;
+	stats->triangles_culled_behind_camera += culled_behind_camera;
+	stats->triangles_culled_zero_area += culled_zero_area;
+	stats->triangles_culled_back_face += culled_back_face;
+	stats->triangles_binned += output_triangle_count;
+	stats->bin_overflow_count += bin_overflow_count;
+	
 	*data_buffer = (Plt_Triangle_Bin_Data_Buffer){
 		.triangle_count = output_triangle_count,
 		.bc_initial = bc_initial,
@@ -222,6 +255,7 @@ void plt_triangle_processor_process_vertex_data(Plt_Triangle_Processor *processo
 		.uv0 = uv0,
 		.uv1 = uv1,
 		.uv2 = uv2,
+		.mip_level = mip_level,
 		.lighting0 = lighting0,
 		.lighting1 = lighting1,
 		.lighting2 = lighting2
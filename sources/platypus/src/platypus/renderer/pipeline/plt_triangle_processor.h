@@ -25,4 +25,5 @@ void plt_triangle_processor_destroy(Plt_Triangle_Processor **processor);
 
 typedef struct Plt_Triangle_Rasteriser Plt_Triangle_Rasteriser;
 typedef struct Plt_Linear_Allocator Plt_Linear_Allocator;
-void plt_triangle_processor_process_vertex_data(Plt_Triangle_Processor *processor, Plt_Linear_Allocator *allocator, Plt_Vector2i viewport, Plt_Texture *texture, Plt_Vertex_Processor_Result vertex_data, Plt_Triangle_Rasteriser *rasteriser);
+// Culled and binned triangles are counted into stats
+void plt_triangle_processor_process_vertex_data(Plt_Triangle_Processor *processor, Plt_Linear_Allocator *allocator, Plt_Vector2i viewport, Plt_Texture *texture, Plt_Vertex_Processor_Result vertex_data, Plt_Triangle_Rasteriser *rasteriser, Plt_Renderer_Stats *stats);
@@ -6,10 +6,23 @@
 #include "platypus/renderer/plt_renderer.h"
 #include "platypus/base/plt_defines.h"
 #include "platypus/base/plt_macros.h"
+#include "platypus/texture/plt_texture.h"
 
 #include "plt_triangle_bin.h"
+#include "plt_point_bin.h"
+#include "plt_billboard_bin.h"
 
 #include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Tile overlay flags, set for tiles that lines and direct draws paint over after (or instead of) the tile pass
+#define PLT_TILE_OVERLAY_CURRENT_FRAME (1 << 0)
+#define PLT_TILE_OVERLAY_PREVIOUS_FRAME (1 << 1)
+
+// Overdraw at or above this many writes shows as the hottest colour
+#define PLT_DEBUG_VIEW_MAX_OVERDRAW 8
 
 void *_raster_thread(unsigned int thread_id, void *thread_data);
 typedef struct Plt_Triangle_Rasteriser_Thread_Data {
@@ -20,6 +33,18 @@ typedef struct Plt_Triangle_Rasteriser_Thread_Data {
 	Plt_Vertex_Processor_Result vp_result;
 } Plt_Triangle_Rasteriser_Thread_Data;
 
+// Counted by each raster thread into locals and stored once its tiles are done, summed into the renderer's stats
+typedef struct Plt_Triangle_Rasteriser_Thread_Stats {
+	unsigned int tiles_rasterised;
+	unsigned int full_coverage_entries;
+	unsigned int partial_coverage_entries;
+	uint64_t pixels_tested;
+	uint64_t pixels_written;
+
+	// From the thread picking up the frame to running out of tiles
+	uint64_t busy_ns;
+} Plt_Triangle_Rasteriser_Thread_Stats;
+
 typedef struct Plt_Triangle_Rasteriser {
 	Plt_Renderer *renderer;
 	Plt_Size viewport_size;
@@ -27,11 +52,42 @@ typedef struct Plt_Triangle_Rasteriser {
 	float *depth_buffer;
 
 	Plt_Thread_Pool *thread_pool;
+	unsigned int thread_count;
+	Plt_Triangle_Rasteriser_Thread_Stats *thread_stats;
 
 	Plt_Size triangle_bin_dimensions;
 	unsigned int triangle_bin_count;
 	Plt_Triangle_Bin *triangle_bins;
 	Plt_Thread_Safe_Stack *triangle_bin_stack;
+
+	// Entries kept across frames, packed by tile: tile i owns entries [offsets[i], offsets[i + 1])
+	unsigned int *static_triangle_offsets;
+	unsigned int static_triangle_capacity;
+	Plt_Triangle_Bin_Entry *static_triangle_entries;
+
+	// Static entries only change when captured, so each tile's are hashed then. Textures can still be
+	// edited in place, each tile keeps the textures its static entries sample to check their revisions
+	uint64_t *static_tile_hashes;
+	unsigned int *static_texture_offsets;
+	Plt_Texture **static_textures;
+
+	// Hash of everything drawn into each tile last time it was rendered, tiles with an unchanged
+	// hash still hold the right pixels and are skipped. tile_dirty records which tiles were redrawn.
+	bool tiles_invalidated;
+	uint64_t *tile_hashes;
+	bool *tile_dirty;
+	unsigned char *tile_overlay;
+
+	// Debug view the frame is rendered with, and each tile's value for tile views
+	Plt_Renderer_Debug_View debug_view;
+	uint64_t *tile_debug_values;
+
+	// Lives in the frame allocator like the buffers themselves
+	unsigned int point_buffer_count;
+	unsigned int point_buffer_capacity;
+	Plt_Point_Bin_Data_Buffer **point_buffers;
+
+	Plt_Billboard_Bin_Data_Buffer *billboard_buffer;
 	
 	Plt_Vertex_Processor_Result thread_vp_result;
 	Plt_Triangle_Processor_Result thread_tp_result;
@@ -50,32 +106,96 @@ Plt_Triangle_Rasteriser *plt_triangle_rasteriser_create(Plt_Renderer *renderer,
 	rasteriser->depth_buffer = NULL;
 
 	// Create threads
-	unsigned int platform_core_count = plt_platform_get_core_count();
-	plt_assert(platform_core_count > 0, "No cores detected on device\n");
-	platform_core_count = 1;
-	rasteriser->thread_pool = plt_thread_pool_create(_raster_thread, rasteriser, platform_core_count);
+	rasteriser->thread_pool = NULL;
+	rasteriser->thread_stats = NULL;
+	plt_triangle_rasteriser_set_thread_count(rasteriser, 0);
 	
 	rasteriser->triangle_bins = NULL;
+	rasteriser->triangle_bin_dimensions = plt_size_make(0, 0);
 	rasteriser->triangle_bin_count = 0;
 	rasteriser->triangle_bin_stack = plt_thread_safe_stack_create(4096);
+	rasteriser->static_triangle_offsets = NULL;
+	rasteriser->static_triangle_capacity = 0;
+	rasteriser->static_triangle_entries = NULL;
+	rasteriser->static_tile_hashes = NULL;
+	rasteriser->static_texture_offsets = NULL;
+	rasteriser->static_textures = NULL;
+	rasteriser->tiles_invalidated = true;
+	rasteriser->tile_hashes = NULL;
+	rasteriser->tile_dirty = NULL;
+	rasteriser->tile_overlay = NULL;
+	rasteriser->debug_view = Plt_Renderer_Debug_View_None;
+	rasteriser->tile_debug_values = NULL;
+	rasteriser->point_buffer_count = 0;
+	rasteriser->point_buffer_capacity = 0;
+	rasteriser->point_buffers = NULL;
+	rasteriser->billboard_buffer = NULL;
 
 	return rasteriser;
 }
 
 void plt_triangle_rasteriser_destroy(Plt_Triangle_Rasteriser **rasteriser) {
 	plt_thread_pool_destroy(&(*rasteriser)->thread_pool);
+	free((*rasteriser)->thread_stats);
+	plt_thread_safe_stack_destroy(&(*rasteriser)->triangle_bin_stack);
+	if ((*rasteriser)->triangle_bins) {
+		free((*rasteriser)->triangle_bins);
+	}
+	if ((*rasteriser)->static_triangle_offsets) {
+		free((*rasteriser)->static_triangle_offsets);
+		free((*rasteriser)->static_tile_hashes);
+		free((*rasteriser)->static_texture_offsets);
+	}
+	if ((*rasteriser)->static_triangle_entries) {
+		free((*rasteriser)->static_triangle_entries);
+		free((*rasteriser)->static_textures);
+	}
+	if ((*rasteriser)->tile_hashes) {
+		free((*rasteriser)->tile_hashes);
+		free((*rasteriser)->tile_dirty);
+		free((*rasteriser)->tile_overlay);
+		free((*rasteriser)->tile_debug_values);
+	}
 	free(*rasteriser);
 	*rasteriser = NULL;
 }
 
+void plt_triangle_rasteriser_set_thread_count(Plt_Triangle_Rasteriser *rasteriser, unsigned int thread_count) {
+	if (thread_count == 0) {
+		thread_count = plt_platform_get_core_count();
+		plt_assert(thread_count > 0, "No cores detected on device\n");
+	}
+
+	if (rasteriser->thread_pool) {
+		plt_thread_pool_destroy(&rasteriser->thread_pool);
+	}
+	rasteriser->thread_pool = plt_thread_pool_create(_raster_thread, rasteriser, thread_count);
+	rasteriser->thread_count = thread_count;
+
+	if (rasteriser->thread_stats) {
+		free(rasteriser->thread_stats);
+	}
+	rasteriser->thread_stats = malloc(sizeof(Plt_Triangle_Rasteriser_Thread_Stats) * thread_count);
+}
+
+unsigned int plt_triangle_rasteriser_get_thread_count(Plt_Triangle_Rasteriser *rasteriser) {
+	return rasteriser->thread_count;
+}
+
 void plt_triangle_rasteriser_update_framebuffer(Plt_Triangle_Rasteriser *rasteriser, Plt_Framebuffer framebuffer) {
+	// A new pixel buffer holds none of the previous frame
+	if (framebuffer.pixels != rasteriser->framebuffer.pixels) {
+		rasteriser->tiles_invalidated = true;
+	}
 	rasteriser->framebuffer = framebuffer;
 	rasteriser->viewport_size = (Plt_Size){ framebuffer.width, framebuffer.height };
 	
+	Plt_Size previous_dimensions = rasteriser->triangle_bin_dimensions;
 	rasteriser->triangle_bin_dimensions = plt_size_make(rasteriser->viewport_size.width / PLT_TRIANGLE_BIN_SIZE, rasteriser->viewport_size.height / PLT_TRIANGLE_BIN_SIZE);
+	bool resized = (previous_dimensions.width != rasteriser->triangle_bin_dimensions.width) || (previous_dimensions.height != rasteriser->triangle_bin_dimensions.height);
 	
 	unsigned int required_triangle_bin_count = rasteriser->triangle_bin_dimensions.width * rasteriser->triangle_bin_dimensions.height;
-	if (rasteriser->triangle_bin_count < required_triangle_bin_count) {
+	if ((rasteriser->triangle_bin_count < required_triangle_bin_count) || !rasteriser->static_triangle_offsets) {
 		if (rasteriser->triangle_bins) {
 			free(rasteriser->triangle_bins);
 		}
@@ -86,8 +206,38 @@ void plt_triangle_rasteriser_update_framebuffer(Plt_Triangle_Rasteriser *rasteri
 		}
 		
 		rasteriser->triangle_bins = malloc(sizeof(Plt_Triangle_Bin) * required_triangle_bin_count);
+		
+		if (rasteriser->static_triangle_offsets) {
+			free(rasteriser->static_triangle_offsets);
+			free(rasteriser->static_tile_hashes);
+			free(rasteriser->static_texture_offsets);
+		}
+		rasteriser->static_triangle_offsets = malloc(sizeof(unsigned int) * (required_triangle_bin_count + 1));
+		rasteriser->static_tile_hashes = malloc(sizeof(uint64_t) * plt_max(required_triangle_bin_count, 1));
+		rasteriser->static_texture_offsets = malloc(sizeof(unsigned int) * (required_triangle_bin_count + 1));
+		
+		if (rasteriser->tile_hashes) {
+			free(rasteriser->tile_hashes);
+			free(rasteriser->tile_dirty);
+			free(rasteriser->tile_overlay);
+			free(rasteriser->tile_debug_values);
+		}
+		rasteriser->tile_hashes = malloc(sizeof(uint64_t) * plt_max(required_triangle_bin_count, 1));
+		rasteriser->tile_dirty = malloc(sizeof(bool) * plt_max(required_triangle_bin_count, 1));
+		rasteriser->tile_overlay = malloc(sizeof(unsigned char) * plt_max(required_triangle_bin_count, 1));
+		rasteriser->tile_debug_values = malloc(sizeof(uint64_t) * plt_max(required_triangle_bin_count, 1));
 	}
 	rasteriser->triangle_bin_count = required_triangle_bin_count;
+	
+	// Static bins no longer line up with the tiles, leave them empty until recaptured
+	if (resized) {
+		memset(rasteriser->static_triangle_offsets, 0, sizeof(unsigned int) * (required_triangle_bin_count + 1));
+		memset(rasteriser->static_tile_hashes, 0, sizeof(uint64_t) * required_triangle_bin_count);
+		memset(rasteriser->static_texture_offsets, 0, sizeof(unsigned int) * (required_triangle_bin_count + 1));
+		memset(rasteriser->tile_overlay, 0, sizeof(unsigned char) * required_triangle_bin_count);
+		memset(rasteriser->tile_dirty, true, sizeof(bool) * required_triangle_bin_count);
+		rasteriser->tiles_invalidated = true;
+	}
 }
 
 void plt_triangle_rasteriser_update_depth_buffer(Plt_Triangle_Rasteriser *rasteriser, float *depth_buffer) {
@@ -98,49 +248,308 @@ void plt_triangle_rasteriser_update_depth_buffer(Plt_Triangle_Rasteriser *raster
 *(py + offset) = clear_color; \
 *(dy + offset) = 0.0f;
 
-#define PAINT_PIXEL(offset) \
+#define PAINT_PIXEL(offset, SAMPLE) \
 if (full_coverage || (bc_x.x <= 0) && (bc_x.y <= 0) && (bc_x.z <= 0)) { \
 	simd_float4 weights = simd_float4_create(bc_x.x / triangle_area, bc_x.y / triangle_area, bc_x.z / triangle_area, 0.0f); \
+	++pixels_tested; \
 	\
 	float depth = depth0 * weights.x + depth1 * weights.y + depth2 * weights.z; \
 	if (depth > *(dy + offset)) { \
+		++pixels_written; \
 		*(dy + offset) = depth; \
-		Plt_Vector2i tex_coord = { \
-			.x = (uv0.x * weights.x + uv1.x * weights.y + uv2.x * weights.z) * texture_size.width, \
-			.y = (uv0.y * weights.x + uv1.y * weights.y + uv2.y * weights.z) * texture_size.height \
-		}; \
+		float texel_x = (uv0.x * weights.x + uv1.x * weights.y + uv2.x * weights.z) * texture_size.width; \
+		float texel_y = (uv0.y * weights.x + uv1.y * weights.y + uv2.y * weights.z) * texture_size.height; \
 		Plt_Vector3f lighting = plt_vector3f_make(0, 0, 0); \
 		lighting = plt_vector3f_add(lighting, plt_vector3f_multiply_scalar(lighting0, weights.x)); \
 		lighting = plt_vector3f_add(lighting, plt_vector3f_multiply_scalar(lighting1, weights.y)); \
 		lighting = plt_vector3f_add(lighting, plt_vector3f_multiply_scalar(lighting2, weights.z)); \
-		*(py + offset) = plt_color8_multiply_vector3f(plt_texture_get_pixel(texture, tex_coord), lighting); \
+		*(py + offset) = plt_color8_multiply_vector3f(SAMPLE(mip_level, texel_x, texel_y), lighting); \
 	} \
 } \
 bc_x = simd_int4_add(bc_x, bc_increment_x);
 
+// Rasterises one binned triangle into its tile, SAMPLE filters texels from the triangle's mip level
+#define TRIANGLE_KERNEL(name, SAMPLE) \
+void name(Plt_Triangle_Bin_Entry entry, Plt_Rect bin_region, Plt_Color8 *pixel_initial, float *depth_initial, unsigned int row_length, Plt_Triangle_Rasteriser_Thread_Stats *stats) { \
+	Plt_Triangle_Bin_Data_Buffer *data_buffer = entry.buffer; \
+	bool full_coverage = entry.coverage == Plt_Triangle_Tile_Coverage_Full; \
+	\
+	const Plt_Texture_Mip_Level *mip_level = &entry.texture->mip_levels[data_buffer->mip_level[entry.index]]; \
+	Plt_Size texture_size = mip_level->size; \
+	\
+	simd_int4 bc_initial = data_buffer->bc_initial[entry.index]; \
+	simd_int4 bc_increment_x = data_buffer->bc_increment_x[entry.index]; \
+	simd_int4 bc_increment_y = data_buffer->bc_increment_y[entry.index]; \
+	float triangle_area = data_buffer->triangle_area[entry.index]; \
+	\
+	float depth0 = data_buffer->depth0[entry.index]; \
+	float depth1 = data_buffer->depth1[entry.index]; \
+	float depth2 = data_buffer->depth2[entry.index]; \
+	\
+	Plt_Vector2f uv0 = data_buffer->uv0[entry.index]; \
+	Plt_Vector2f uv1 = data_buffer->uv1[entry.index]; \
+	Plt_Vector2f uv2 = data_buffer->uv2[entry.index]; \
+	\
+	Plt_Vector3f lighting0 = data_buffer->lighting0[entry.index]; \
+	Plt_Vector3f lighting1 = data_buffer->lighting1[entry.index]; \
+	Plt_Vector3f lighting2 = data_buffer->lighting2[entry.index]; \
+	\
+	simd_int4 bc_y = simd_int4_add(simd_int4_add(bc_initial, simd_int4_multiply(bc_increment_y, simd_int4_create_scalar(bin_region.y))), simd_int4_multiply(bc_increment_x, simd_int4_create_scalar(bin_region.x))); \
+	Plt_Color8 *py = pixel_initial; \
+	float *dy = depth_initial; \
+	unsigned int pixels_tested = 0; \
+	unsigned int pixels_written = 0; \
+	for (unsigned int y = 0; y < PLT_TRIANGLE_BIN_SIZE; ++y) { \
+		simd_int4 bc_x = bc_y; \
+		PAINT_PIXEL(0, SAMPLE)  PAINT_PIXEL(1, SAMPLE) \
+		PAINT_PIXEL(2, SAMPLE)  PAINT_PIXEL(3, SAMPLE) \
+		PAINT_PIXEL(4, SAMPLE)  PAINT_PIXEL(5, SAMPLE) \
+		PAINT_PIXEL(6, SAMPLE)  PAINT_PIXEL(7, SAMPLE) \
+		PAINT_PIXEL(8, SAMPLE)  PAINT_PIXEL(9, SAMPLE) \
+		PAINT_PIXEL(10, SAMPLE) PAINT_PIXEL(11, SAMPLE) \
+		PAINT_PIXEL(12, SAMPLE) PAINT_PIXEL(13, SAMPLE) \
+		PAINT_PIXEL(14, SAMPLE) PAINT_PIXEL(15, SAMPLE) \
+		py += row_length; \
+		dy += row_length; \
+		bc_y = simd_int4_add(bc_y, bc_increment_y); \
+	} \
+	stats->pixels_tested += pixels_tested; \
+	stats->pixels_written += pixels_written; \
+}
+
+#if PLT_TRIANGLE_BIN_SIZE != 16
+#error Unwrapped triangle kernel needs to be updated for new triangle size
+#endif
+
+// Instantiates a kernel for every address mode and layout of one filter and texel format
+#define TRIANGLE_KERNELS(filter, format) \
+TRIANGLE_KERNEL(plt_triangle_kernel_##filter##_wrap_power_of_two_linear_##format, plt_texture_sample_##filter##_wrap_power_of_two_linear_##format) \
+TRIANGLE_KERNEL(plt_triangle_kernel_##filter##_wrap_power_of_two_tiled_##format, plt_texture_sample_##filter##_wrap_power_of_two_tiled_##format) \
+TRIANGLE_KERNEL(plt_triangle_kernel_##filter##_wrap_linear_##format, plt_texture_sample_##filter##_wrap_linear_##format) \
+TRIANGLE_KERNEL(plt_triangle_kernel_##filter##_wrap_tiled_##format, plt_texture_sample_##filter##_wrap_tiled_##format) \
+TRIANGLE_KERNEL(plt_triangle_kernel_##filter##_clamp_linear_##format, plt_texture_sample_##filter##_clamp_linear_##format) \
+TRIANGLE_KERNEL(plt_triangle_kernel_##filter##_clamp_tiled_##format, plt_texture_sample_##filter##_clamp_tiled_##format)
+
+// Kernel table entry for one filter and texel format, indexed by [address][tiled]
+#define TRIANGLE_KERNEL_TABLE(filter, format) { \
+	{ plt_triangle_kernel_##filter##_wrap_power_of_two_linear_##format, plt_triangle_kernel_##filter##_wrap_power_of_two_tiled_##format }, \
+	{ plt_triangle_kernel_##filter##_wrap_linear_##format, plt_triangle_kernel_##filter##_wrap_tiled_##format }, \
+	{ plt_triangle_kernel_##filter##_clamp_linear_##format, plt_triangle_kernel_##filter##_clamp_tiled_##format } \
+}
+
+TRIANGLE_KERNELS(nearest, color8)
+TRIANGLE_KERNELS(bilinear, color8)
+TRIANGLE_KERNELS(nearest, indexed8)
+TRIANGLE_KERNELS(bilinear, indexed8)
+
+typedef void (*Plt_Triangle_Kernel)(Plt_Triangle_Bin_Entry entry, Plt_Rect bin_region, Plt_Color8 *pixel_initial, float *depth_initial, unsigned int row_length, Plt_Triangle_Rasteriser_Thread_Stats *stats);
+
+Plt_Triangle_Kernel plt_triangle_rasteriser_select_kernel(Plt_Texture *texture) {
+	static const Plt_Triangle_Kernel kernels[2][2][3][2] = {
+		[Plt_Texture_Format_Color8] = {
+			[Plt_Texture_Filter_Nearest] = TRIANGLE_KERNEL_TABLE(nearest, color8),
+			[Plt_Texture_Filter_Bilinear] = TRIANGLE_KERNEL_TABLE(bilinear, color8)
+		},
+		[Plt_Texture_Format_Indexed8] = {
+			[Plt_Texture_Filter_Nearest] = TRIANGLE_KERNEL_TABLE(nearest, indexed8),
+			[Plt_Texture_Filter_Bilinear] = TRIANGLE_KERNEL_TABLE(bilinear, indexed8)
+		}
+	};
+	
+	// Power-of-two wrap, generic wrap or clamp
+	unsigned int address = 1;
+	if (texture->address_mode == Plt_Texture_Address_Mode_Clamp) {
+		address = 2;
+	} else if (texture->power_of_two) {
+		address = 0;
+	}
+	return kernels[texture->format][texture->filter][address][texture->layout == Plt_Texture_Layout_Tiled];
+}
+
+// Overdraw debug view kernel, depth tests one binned triangle like the shading kernels but counts
+// the pixels it writes into the tile's overdraw buffer instead of shading them
+void plt_triangle_kernel_overdraw(Plt_Triangle_Bin_Entry entry, Plt_Rect bin_region, float *depth_initial, unsigned int row_length, unsigned char *overdraw, Plt_Triangle_Rasteriser_Thread_Stats *stats) {
+	Plt_Triangle_Bin_Data_Buffer *data_buffer = entry.buffer;
+	bool full_coverage = entry.coverage == Plt_Triangle_Tile_Coverage_Full;
+	
+	simd_int4 bc_increment_x = data_buffer->bc_increment_x[entry.index];
+	simd_int4 bc_increment_y = data_buffer->bc_increment_y[entry.index];
+	float triangle_area = data_buffer->triangle_area[entry.index];
+	float depth0 = data_buffer->depth0[entry.index];
+	float depth1 = data_buffer->depth1[entry.index];
+	float depth2 = data_buffer->depth2[entry.index];
+	
+	simd_int4 bc_y = simd_int4_add(simd_int4_add(data_buffer->bc_initial[entry.index], simd_int4_multiply(bc_increment_y, simd_int4_create_scalar(bin_region.y))), simd_int4_multiply(bc_increment_x, simd_int4_create_scalar(bin_region.x)));
+	float *dy = depth_initial;
+	for (unsigned int y = 0; y < PLT_TRIANGLE_BIN_SIZE; ++y) {
+		simd_int4 bc_x = bc_y;
+		for (unsigned int x = 0; x < PLT_TRIANGLE_BIN_SIZE; ++x) {
+			if (full_coverage || (bc_x.x <= 0) && (bc_x.y <= 0) && (bc_x.z <= 0)) {
+				simd_float4 weights = simd_float4_create(bc_x.x / triangle_area, bc_x.y / triangle_area, bc_x.z / triangle_area, 0.0f);
+				++stats->pixels_tested;
+				
+				float depth = depth0 * weights.x + depth1 * weights.y + depth2 * weights.z;
+				if (depth > dy[x]) {
+					++stats->pixels_written;
+					dy[x] = depth;
+					unsigned char *count = &overdraw[y * PLT_TRIANGLE_BIN_SIZE + x];
+					*count = plt_min(*count + 1, 255);
+				}
+			}
+			bc_x = simd_int4_add(bc_x, bc_increment_x);
+		}
+		dy += row_length;
+		bc_y = simd_int4_add(bc_y, bc_increment_y);
+	}
+}
+
+// Blue through green and yellow to red as t goes from 0 to 1
+static Plt_Color8 plt_triangle_rasteriser_heat_color(float t) {
+	t = plt_clamp(t, 0.0f, 1.0f) * 3.0f;
+	if (t < 1.0f) {
+		return plt_color8_make(0, t * 255, (1.0f - t) * 255, 255);
+	} else if (t < 2.0f) {
+		return plt_color8_make((t - 1.0f) * 255, 255, 0, 255);
+	}
+	return plt_color8_make(255, (3.0f - t) * 255, 0, 255);
+}
+
+#define PLT_TRIANGLE_RASTERISER_HASH_SEED 0xcbf29ce484222325ULL
+
+// Multiply-xorshift over 64-bit words, then a 32-bit tail, size must be a multiple of 4. Sizes are
+// constant at every call, so the loops unroll into a multiply per 8 bytes
+static inline uint64_t plt_triangle_rasteriser_hash_word(uint64_t hash, uint64_t word) {
+	hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+	return hash ^ (hash >> 32);
+}
+
+static inline uint64_t plt_triangle_rasteriser_hash(uint64_t hash, const void *data, size_t size) {
+	const unsigned char *bytes = data;
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, bytes + i, sizeof(uint64_t));
+		hash = plt_triangle_rasteriser_hash_word(hash, word);
+	}
+	if (i < size) {
+		uint32_t word;
+		memcpy(&word, bytes + i, sizeof(uint32_t));
+		hash = plt_triangle_rasteriser_hash_word(hash, word);
+	}
+	return hash;
+}
+
+#define PLT_HASH_VALUE(hash, value) hash = plt_triangle_rasteriser_hash(hash, &(value), sizeof(value))
+
+static inline uint64_t plt_triangle_rasteriser_hash_texture(uint64_t hash, Plt_Texture *texture) {
+	PLT_HASH_VALUE(hash, texture);
+	if (texture) {
+		PLT_HASH_VALUE(hash, texture->revision);
+	}
+	return hash;
+}
+
+// Hashes a binned triangle's setup data by value, since it moves between frames
+static inline uint64_t plt_triangle_rasteriser_hash_entry(uint64_t hash, const Plt_Triangle_Bin_Entry *entry) {
+	const Plt_Triangle_Bin_Data_Buffer *buffer = entry->buffer;
+	unsigned int index = entry->index;
+	PLT_HASH_VALUE(hash, entry->coverage);
+	PLT_HASH_VALUE(hash, buffer->bc_initial[index]);
+	PLT_HASH_VALUE(hash, buffer->bc_increment_x[index]);
+	PLT_HASH_VALUE(hash, buffer->bc_increment_y[index]);
+	PLT_HASH_VALUE(hash, buffer->depth0[index]);
+	PLT_HASH_VALUE(hash, buffer->depth1[index]);
+	PLT_HASH_VALUE(hash, buffer->depth2[index]);
+	PLT_HASH_VALUE(hash, buffer->uv0[index]);
+	PLT_HASH_VALUE(hash, buffer->uv1[index]);
+	PLT_HASH_VALUE(hash, buffer->uv2[index]);
+	PLT_HASH_VALUE(hash, buffer->mip_level[index]);
+	PLT_HASH_VALUE(hash, buffer->lighting0[index]);
+	PLT_HASH_VALUE(hash, buffer->lighting1[index]);
+	PLT_HASH_VALUE(hash, buffer->lighting2[index]);
+	return hash;
+}
+
+// Hashes every input that affects the tile's pixels, static entries through the hash taken when they were captured
+uint64_t plt_triangle_rasteriser_hash_tile(Plt_Triangle_Rasteriser *rasteriser, unsigned int bin_index, Plt_Color8 clear_color) {
+	uint64_t hash = PLT_TRIANGLE_RASTERISER_HASH_SEED;
+	PLT_HASH_VALUE(hash, clear_color);
+
+	PLT_HASH_VALUE(hash, rasteriser->static_tile_hashes[bin_index]);
+	for (unsigned int i = rasteriser->static_texture_offsets[bin_index]; i < rasteriser->static_texture_offsets[bin_index + 1]; ++i) {
+		PLT_HASH_VALUE(hash, rasteriser->static_textures[i]->revision);
+	}
+
+	Plt_Triangle_Bin *bin = &rasteriser->triangle_bins[bin_index];
+	for (unsigned int i = 0; i < bin->triangle_count; ++i) {
+		hash = plt_triangle_rasteriser_hash_entry(hash, &bin->entries[i]);
+		hash = plt_triangle_rasteriser_hash_texture(hash, bin->entries[i].texture);
+	}
+
+	Plt_Billboard_Bin_Data_Buffer *billboard_buffer = rasteriser->billboard_buffer;
+	if (billboard_buffer) {
+		for (unsigned int j = billboard_buffer->tile_offsets[bin_index]; j < billboard_buffer->tile_offsets[bin_index + 1]; ++j) {
+			unsigned int index = billboard_buffer->tile_billboard_indices[j];
+			PLT_HASH_VALUE(hash, billboard_buffer->screen_x[index]);
+			PLT_HASH_VALUE(hash, billboard_buffer->screen_y[index]);
+			PLT_HASH_VALUE(hash, billboard_buffer->width[index]);
+			PLT_HASH_VALUE(hash, billboard_buffer->height[index]);
+			PLT_HASH_VALUE(hash, billboard_buffer->depth[index]);
+			PLT_HASH_VALUE(hash, billboard_buffer->color[index]);
+			PLT_HASH_VALUE(hash, billboard_buffer->mip_level[index]);
+			PLT_HASH_VALUE(hash, billboard_buffer->texel_step_x[index]);
+			PLT_HASH_VALUE(hash, billboard_buffer->texel_step_y[index]);
+			hash = plt_triangle_rasteriser_hash_texture(hash, billboard_buffer->texture[index]);
+		}
+	}
+
+	for (unsigned int p = 0; p < rasteriser->point_buffer_count; ++p) {
+		Plt_Point_Bin_Data_Buffer *point_buffer = rasteriser->point_buffers[p];
+		PLT_HASH_VALUE(hash, point_buffer->point_size);
+		for (unsigned int j = point_buffer->tile_offsets[bin_index]; j < point_buffer->tile_offsets[bin_index + 1]; ++j) {
+			unsigned int index = point_buffer->tile_point_indices[j];
+			PLT_HASH_VALUE(hash, point_buffer->screen_x[index]);
+			PLT_HASH_VALUE(hash, point_buffer->screen_y[index]);
+			PLT_HASH_VALUE(hash, point_buffer->depth[index]);
+			PLT_HASH_VALUE(hash, point_buffer->color[index]);
+		}
+	}
+
+	return hash;
+}
+
 void *_raster_thread(unsigned int thread_id, void *thread_data) {
 	Plt_Triangle_Rasteriser *rasteriser = thread_data;
 	Plt_Renderer *renderer = rasteriser->renderer;
+	plt_trace_set_thread_name("Raster Worker");
+	uint64_t start_ns = plt_platform_get_time_ns();
 	
 	Plt_Color8 *pixels = rasteriser->framebuffer.pixels;
 	float *depth_buffer = rasteriser->depth_buffer;
 	Plt_Size viewport_size = rasteriser->viewport_size;
 	
-	Plt_Color8 clear_color = renderer->clear_color;
+	Plt_Color8 clear_color = renderer->submitted_commands->clear_color;
+	Plt_Renderer_Debug_View debug_view = rasteriser->debug_view;
 	
-	const Plt_Color8 debug_colors[6] = {
-		plt_color8_make(0, 255, 0, 255),
-		plt_color8_make(0, 0, 255, 255),
-		plt_color8_make(255, 0, 0, 255),
-		plt_color8_make(255, 255, 0, 255),
-		plt_color8_make(255, 0, 255, 255),
-		plt_color8_make(0, 255, 255, 255),
-	};
-	Plt_Color8 debug_color = debug_colors[thread_id % 6];
+	Plt_Triangle_Rasteriser_Thread_Stats stats = { 0 };
+	unsigned char overdraw[PLT_TRIANGLE_BIN_SIZE * PLT_TRIANGLE_BIN_SIZE];
 	
 	unsigned int bin_index;
 	while (plt_thread_safe_stack_pop(rasteriser->triangle_bin_stack, &bin_index)) {
-		Plt_Triangle_Bin bin = rasteriser->triangle_bins[bin_index];
+		Plt_Triangle_Bin *bin = &rasteriser->triangle_bins[bin_index];
+		
+		// Step 0: Skip tiles that would come out the same as last frame, tiles that were painted
+		// over by lines or direct draws need redrawing from scratch
+		uint64_t tile_hash = plt_triangle_rasteriser_hash_tile(rasteriser, bin_index, clear_color);
+		bool forced = rasteriser->tiles_invalidated || rasteriser->tile_overlay[bin_index];
+		rasteriser->tile_dirty[bin_index] = forced || (tile_hash != rasteriser->tile_hashes[bin_index]);
+		if (!rasteriser->tile_dirty[bin_index]) {
+			continue;
+		}
+		rasteriser->tile_hashes[bin_index] = tile_hash;
+		plt_trace_begin("Tile");
+		++stats.tiles_rasterised;
+		uint64_t tile_start_cycles = plt_platform_get_cycle_count();
 		
 		// Render triangle bin
 		Plt_Rect bin_region = plt_rect_make((bin_index % rasteriser->triangle_bin_dimensions.width) * PLT_TRIANGLE_BIN_SIZE, (bin_index / rasteriser->triangle_bin_dimensions.width) * PLT_TRIANGLE_BIN_SIZE, PLT_TRIANGLE_BIN_SIZE, PLT_TRIANGLE_BIN_SIZE);
@@ -169,75 +578,269 @@ void *_raster_thread(unsigned int thread_id, void *thread_data) {
 			}
 		}
 		
-		// Step 2: Rasterise triangles in bin
+		// Step 2: Rasterise triangles in bin, static geometry first
 		{
-			for (unsigned int i = 0; i < bin.triangle_count; ++i) {
-				Plt_Triangle_Bin_Entry entry = bin.entries[i];
-				Plt_Triangle_Bin_Data_Buffer *data_buffer = entry.buffer;
+			const Plt_Triangle_Bin_Entry *static_entries = rasteriser->static_triangle_entries + rasteriser->static_triangle_offsets[bin_index];
+			unsigned int static_count = rasteriser->static_triangle_offsets[bin_index + 1] - rasteriser->static_triangle_offsets[bin_index];
+			
+			if (debug_view == Plt_Renderer_Debug_View_Overdraw) {
+				memset(overdraw, 0, sizeof(overdraw));
+			}
+			
+			Plt_Texture *kernel_texture = NULL;
+			Plt_Triangle_Kernel kernel = NULL;
+			for (unsigned int i = 0; i < static_count + bin->triangle_count; ++i) {
+				Plt_Triangle_Bin_Entry entry = (i < static_count) ? static_entries[i] : bin->entries[i - static_count];
+				if (entry.coverage == Plt_Triangle_Tile_Coverage_Full) {
+					++stats.full_coverage_entries;
+				} else {
+					++stats.partial_coverage_entries;
+				}
+				if (debug_view == Plt_Renderer_Debug_View_Overdraw) {
+					plt_triangle_kernel_overdraw(entry, bin_region, depth_initial, viewport_size.width, overdraw, &stats);
+					continue;
+				}
+				if (entry.texture != kernel_texture) {
+					kernel_texture = entry.texture;
+					kernel = plt_triangle_rasteriser_select_kernel(kernel_texture);
+				}
+				kernel(entry, bin_region, pixel_initial, depth_initial, viewport_size.width, &stats);
+			}
+		}
+		
+		// Step 3: Draw alpha tested billboards in bin, one texture batch at a time
+		if (rasteriser->billboard_buffer) {
+			Plt_Billboard_Bin_Data_Buffer *billboard_buffer = rasteriser->billboard_buffer;
+			unsigned int start = billboard_buffer->tile_offsets[bin_index];
+			unsigned int end = billboard_buffer->tile_offsets[bin_index + 1];
+			
+			const Plt_Texture_Mip_Level *batch_level = NULL;
+			Plt_Size texture_size = { 0, 0 };
+			
+			for (unsigned int j = start; j < end; ++j) {
+				unsigned int index = billboard_buffer->tile_billboard_indices[j];
+				float depth = billboard_buffer->depth[index];
 				
-				bool full_coverage = entry.coverage == Plt_Triangle_Tile_Coverage_Full;
-				debug_color = full_coverage ? plt_color8_make(0, 255, 0, 255) : plt_color8_make(0, 0, 255, 255);
-				if (entry.coverage == Plt_Triangle_Tile_Coverage_None) {
-					debug_color = plt_color8_make(255, 0, 0, 255);
+				Plt_Texture *texture = billboard_buffer->texture[index];
+				const Plt_Texture_Mip_Level *level = texture ? &texture->mip_levels[billboard_buffer->mip_level[index]] : NULL;
+				if (level != batch_level) {
+					batch_level = level;
+					texture_size = level ? level->size : (Plt_Size){ 0, 0 };
 				}
 				
-				Plt_Texture *texture = entry.texture;
-				Plt_Size texture_size = plt_texture_get_size(texture);
-				Plt_Color8 *texture_pixels = plt_texture_get_pixels(texture);
+				// Clip quad to tile
+				int quad_x = billboard_buffer->screen_x[index];
+				int quad_y = billboard_buffer->screen_y[index];
+				int min_x = plt_max(quad_x, bin_region.x);
+				int min_y = plt_max(quad_y, bin_region.y);
+				int max_x = plt_min(quad_x + billboard_buffer->width[index], bin_region.x + PLT_TRIANGLE_BIN_SIZE);
+				int max_y = plt_min(quad_y + billboard_buffer->height[index], bin_region.y + PLT_TRIANGLE_BIN_SIZE);
+				
+				if (!texture) {
+					Plt_Color8 color = billboard_buffer->color[index];
+					if (color.a == 0) {
+						continue;
+					}
+					for (int y = min_y; y < max_y; ++y) {
+						Plt_Color8 *py = pixels + y * viewport_size.width;
+						float *dy = depth_buffer + y * viewport_size.width;
+						for (int x = min_x; x < max_x; ++x) {
+							if (depth > dy[x]) {
+								dy[x] = depth;
+								py[x] = color;
+								++stats.pixels_written;
+							}
+						}
+					}
+					stats.pixels_tested += plt_max(max_x - min_x, 0) * plt_max(max_y - min_y, 0);
+					continue;
+				}
 				
-				simd_int4 bc_initial = data_buffer->bc_initial[entry.index];
-				simd_int4 bc_increment_x = data_buffer->bc_increment_x[entry.index];
-				simd_int4 bc_increment_y = data_buffer->bc_increment_y[entry.index];
-				float triangle_area = data_buffer->triangle_area[entry.index];
+				// Sample texel centres in 16.16 fixed point
+				unsigned int step_x = billboard_buffer->texel_step_x[index];
+				unsigned int step_y = billboard_buffer->texel_step_y[index];
+				unsigned int u_initial = (min_x - quad_x) * step_x + (step_x >> 1);
+				unsigned int v = (min_y - quad_y) * step_y + (step_y >> 1);
 				
-				float depth0 = data_buffer->depth0[entry.index];
-				float depth1 = data_buffer->depth1[entry.index];
-				float depth2 = data_buffer->depth2[entry.index];
+				for (int y = min_y; y < max_y; ++y) {
+					Plt_Color8 *py = pixels + y * viewport_size.width;
+					float *dy = depth_buffer + y * viewport_size.width;
+					unsigned int ty = plt_min(v >> 16, texture_size.height - 1);
+					unsigned int u = u_initial;
+					for (int x = min_x; x < max_x; ++x) {
+						Plt_Color8 c = plt_texture_mip_level_get_texel(batch_level, plt_texture_mip_level_get_index(batch_level, plt_min(u >> 16, texture_size.width - 1), ty));
+						if (c.a > 0) {
+							++stats.pixels_tested;
+							if (depth > dy[x]) {
+								dy[x] = depth;
+								py[x] = c;
+								++stats.pixels_written;
+							}
+						}
+						u += step_x;
+					}
+					v += step_y;
+				}
+			}
+		}
+		
+		// Step 4: Splat points in bin
+		for (unsigned int p = 0; p < rasteriser->point_buffer_count; ++p) {
+			Plt_Point_Bin_Data_Buffer *point_buffer = rasteriser->point_buffers[p];
+			int point_size = point_buffer->point_size;
+			unsigned int start = point_buffer->tile_offsets[bin_index];
+			unsigned int end = point_buffer->tile_offsets[bin_index + 1];
+			
+			for (unsigned int j = start; j < end; ++j) {
+				unsigned int index = point_buffer->tile_point_indices[j];
+				float depth = point_buffer->depth[index];
+				Plt_Color8 color = point_buffer->color[index];
 				
-				Plt_Vector2f uv0 = data_buffer->uv0[entry.index];
-				Plt_Vector2f uv1 = data_buffer->uv1[entry.index];
-				Plt_Vector2f uv2 = data_buffer->uv2[entry.index];
-
-				Plt_Vector3f lighting0 = data_buffer->lighting0[entry.index];
-				Plt_Vector3f lighting1 = data_buffer->lighting1[entry.index];
-				Plt_Vector3f lighting2 = data_buffer->lighting2[entry.index];
+				// Clip splat to tile
+				int min_x = plt_max(point_buffer->screen_x[index], bin_region.x);
+				int min_y = plt_max(point_buffer->screen_y[index], bin_region.y);
+				int max_x = plt_min(point_buffer->screen_x[index] + point_size, bin_region.x + PLT_TRIANGLE_BIN_SIZE);
+				int max_y = plt_min(point_buffer->screen_y[index] + point_size, bin_region.y + PLT_TRIANGLE_BIN_SIZE);
 				
-				simd_int4 bc_y = simd_int4_add(simd_int4_add(bc_initial, simd_int4_multiply(bc_increment_y, simd_int4_create_scalar(bin_region.y))), simd_int4_multiply(bc_increment_x, simd_int4_create_scalar(bin_region.x)));
+				for (int y = min_y; y < max_y; ++y) {
+					Plt_Color8 *py = pixels + y * viewport_size.width;
+					float *dy = depth_buffer + y * viewport_size.width;
+					for (int x = min_x; x < max_x; ++x) {
+						if (depth > dy[x]) {
+							dy[x] = depth;
+							py[x] = color;
+							++stats.pixels_written;
+						}
+					}
+				}
+				stats.pixels_tested += plt_max(max_x - min_x, 0) * plt_max(max_y - min_y, 0);
+			}
+		}
+		
+		// Step 5: Debug views, tile views are tinted once every tile's value is known
+		switch (debug_view) {
+			case Plt_Renderer_Debug_View_None:
+				break;
+				
+			case Plt_Renderer_Debug_View_Overdraw: {
 				Plt_Color8 *py = pixel_initial;
-				float *dy = depth_initial;
 				for (unsigned int y = 0; y < PLT_TRIANGLE_BIN_SIZE; ++y) {
-					simd_int4 bc_x = bc_y;
-					#if PLT_TRIANGLE_BIN_SIZE != 16
-					#error Unwrapped clear needs to be updated for new triangle size
-					#endif
-					PAINT_PIXEL(0)  PAINT_PIXEL(1)
-					PAINT_PIXEL(2)  PAINT_PIXEL(3)
-					PAINT_PIXEL(4)  PAINT_PIXEL(5)
-					PAINT_PIXEL(6)  PAINT_PIXEL(7)
-					PAINT_PIXEL(8)  PAINT_PIXEL(9)
-					PAINT_PIXEL(10) PAINT_PIXEL(11)
-					PAINT_PIXEL(12) PAINT_PIXEL(13)
-					PAINT_PIXEL(14) PAINT_PIXEL(15)
+					for (unsigned int x = 0; x < PLT_TRIANGLE_BIN_SIZE; ++x) {
+						unsigned int count = overdraw[y * PLT_TRIANGLE_BIN_SIZE + x];
+						py[x] = count ? plt_triangle_rasteriser_heat_color((count - 1) / (float)(PLT_DEBUG_VIEW_MAX_OVERDRAW - 1)) : plt_color8_make(0, 0, 0, 255);
+					}
 					py += viewport_size.width;
-					dy += viewport_size.width;
-					bc_y = simd_int4_add(bc_y, bc_increment_y);
 				}
-			}
+			} break;
+				
+			case Plt_Renderer_Debug_View_Tile_Triangle_Count:
+				rasteriser->tile_debug_values[bin_index] = bin->triangle_count + rasteriser->static_triangle_offsets[bin_index + 1] - rasteriser->static_triangle_offsets[bin_index];
+				break;
+				
+			case Plt_Renderer_Debug_View_Tile_Time:
+				rasteriser->tile_debug_values[bin_index] = plt_platform_get_cycle_count() - tile_start_cycles;
+				break;
+				
+			case Plt_Renderer_Debug_View_Worker:
+				rasteriser->tile_debug_values[bin_index] = thread_id;
+				break;
+				
+			default:
+				break;
 		}
-		
+		plt_trace_end("Tile");
 	}
+	
+	stats.busy_ns = plt_platform_get_time_ns() - start_ns;
+	rasteriser->thread_stats[thread_id] = stats;
 	return NULL;
 }
 
+// Blends a colour for each tile's debug value over the tile, values are scaled against the largest
+void plt_triangle_rasteriser_tint_debug_view_tiles(Plt_Triangle_Rasteriser *rasteriser) {
+	Plt_Renderer_Debug_View debug_view = rasteriser->debug_view;
+	if ((debug_view == Plt_Renderer_Debug_View_None) || (debug_view == Plt_Renderer_Debug_View_Overdraw)) {
+		return;
+	}
+	
+	const Plt_Color8 worker_colors[6] = {
+		plt_color8_make(0, 255, 0, 160),
+		plt_color8_make(0, 0, 255, 160),
+		plt_color8_make(255, 0, 0, 160),
+		plt_color8_make(255, 255, 0, 160),
+		plt_color8_make(255, 0, 255, 160),
+		plt_color8_make(0, 255, 255, 160),
+	};
+	
+	uint64_t max_value = 1;
+	for (unsigned int i = 0; i < rasteriser->triangle_bin_count; ++i) {
+		max_value = plt_max(max_value, rasteriser->tile_debug_values[i]);
+	}
+	
+	Plt_Size viewport_size = rasteriser->viewport_size;
+	for (unsigned int i = 0; i < rasteriser->triangle_bin_count; ++i) {
+		Plt_Color8 tint;
+		if (debug_view == Plt_Renderer_Debug_View_Worker) {
+			tint = worker_colors[rasteriser->tile_debug_values[i] % 6];
+		} else {
+			tint = plt_triangle_rasteriser_heat_color(rasteriser->tile_debug_values[i] / (float)max_value);
+			tint.a = 160;
+		}
+		
+		unsigned int tile_x = (i % rasteriser->triangle_bin_dimensions.width) * PLT_TRIANGLE_BIN_SIZE;
+		unsigned int tile_y = (i / rasteriser->triangle_bin_dimensions.width) * PLT_TRIANGLE_BIN_SIZE;
+		Plt_Color8 *py = rasteriser->framebuffer.pixels + tile_y * viewport_size.width + tile_x;
+		for (unsigned int y = 0; y < PLT_TRIANGLE_BIN_SIZE; ++y) {
+			for (unsigned int x = 0; x < PLT_TRIANGLE_BIN_SIZE; ++x) {
+				py[x] = plt_color8_blend(py[x], tint);
+			}
+			py += viewport_size.width;
+		}
+	}
+}
+
 void plt_triangle_rasteriser_render_triangles(Plt_Triangle_Rasteriser *rasteriser) {	
+	Plt_Renderer_Stats *stats = &rasteriser->renderer->stats;
+	
+	// Debug views draw every tile, and leave pixels behind that have to be redrawn once they're switched off
+	Plt_Renderer_Debug_View debug_view = rasteriser->renderer->submitted_commands->debug_view;
+	if ((debug_view != Plt_Renderer_Debug_View_None) || (debug_view != rasteriser->debug_view)) {
+		rasteriser->tiles_invalidated = true;
+	}
+	rasteriser->debug_view = debug_view;
+	
 	// Add all bins to be processed
+	unsigned int entry_count = 0;
 	rasteriser->triangle_bin_stack->count = 0;
 	for (unsigned int i = 0; i < rasteriser->triangle_bin_count; ++i) {
 		plt_thread_safe_stack_push(rasteriser->triangle_bin_stack, i);
+		
+		unsigned int bin_entry_count = rasteriser->triangle_bins[i].triangle_count + rasteriser->static_triangle_offsets[i + 1] - rasteriser->static_triangle_offsets[i];
+		stats->max_bin_entries = plt_max(stats->max_bin_entries, bin_entry_count);
+		entry_count += bin_entry_count;
 	}
+	stats->tile_count = rasteriser->triangle_bin_count;
+	stats->mean_bin_entries = (rasteriser->triangle_bin_count > 0) ? entry_count / (float)rasteriser->triangle_bin_count : 0.0f;
 	
+	memset(rasteriser->thread_stats, 0, sizeof(Plt_Triangle_Rasteriser_Thread_Stats) * rasteriser->thread_count);
 	plt_thread_pool_signal_data_ready(rasteriser->thread_pool);
 	plt_thread_pool_wait_until_complete(rasteriser->thread_pool);
+	rasteriser->tiles_invalidated = false;
+	
+	for (unsigned int i = 0; i < rasteriser->thread_count; ++i) {
+		Plt_Triangle_Rasteriser_Thread_Stats *thread_stats = &rasteriser->thread_stats[i];
+		stats->tiles_rasterised += thread_stats->tiles_rasterised;
+		stats->full_coverage_entries += thread_stats->full_coverage_entries;
+		stats->partial_coverage_entries += thread_stats->partial_coverage_entries;
+		stats->pixels_tested += thread_stats->pixels_tested;
+		stats->pixels_written += thread_stats->pixels_written;
+		if (i < PLT_RENDERER_STATS_MAX_WORKERS) {
+			stats->worker_busy_ms[i] = thread_stats->busy_ns / 1000000.0f;
+		}
+	}
+	stats->worker_count = plt_min(rasteriser->thread_count, PLT_RENDERER_STATS_MAX_WORKERS);
+	
+	plt_triangle_rasteriser_tint_debug_view_tiles(rasteriser);
 }
 
 Plt_Size plt_rasteriser_get_triangle_bin_dimensions(Plt_Triangle_Rasteriser *rasteriser) {
@@ -250,9 +853,157 @@ Plt_Triangle_Bin *plt_rasteriser_get_triangle_bin(Plt_Triangle_Rasteriser *raste
 	return &rasteriser->triangle_bins[position.y * rasteriser->triangle_bin_dimensions.width + position.x];
 }
 
+void plt_rasteriser_add_point_buffer(Plt_Triangle_Rasteriser *rasteriser, Plt_Linear_Allocator *allocator, Plt_Point_Bin_Data_Buffer *buffer) {
+	if (rasteriser->point_buffer_count == rasteriser->point_buffer_capacity) {
+		unsigned int capacity = plt_max(rasteriser->point_buffer_capacity * 2, PLT_POINT_BIN_INITIAL_BUFFER_CAPACITY);
+		Plt_Point_Bin_Data_Buffer **point_buffers = plt_linear_allocator_alloc(allocator, sizeof(Plt_Point_Bin_Data_Buffer *) * capacity);
+		if (rasteriser->point_buffer_count > 0) {
+			memcpy(point_buffers, rasteriser->point_buffers, sizeof(Plt_Point_Bin_Data_Buffer *) * rasteriser->point_buffer_count);
+		}
+		rasteriser->point_buffers = point_buffers;
+		rasteriser->point_buffer_capacity = capacity;
+	}
+	rasteriser->point_buffers[rasteriser->point_buffer_count++] = buffer;
+}
+
+void plt_rasteriser_set_billboard_buffer(Plt_Triangle_Rasteriser *rasteriser, Plt_Billboard_Bin_Data_Buffer *buffer) {
+	rasteriser->billboard_buffer = buffer;
+}
+
 void plt_rasteriser_clear_triangle_bins(Plt_Triangle_Rasteriser *rasteriser) {
 	rasteriser->triangle_bin_stack->count = 0;
+	rasteriser->point_buffer_count = 0;
+	rasteriser->point_buffer_capacity = 0;
+	rasteriser->point_buffers = NULL;
+	rasteriser->billboard_buffer = NULL;
 	for (unsigned int i = 0; i < rasteriser->triangle_bin_count; ++i) {
 		rasteriser->triangle_bins[i].triangle_count = 0;
+		
+		// A new frame starts, last frame's overlays have to be drawn over
+		rasteriser->tile_overlay[i] = (rasteriser->tile_overlay[i] & PLT_TILE_OVERLAY_CURRENT_FRAME) ? PLT_TILE_OVERLAY_PREVIOUS_FRAME : 0;
+	}
+}
+
+void plt_rasteriser_capture_static_triangle_bins(Plt_Triangle_Rasteriser *rasteriser) {
+	unsigned int total = 0;
+	for (unsigned int i = 0; i < rasteriser->triangle_bin_count; ++i) {
+		total += rasteriser->triangle_bins[i].triangle_count;
+	}
+	
+	if (rasteriser->static_triangle_capacity < total) {
+		if (rasteriser->static_triangle_entries) {
+			free(rasteriser->static_triangle_entries);
+			free(rasteriser->static_textures);
+		}
+		rasteriser->static_triangle_entries = malloc(sizeof(Plt_Triangle_Bin_Entry) * total);
+		rasteriser->static_textures = malloc(sizeof(Plt_Texture *) * total);
+		plt_assert(rasteriser->static_triangle_entries && rasteriser->static_textures, "Failed allocating static triangle bins.\n");
+		rasteriser->static_triangle_capacity = total;
+	}
+	
+	unsigned int offset = 0;
+	unsigned int texture_offset = 0;
+	for (unsigned int i = 0; i < rasteriser->triangle_bin_count; ++i) {
+		Plt_Triangle_Bin *bin = &rasteriser->triangle_bins[i];
+		rasteriser->static_triangle_offsets[i] = offset;
+		rasteriser->static_texture_offsets[i] = texture_offset;
+		
+		// Entries are binned in draw order, so runs of one texture only list it once
+		uint64_t hash = PLT_TRIANGLE_RASTERISER_HASH_SEED;
+		for (unsigned int j = 0; j < bin->triangle_count; ++j) {
+			Plt_Triangle_Bin_Entry *entry = &bin->entries[j];
+			hash = plt_triangle_rasteriser_hash_entry(hash, entry);
+			PLT_HASH_VALUE(hash, entry->texture);
+			
+			bool listed = (texture_offset > rasteriser->static_texture_offsets[i]) && (rasteriser->static_textures[texture_offset - 1] == entry->texture);
+			if (entry->texture && !listed) {
+				rasteriser->static_textures[texture_offset++] = entry->texture;
+			}
+		}
+		rasteriser->static_tile_hashes[i] = hash;
+		
+		if (bin->triangle_count > 0) {
+			memcpy(rasteriser->static_triangle_entries + offset, bin->entries, sizeof(Plt_Triangle_Bin_Entry) * bin->triangle_count);
+			offset += bin->triangle_count;
+		}
+		bin->triangle_count = 0;
 	}
+	rasteriser->static_triangle_offsets[rasteriser->triangle_bin_count] = offset;
+	rasteriser->static_texture_offsets[rasteriser->triangle_bin_count] = texture_offset;
+}
+
+void plt_rasteriser_invalidate_tiles(Plt_Triangle_Rasteriser *rasteriser) {
+	rasteriser->tiles_invalidated = true;
+}
+
+void plt_rasteriser_mark_overlay(Plt_Triangle_Rasteriser *rasteriser, Plt_Rect rect) {
+	Plt_Size dimensions = rasteriser->triangle_bin_dimensions;
+	if ((dimensions.width == 0) || (dimensions.height == 0) || (rect.width <= 0) || (rect.height <= 0)) {
+		return;
+	}
+	
+	// Pixels right of or below the last whole tile belong to it
+	int min_x = plt_clamp(rect.x / PLT_TRIANGLE_BIN_SIZE, 0, dimensions.width - 1);
+	int min_y = plt_clamp(rect.y / PLT_TRIANGLE_BIN_SIZE, 0, dimensions.height - 1);
+	int max_x = plt_clamp((rect.x + rect.width - 1) / PLT_TRIANGLE_BIN_SIZE, 0, dimensions.width - 1);
+	int max_y = plt_clamp((rect.y + rect.height - 1) / PLT_TRIANGLE_BIN_SIZE, 0, dimensions.height - 1);
+	for (int y = min_y; y <= max_y; ++y) {
+		for (int x = min_x; x <= max_x; ++x) {
+			rasteriser->tile_overlay[y * dimensions.width + x] |= PLT_TILE_OVERLAY_CURRENT_FRAME;
+		}
+	}
+}
+
+unsigned int plt_rasteriser_get_dirty_rects(Plt_Triangle_Rasteriser *rasteriser, Plt_Rect *rects, unsigned int max_rects) {
+	Plt_Size dimensions = rasteriser->triangle_bin_dimensions;
+	Plt_Size viewport_size = rasteriser->viewport_size;
+	Plt_Rect full_rect = plt_rect_make(0, 0, viewport_size.width, viewport_size.height);
+	if ((dimensions.width == 0) || (dimensions.height == 0) || (max_rects == 0)) {
+		rects[0] = full_rect;
+		return 1;
+	}
+	
+	// Runs of dirty tiles along each row, merged into an identical run ending directly above
+	unsigned int rect_count = 0;
+	for (unsigned int ty = 0; ty < dimensions.height; ++ty) {
+		unsigned int row_start = rect_count;
+		int y = ty * PLT_TRIANGLE_BIN_SIZE;
+		int height = (ty == dimensions.height - 1) ? viewport_size.height - y : PLT_TRIANGLE_BIN_SIZE;
+		
+		unsigned int tx = 0;
+		while (tx < dimensions.width) {
+			unsigned int i = ty * dimensions.width + tx;
+			if (!rasteriser->tile_dirty[i] && !(rasteriser->tile_overlay[i] & PLT_TILE_OVERLAY_CURRENT_FRAME)) {
+				++tx;
+				continue;
+			}
+			
+			unsigned int run_start = tx;
+			while ((tx < dimensions.width) && (rasteriser->tile_dirty[ty * dimensions.width + tx] || (rasteriser->tile_overlay[ty * dimensions.width + tx] & PLT_TILE_OVERLAY_CURRENT_FRAME))) {
+				++tx;
+			}
+			
+			int x = run_start * PLT_TRIANGLE_BIN_SIZE;
+			int width = (tx == dimensions.width) ? viewport_size.width - x : (tx - run_start) * PLT_TRIANGLE_BIN_SIZE;
+			
+			bool merged = false;
+			for (unsigned int r = 0; r < row_start; ++r) {
+				if ((rects[r].x == x) && (rects[r].width == width) && (rects[r].y + rects[r].height == y)) {
+					rects[r].height += height;
+					merged = true;
+					break;
+				}
+			}
+			
+			if (!merged) {
+				if (rect_count == max_rects) {
+					rects[0] = full_rect;
+					return 1;
+				}
+				rects[rect_count++] = plt_rect_make(x, y, width, height);
+			}
+		}
+	}
+	
+	return rect_count;
 }
@@ -9,6 +9,10 @@ typedef struct Plt_Triangle_Rasteriser Plt_Triangle_Rasteriser;
 Plt_Triangle_Rasteriser *plt_triangle_rasteriser_create(Plt_Renderer *renderer, Plt_Size viewport_size);
 void plt_triangle_rasteriser_destroy(Plt_Triangle_Rasteriser **rasteriser);
 
+// Tiles are shared out between this many threads, 0 uses one per core
+void plt_triangle_rasteriser_set_thread_count(Plt_Triangle_Rasteriser *rasteriser, unsigned int thread_count);
+unsigned int plt_triangle_rasteriser_get_thread_count(Plt_Triangle_Rasteriser *rasteriser);
+
 void plt_triangle_rasteriser_update_framebuffer(Plt_Triangle_Rasteriser *rasteriser, Plt_Framebuffer framebuffer);
 void plt_triangle_rasteriser_update_depth_buffer(Plt_Triangle_Rasteriser *rasteriser, float *depth_buffer);
 
@@ -18,3 +22,23 @@ typedef struct Plt_Triangle_Bin Plt_Triangle_Bin;
 Plt_Size plt_rasteriser_get_triangle_bin_dimensions(Plt_Triangle_Rasteriser *rasteriser);
 Plt_Triangle_Bin *plt_rasteriser_get_triangle_bin(Plt_Triangle_Rasteriser *rasteriser, Plt_Vector2i position);
 void plt_rasteriser_clear_triangle_bins(Plt_Triangle_Rasteriser *rasteriser);
+
+// Moves every binned triangle into the static bins, replacing their previous contents.
+// Static bins are rasterised before the regular bins each frame until captured again.
+void plt_rasteriser_capture_static_triangle_bins(Plt_Triangle_Rasteriser *rasteriser);
+
+// Tiles are only redrawn when what's binned into them changes. Anything painted straight into the
+// framebuffer has to mark the area it covers so those tiles are redrawn clean next frame.
+void plt_rasteriser_invalidate_tiles(Plt_Triangle_Rasteriser *rasteriser);
+void plt_rasteriser_mark_overlay(Plt_Triangle_Rasteriser *rasteriser, Plt_Rect rect);
+
+// Regions of the framebuffer that changed this frame, a single full rect if they don't fit in max_rects
+unsigned int plt_rasteriser_get_dirty_rects(Plt_Triangle_Rasteriser *rasteriser, Plt_Rect *rects, unsigned int max_rects);
+
+// Buffers and the list holding them come from the frame allocator, they're dropped when the bins are cleared
+typedef struct Plt_Point_Bin_Data_Buffer Plt_Point_Bin_Data_Buffer;
+typedef struct Plt_Linear_Allocator Plt_Linear_Allocator;
+void plt_rasteriser_add_point_buffer(Plt_Triangle_Rasteriser *rasteriser, Plt_Linear_Allocator *allocator, Plt_Point_Bin_Data_Buffer *buffer);
+
+typedef struct Plt_Billboard_Bin_Data_Buffer Plt_Billboard_Bin_Data_Buffer;
+void plt_rasteriser_set_billboard_buffer(Plt_Triangle_Rasteriser *rasteriser, Plt_Billboard_Bin_Data_Buffer *buffer);
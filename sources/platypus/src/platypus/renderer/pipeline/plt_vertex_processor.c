@@ -1,199 +1,384 @@
 #include "plt_vertex_processor.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include "platypus/mesh/plt_mesh.h"
-#include "platypus/base/allocation/plt_linear_allocator.h"
+#include "platypus/base/plt_macros.h"
+#include "platypus/base/plt_platform.h"
+#include "platypus/base/plt_simd.h"
 
-typedef struct Plt_Vertex_Processor_Working_Buffer {
-	unsigned int vertex_capacity;
+// Number of (mesh, model, lighting) combinations kept between frames
+#define PLT_VERTEX_CACHE_SIZE 32
+
+// clipspace xyzw, screen xy, uv xy, world normal xyz, lighting rgb
+#define PLT_VERTEX_CACHE_STREAM_COUNT 14
+
+// Outputs for one draw, kept alive across frames so unchanged draws can skip the vertex stage
+typedef struct Plt_Vertex_Cache_Entry {
+	Plt_Mesh *mesh;
+	unsigned int mesh_revision;
+	unsigned int last_used;
+	unsigned int last_used_frame;
 
-	float *clipspace_x;
-	float *clipspace_y;
-	float *clipspace_z;
-	float *clipspace_w;
+	// Clipspace and screen positions depend on these
+	bool positions_valid;
+	Plt_Matrix4x4f mvp;
+	Plt_Vector2i viewport;
 
-	int *screen_positions_x;
-	int *screen_positions_y;
+	// World normals and lighting depend on these, so survive camera movement
+	bool lighting_valid;
+	Plt_Matrix4x4f model;
+	Plt_Lighting_Model lighting_model;
+	Plt_Lighting_Setup lighting_setup;
 
-	float *world_normals_x;
-	float *world_normals_y;
-	float *world_normals_z;
-} Plt_Vertex_Processor_Working_Buffer;
+	unsigned int vertex_capacity;
+	void *stream_data;
+	Plt_Vertex_Processor_Result result;
+} Plt_Vertex_Cache_Entry;
 
 typedef struct Plt_Vertex_Processor {
-	Plt_Vertex_Processor_Working_Buffer working_buffer;
+	unsigned int use_counter;
+	unsigned int frame_index;
+	Plt_Vertex_Cache_Entry cache[PLT_VERTEX_CACHE_SIZE];
 } Plt_Vertex_Processor;
 
-void plt_vertex_processor_free_working_buffer(Plt_Vertex_Processor *processor);
-
 Plt_Vertex_Processor *plt_vertex_processor_create() {
 	Plt_Vertex_Processor *processor = malloc(sizeof(Plt_Vertex_Processor));
 
-	processor->working_buffer = (Plt_Vertex_Processor_Working_Buffer){
-		.vertex_capacity = 0,
-		.clipspace_x = NULL,
-		.clipspace_y = NULL,
-		.clipspace_z = NULL,
-		.clipspace_w = NULL,
-		.screen_positions_x = NULL,
-		.screen_positions_y = NULL,
-		.world_normals_x = NULL,
-		.world_normals_y = NULL,
-		.world_normals_z = NULL
-	};
+	processor->use_counter = 0;
+	processor->frame_index = 0;
+	for (unsigned int i = 0; i < PLT_VERTEX_CACHE_SIZE; ++i) {
+		processor->cache[i] = (Plt_Vertex_Cache_Entry) {
+			.mesh = NULL,
+			.last_used = 0,
+			.last_used_frame = 0,
+			.positions_valid = false,
+			.lighting_valid = false,
+			.vertex_capacity = 0,
+			.stream_data = NULL
+		};
+	}
 
 	return processor;
 }
 
 void plt_vertex_processor_destroy(Plt_Vertex_Processor **processor) {
-	plt_vertex_processor_free_working_buffer(*processor);
+	for (unsigned int i = 0; i < PLT_VERTEX_CACHE_SIZE; ++i) {
+		if ((*processor)->cache[i].stream_data) {
+			plt_platform_aligned_free((*processor)->cache[i].stream_data);
+		}
+	}
+
 	free(*processor);
 	*processor = NULL;
 }
 
-void plt_vertex_processor_free_working_buffer(Plt_Vertex_Processor *processor) {
-	if (processor->working_buffer.vertex_capacity == 0) {
-		// Nothing to free.
-		return;
+void plt_vertex_processor_begin_frame(Plt_Vertex_Processor *processor) {
+	++processor->frame_index;
+}
+
+// Only the lights in use take part in the comparison
+static bool plt_vertex_processor_lighting_setup_equal(Plt_Lighting_Setup a, Plt_Lighting_Setup b) {
+	if ((a.directional_light_count != b.directional_light_count) || (memcmp(&a.ambient_lighting, &b.ambient_lighting, sizeof(Plt_Vector3f)) != 0)) {
+		return false;
 	}
-	free(processor->working_buffer.clipspace_x);
-	free(processor->working_buffer.clipspace_y);
-	free(processor->working_buffer.clipspace_z);
-	free(processor->working_buffer.clipspace_w);
-	free(processor->working_buffer.screen_positions_x);
-	free(processor->working_buffer.screen_positions_y);
-	free(processor->working_buffer.world_normals_x);
-	free(processor->working_buffer.world_normals_y);
-	free(processor->working_buffer.world_normals_z);
-	processor->working_buffer.clipspace_x = NULL;
-	processor->working_buffer.clipspace_y = NULL;
-	processor->working_buffer.clipspace_z = NULL;
-	processor->working_buffer.screen_positions_x = NULL;
-	processor->working_buffer.screen_positions_y = NULL;
-	processor->working_buffer.world_normals_x = NULL;
-	processor->working_buffer.world_normals_y = NULL;
-	processor->working_buffer.world_normals_z = NULL;
+
+	size_t size = sizeof(Plt_Vector3f) * a.directional_light_count;
+	return (memcmp(a.directional_light_directions, b.directional_light_directions, size) == 0) && (memcmp(a.directional_light_amounts, b.directional_light_amounts, size) == 0);
 }
 
-void plt_vertex_processor_resize_working_buffer(Plt_Vertex_Processor *processor, unsigned int capacity) {
-	if (processor->working_buffer.vertex_capacity == capacity) {
-		return;
+static bool plt_vertex_processor_entry_lighting_matches(const Plt_Vertex_Cache_Entry *entry, Plt_Lighting_Model lighting_model, Plt_Lighting_Setup lighting_setup, Plt_Matrix4x4f model) {
+	if (!entry->lighting_valid || (entry->lighting_model != lighting_model)) {
+		return false;
+	}
+
+	// Unlit draws don't read the model matrix or lights
+	if (lighting_model == Plt_Lighting_Model_Unlit) {
+		return true;
 	}
 
-	if (processor->working_buffer.vertex_capacity > 0) {
-		free(processor->working_buffer.clipspace_x);
-		free(processor->working_buffer.clipspace_y);
-		free(processor->working_buffer.clipspace_z);
-		free(processor->working_buffer.clipspace_w);
-		free(processor->working_buffer.screen_positions_x);
-		free(processor->working_buffer.screen_positions_y);
-		free(processor->working_buffer.world_normals_x);
-		free(processor->working_buffer.world_normals_y);
-		free(processor->working_buffer.world_normals_z);
-	}
-
-	if (capacity > 0) {
-		processor->working_buffer.clipspace_x = malloc(sizeof(float) * capacity);
-		processor->working_buffer.clipspace_y = malloc(sizeof(float) * capacity);
-		processor->working_buffer.clipspace_z = malloc(sizeof(float) * capacity);
-		processor->working_buffer.clipspace_w = malloc(sizeof(float) * capacity);
-		processor->working_buffer.screen_positions_x = malloc(sizeof(int) * capacity);
-		processor->working_buffer.screen_positions_y = malloc(sizeof(int) * capacity);
-		processor->working_buffer.world_normals_x = malloc(sizeof(float) * capacity);
-		processor->working_buffer.world_normals_y = malloc(sizeof(float) * capacity);
-		processor->working_buffer.world_normals_z = malloc(sizeof(float) * capacity);
-	} else {
-		processor->working_buffer.clipspace_x = NULL;
-		processor->working_buffer.clipspace_y = NULL;
-		processor->working_buffer.clipspace_z = NULL;
-		processor->working_buffer.clipspace_w = NULL;
-		processor->working_buffer.screen_positions_x = NULL;
-		processor->working_buffer.screen_positions_y = NULL;
-		processor->working_buffer.world_normals_x = NULL;
-		processor->working_buffer.world_normals_y = NULL;
-		processor->working_buffer.world_normals_z = NULL;
-	}
-
-	processor->working_buffer.vertex_capacity = capacity;
+	return (memcmp(&entry->model, &model, sizeof(Plt_Matrix4x4f)) == 0) && plt_vertex_processor_lighting_setup_equal(entry->lighting_setup, lighting_setup);
 }
 
-Plt_Vertex_Processor_Result plt_vertex_processor_process_mesh(Plt_Vertex_Processor *processor, Plt_Linear_Allocator *allocator, Plt_Lighting_Setup lighting_setup, Plt_Mesh *mesh, Plt_Vector2i viewport, Plt_Matrix4x4f model, Plt_Matrix4x4f mvp) {
-	unsigned int vertex_count = mesh->vertex_count;
+static bool plt_vertex_processor_entry_positions_match(const Plt_Vertex_Cache_Entry *entry, Plt_Vector2i viewport, Plt_Matrix4x4f mvp) {
+	return entry->positions_valid && (entry->viewport.x == viewport.x) && (entry->viewport.y == viewport.y) && (memcmp(&entry->mvp, &mvp, sizeof(Plt_Matrix4x4f)) == 0);
+}
 
-	if (processor->working_buffer.vertex_capacity < vertex_count) {
-		plt_vertex_processor_resize_working_buffer(processor, vertex_count);
+// Hands the least recently used entry over to the given mesh
+static Plt_Vertex_Cache_Entry *plt_vertex_processor_evict_entry(Plt_Vertex_Processor *processor, Plt_Mesh *mesh) {
+	Plt_Vertex_Cache_Entry *entry = &processor->cache[0];
+	for (unsigned int i = 1; i < PLT_VERTEX_CACHE_SIZE; ++i) {
+		if (processor->cache[i].last_used < entry->last_used) {
+			entry = &processor->cache[i];
+		}
+	}
+
+	unsigned int padded_vertex_count = mesh->padded_vertex_count;
+	if (entry->vertex_capacity < padded_vertex_count) {
+		if (entry->stream_data) {
+			plt_platform_aligned_free(entry->stream_data);
+		}
+		size_t size = plt_max(sizeof(float) * padded_vertex_count * PLT_VERTEX_CACHE_STREAM_COUNT, (size_t)PLT_MESH_STREAM_ALIGNMENT);
+		entry->stream_data = plt_platform_aligned_alloc(size, PLT_MESH_STREAM_ALIGNMENT);
+		plt_assert(entry->stream_data, "Failed allocating vertex cache streams.\n");
+		entry->vertex_capacity = padded_vertex_count;
 	}
 
+	float *streams = entry->stream_data;
+	unsigned int stride = entry->vertex_capacity;
+	entry->result = (Plt_Vertex_Processor_Result) {
+		.vertex_count = mesh->vertex_count,
+		.clipspace_x = streams + stride * 0,
+		.clipspace_y = streams + stride * 1,
+		.clipspace_z = streams + stride * 2,
+		.clipspace_w = streams + stride * 3,
+		.screen_positions_x = (int *)(streams + stride * 4),
+		.screen_positions_y = (int *)(streams + stride * 5),
+		.model_uvs_x = mesh->uv_x,
+		.model_uvs_y = mesh->uv_y,
+		.world_normals_x = NULL,
+		.world_normals_y = NULL,
+		.world_normals_z = NULL,
+		.lighting_r = streams + stride * 11,
+		.lighting_g = streams + stride * 12,
+		.lighting_b = streams + stride * 13
+	};
+
+	entry->mesh = mesh;
+	entry->mesh_revision = mesh->revision;
+	entry->positions_valid = false;
+	entry->lighting_valid = false;
+
+	// Quantised meshes decode their UVs once, they only change with the mesh
+	if (mesh->quantised) {
+		entry->result.model_uvs_x = streams + stride * 6;
+		entry->result.model_uvs_y = streams + stride * 7;
+
+		const simd_float4 uv_scale_x = simd_float4_create_scalar(mesh->uv_scale.x);
+		const simd_float4 uv_scale_y = simd_float4_create_scalar(mesh->uv_scale.y);
+		const simd_float4 uv_offset_x = simd_float4_create_scalar(mesh->uv_offset.x);
+		const simd_float4 uv_offset_y = simd_float4_create_scalar(mesh->uv_offset.y);
+		for (unsigned int i = 0; i < (unsigned int)mesh->vertex_count; i += 4) {
+			simd_float4_store(entry->result.model_uvs_x + i, simd_float4_multiply_add(uv_offset_x, simd_float4_from_int4(simd_int4_load_u16(mesh->quantised_uv_x + i)), uv_scale_x));
+			simd_float4_store(entry->result.model_uvs_y + i, simd_float4_multiply_add(uv_offset_y, simd_float4_from_int4(simd_int4_load_u16(mesh->quantised_uv_y + i)), uv_scale_y));
+		}
+	}
+
+	return entry;
+}
+
+static void plt_vertex_processor_transform_positions(Plt_Vertex_Cache_Entry *entry, Plt_Vector2i viewport, Plt_Matrix4x4f mvp) {
+	Plt_Mesh *mesh = entry->mesh;
+	unsigned int vertex_count = mesh->vertex_count;
+	bool quantised = mesh->quantised;
+
 	// Input
 	float *model_positions_x = mesh->position_x;
 	float *model_positions_y = mesh->position_y;
 	float *model_positions_z = mesh->position_z;
-	float *model_uvs_x = mesh->uv_x;
-	float *model_uvs_y = mesh->uv_y;
+
+	// Output, padded like the mesh streams so every iteration stores whole vectors
+	float *clipspace_x = entry->result.clipspace_x;
+	float *clipspace_y = entry->result.clipspace_y;
+	float *clipspace_z = entry->result.clipspace_z;
+	float *clipspace_w = entry->result.clipspace_w;
+	int *screen_positions_x = entry->result.screen_positions_x;
+	int *screen_positions_y = entry->result.screen_positions_y;
+
+	// Broadcast matrix columns
+	simd_float4 m[4][4];
+	for (unsigned int c = 0; c < 4; ++c) {
+		for (unsigned int r = 0; r < 4; ++r) {
+			m[c][r] = simd_float4_create_scalar(mvp.columns[c][r]);
+		}
+	}
+
+	const simd_float4 half = simd_float4_create_scalar(0.5f);
+	const simd_float4 viewport_x = simd_float4_create_scalar(viewport.x);
+	const simd_float4 viewport_y = simd_float4_create_scalar(viewport.y);
+
+	// Quantised attribute decoding
+	const simd_float4 position_scale_x = simd_float4_create_scalar(mesh->position_scale.x);
+	const simd_float4 position_scale_y = simd_float4_create_scalar(mesh->position_scale.y);
+	const simd_float4 position_scale_z = simd_float4_create_scalar(mesh->position_scale.z);
+	const simd_float4 position_offset_x = simd_float4_create_scalar(mesh->position_offset.x);
+	const simd_float4 position_offset_y = simd_float4_create_scalar(mesh->position_offset.y);
+	const simd_float4 position_offset_z = simd_float4_create_scalar(mesh->position_offset.z);
+
+	for (unsigned int i = 0; i < vertex_count; i += 4) {
+		simd_float4 x, y, z;
+		if (quantised) {
+			x = simd_float4_multiply_add(position_offset_x, simd_float4_from_int4(simd_int4_load_u16(mesh->quantised_position_x + i)), position_scale_x);
+			y = simd_float4_multiply_add(position_offset_y, simd_float4_from_int4(simd_int4_load_u16(mesh->quantised_position_y + i)), position_scale_y);
+			z = simd_float4_multiply_add(position_offset_z, simd_float4_from_int4(simd_int4_load_u16(mesh->quantised_position_z + i)), position_scale_z);
+		} else {
+			x = simd_float4_load(model_positions_x + i);
+			y = simd_float4_load(model_positions_y + i);
+			z = simd_float4_load(model_positions_z + i);
+		}
+
+		// Summed in the same order as plt_matrix_multiply_vector4f
+		simd_float4 clip_x = simd_float4_add(simd_float4_multiply_add(simd_float4_multiply_add(simd_float4_multiply(m[0][0], x), m[1][0], y), m[2][0], z), m[3][0]);
+		simd_float4 clip_y = simd_float4_add(simd_float4_multiply_add(simd_float4_multiply_add(simd_float4_multiply(m[0][1], x), m[1][1], y), m[2][1], z), m[3][1]);
+		simd_float4 clip_z = simd_float4_add(simd_float4_multiply_add(simd_float4_multiply_add(simd_float4_multiply(m[0][2], x), m[1][2], y), m[2][2], z), m[3][2]);
+		simd_float4 clip_w = simd_float4_add(simd_float4_multiply_add(simd_float4_multiply_add(simd_float4_multiply(m[0][3], x), m[1][3], y), m[2][3], z), m[3][3]);
+		simd_float4_store(clipspace_x + i, clip_x);
+		simd_float4_store(clipspace_y + i, clip_y);
+		simd_float4_store(clipspace_z + i, clip_z);
+		simd_float4_store(clipspace_w + i, clip_w);
+
+		simd_float4 screen_x = simd_float4_multiply(simd_float4_multiply_add(half, simd_float4_divide(clip_x, clip_w), half), viewport_x);
+		simd_float4 screen_y = simd_float4_multiply(simd_float4_multiply_add(half, simd_float4_divide(clip_y, clip_w), half), viewport_y);
+		simd_int4_store(screen_positions_x + i, simd_int4_from_float4(screen_x));
+		simd_int4_store(screen_positions_y + i, simd_int4_from_float4(screen_y));
+	}
+
+	entry->mvp = mvp;
+	entry->viewport = viewport;
+	entry->positions_valid = true;
+}
+
+static void plt_vertex_processor_apply_lighting(Plt_Vertex_Cache_Entry *entry, Plt_Lighting_Model lighting_model, Plt_Lighting_Setup lighting_setup, Plt_Matrix4x4f model) {
+	Plt_Mesh *mesh = entry->mesh;
+	unsigned int vertex_count = mesh->vertex_count;
+	bool quantised = mesh->quantised;
+
+	float *lighting_r = entry->result.lighting_r;
+	float *lighting_g = entry->result.lighting_g;
+	float *lighting_b = entry->result.lighting_b;
+
+	entry->model = model;
+	entry->lighting_model = lighting_model;
+	entry->lighting_setup = lighting_setup;
+	entry->lighting_valid = true;
+
+	const simd_float4 zero = simd_float4_create_scalar(0.0f);
+	const simd_float4 one = simd_float4_create_scalar(1.0f);
+
+	// Unlit draws skip normals entirely
+	if (lighting_model != Plt_Lighting_Model_Vertex_Lit) {
+		entry->result.world_normals_x = NULL;
+		entry->result.world_normals_y = NULL;
+		entry->result.world_normals_z = NULL;
+		for (unsigned int i = 0; i < vertex_count; i += 4) {
+			simd_float4_store(lighting_r + i, one);
+			simd_float4_store(lighting_g + i, one);
+			simd_float4_store(lighting_b + i, one);
+		}
+		return;
+	}
+
+	float *streams = entry->stream_data;
+	unsigned int stride = entry->vertex_capacity;
+	float *world_normals_x = entry->result.world_normals_x = streams + stride * 8;
+	float *world_normals_y = entry->result.world_normals_y = streams + stride * 9;
+	float *world_normals_z = entry->result.world_normals_z = streams + stride * 10;
+
+	// Input
 	float *model_normals_x = mesh->normal_x;
 	float *model_normals_y = mesh->normal_y;
 	float *model_normals_z = mesh->normal_z;
 
-	// Output
-	float *clipspace_x = plt_linear_allocator_alloc(allocator, sizeof(float) * vertex_count);
-	float *clipspace_y = plt_linear_allocator_alloc(allocator, sizeof(float) * vertex_count);
-	float *clipspace_z = plt_linear_allocator_alloc(allocator, sizeof(float) * vertex_count);
-	float *clipspace_w = plt_linear_allocator_alloc(allocator, sizeof(float) * vertex_count);
-	int *screen_positions_x = plt_linear_allocator_alloc(allocator, sizeof(int) * vertex_count);
-	int *screen_positions_y = plt_linear_allocator_alloc(allocator, sizeof(int) * vertex_count);
-	float *world_normals_x = plt_linear_allocator_alloc(allocator, sizeof(float) * vertex_count);
-	float *world_normals_y = plt_linear_allocator_alloc(allocator, sizeof(float) * vertex_count);
-	float *world_normals_z = plt_linear_allocator_alloc(allocator, sizeof(float) * vertex_count);
-	float *lighting_r = plt_linear_allocator_alloc(allocator, sizeof(float) * vertex_count);
-	float *lighting_g = plt_linear_allocator_alloc(allocator, sizeof(float) * vertex_count);
-	float *lighting_b = plt_linear_allocator_alloc(allocator, sizeof(float) * vertex_count);
-
-	for (unsigned int i = 0; i < vertex_count; ++i) {
-		Plt_Vector4f input = { model_positions_x[i], model_positions_y[i], model_positions_z[i], 1.0f };
-		Plt_Vector4f clipspace = plt_matrix_multiply_vector4f(mvp, input);
-		clipspace_x[i] = clipspace.x;
-		clipspace_y[i] = clipspace.y;
-		clipspace_z[i] = clipspace.z;
-		clipspace_w[i] = clipspace.w;
-		
-		screen_positions_x[i] = ((clipspace.x / clipspace.w) * 0.5f + 0.5f) * viewport.x;
-		screen_positions_y[i] = ((clipspace.y / clipspace.w) * 0.5f + 0.5f) * viewport.y;
-		
-		Plt_Vector4f input_normal = { model_normals_x[i], model_normals_y[i], model_normals_z[i], 0.0f };
-		Plt_Vector4f world_normal = plt_matrix_multiply_vector4f(model, input_normal);
-		Plt_Vector3f normalized_world_normal = plt_vector3f_normalize((Plt_Vector3f){world_normal.x, world_normal.y, world_normal.z});
-		world_normals_x[i] = normalized_world_normal.x;
-		world_normals_y[i] = normalized_world_normal.y;
-		world_normals_z[i] = normalized_world_normal.z;
+	// Broadcast matrix columns
+	simd_float4 n[3][3];
+	for (unsigned int c = 0; c < 3; ++c) {
+		for (unsigned int r = 0; r < 3; ++r) {
+			n[c][r] = simd_float4_create_scalar(model.columns[c][r]);
+		}
+	}
+
+	// Broadcast lights
+	unsigned int light_count = lighting_setup.directional_light_count;
+	simd_float4 light_directions[PLT_LIGHTING_SETUP_MAX_DIRECTIONAL_LIGHTS][3];
+	simd_float4 light_amounts[PLT_LIGHTING_SETUP_MAX_DIRECTIONAL_LIGHTS][3];
+	for (unsigned int j = 0; j < light_count; ++j) {
+		light_directions[j][0] = simd_float4_create_scalar(lighting_setup.directional_light_directions[j].x);
+		light_directions[j][1] = simd_float4_create_scalar(lighting_setup.directional_light_directions[j].y);
+		light_directions[j][2] = simd_float4_create_scalar(lighting_setup.directional_light_directions[j].z);
+		light_amounts[j][0] = simd_float4_create_scalar(lighting_setup.directional_light_amounts[j].x);
+		light_amounts[j][1] = simd_float4_create_scalar(lighting_setup.directional_light_amounts[j].y);
+		light_amounts[j][2] = simd_float4_create_scalar(lighting_setup.directional_light_amounts[j].z);
+	}
+	const simd_float4 ambient_r = simd_float4_create_scalar(lighting_setup.ambient_lighting.x);
+	const simd_float4 ambient_g = simd_float4_create_scalar(lighting_setup.ambient_lighting.y);
+	const simd_float4 ambient_b = simd_float4_create_scalar(lighting_setup.ambient_lighting.z);
+	const simd_float4 normal_scale = simd_float4_create_scalar(1.0f / 127.0f);
+
+	for (unsigned int i = 0; i < vertex_count; i += 4) {
+		simd_float4 normal_x, normal_y, normal_z;
+		if (quantised) {
+			// Unfold the octahedron
+			simd_float4 u = simd_float4_multiply(simd_float4_from_int4(simd_int4_load_s8(mesh->quantised_normal_u + i)), normal_scale);
+			simd_float4 v = simd_float4_multiply(simd_float4_from_int4(simd_int4_load_s8(mesh->quantised_normal_v + i)), normal_scale);
+			normal_z = simd_float4_subtract(simd_float4_subtract(one, simd_float4_abs(u)), simd_float4_abs(v));
+			simd_float4 fold = simd_float4_max(simd_float4_subtract(zero, normal_z), zero);
+			normal_x = simd_float4_subtract(u, simd_float4_copy_sign(fold, u));
+			normal_y = simd_float4_subtract(v, simd_float4_copy_sign(fold, v));
+		} else {
+			normal_x = simd_float4_load(model_normals_x + i);
+			normal_y = simd_float4_load(model_normals_y + i);
+			normal_z = simd_float4_load(model_normals_z + i);
+		}
+
+		simd_float4 world_x = simd_float4_multiply_add(simd_float4_multiply_add(simd_float4_multiply(n[0][0], normal_x), n[1][0], normal_y), n[2][0], normal_z);
+		simd_float4 world_y = simd_float4_multiply_add(simd_float4_multiply_add(simd_float4_multiply(n[0][1], normal_x), n[1][1], normal_y), n[2][1], normal_z);
+		simd_float4 world_z = simd_float4_multiply_add(simd_float4_multiply_add(simd_float4_multiply(n[0][2], normal_x), n[1][2], normal_y), n[2][2], normal_z);
+		simd_float4 inverse_length = simd_float4_reciprocal_sqrt(simd_float4_multiply_add(simd_float4_multiply_add(simd_float4_multiply(world_x, world_x), world_y, world_y), world_z, world_z));
+		world_x = simd_float4_multiply(world_x, inverse_length);
+		world_y = simd_float4_multiply(world_y, inverse_length);
+		world_z = simd_float4_multiply(world_z, inverse_length);
+		simd_float4_store(world_normals_x + i, world_x);
+		simd_float4_store(world_normals_y + i, world_y);
+		simd_float4_store(world_normals_z + i, world_z);
 
 		// Apply lighting
-		lighting_r[i] = lighting_setup.ambient_lighting.x;
-		lighting_g[i] = lighting_setup.ambient_lighting.y;
-		lighting_b[i] = lighting_setup.ambient_lighting.z;
-		for (unsigned int j = 0; j < lighting_setup.directional_light_count; ++j) {
-			float light_amount = plt_max(plt_vector3f_dot_product(normalized_world_normal, lighting_setup.directional_light_directions[j]), 0);
-			Plt_Vector3f directional_lighting = plt_vector3f_multiply_scalar(lighting_setup.directional_light_amounts[j], light_amount);
-			lighting_r[i] += directional_lighting.x;
-			lighting_g[i] += directional_lighting.y;
-			lighting_b[i] += directional_lighting.z;
+		simd_float4 light_r = ambient_r;
+		simd_float4 light_g = ambient_g;
+		simd_float4 light_b = ambient_b;
+		for (unsigned int j = 0; j < light_count; ++j) {
+			simd_float4 dot = simd_float4_multiply_add(simd_float4_multiply_add(simd_float4_multiply(world_x, light_directions[j][0]), world_y, light_directions[j][1]), world_z, light_directions[j][2]);
+			simd_float4 light_amount = simd_float4_max(dot, zero);
+			light_r = simd_float4_multiply_add(light_r, light_amounts[j][0], light_amount);
+			light_g = simd_float4_multiply_add(light_g, light_amounts[j][1], light_amount);
+			light_b = simd_float4_multiply_add(light_b, light_amounts[j][2], light_amount);
 		}
+		simd_float4_store(lighting_r + i, light_r);
+		simd_float4_store(lighting_g + i, light_g);
+		simd_float4_store(lighting_b + i, light_b);
 	}
+}
 
-	return (Plt_Vertex_Processor_Result) {
-		.vertex_count = vertex_count,
-		.clipspace_x = clipspace_x,
-		.clipspace_y = clipspace_y,
-		.clipspace_z = clipspace_z,
-		.clipspace_w = clipspace_w,
-		.screen_positions_x = screen_positions_x,
-		.screen_positions_y = screen_positions_y,
-		.model_uvs_x = model_uvs_x,
-		.model_uvs_y = model_uvs_y,
-		.world_normals_x = world_normals_x,
-		.world_normals_y = world_normals_y,
-		.world_normals_z = world_normals_z,
-		.lighting_r = lighting_r,
-		.lighting_g = lighting_g,
-		.lighting_b = lighting_b
-	};
+Plt_Vertex_Processor_Result plt_vertex_processor_process_mesh(Plt_Vertex_Processor *processor, Plt_Lighting_Model lighting_model, Plt_Lighting_Setup lighting_setup, Plt_Mesh *mesh, Plt_Vector2i viewport, Plt_Matrix4x4f model, Plt_Matrix4x4f mvp) {
+	// Prefer an entry that matches outright, then one whose lighting survives a camera move. Unlit lighting
+	// matches every draw of the mesh, so only entries no other draw has used this frame are taken over,
+	// otherwise instances of one mesh would keep transforming over each other's entry
+	Plt_Vertex_Cache_Entry *entry = NULL;
+	for (unsigned int i = 0; i < PLT_VERTEX_CACHE_SIZE; ++i) {
+		Plt_Vertex_Cache_Entry *candidate = &processor->cache[i];
+		if ((candidate->mesh != mesh) || (candidate->mesh_revision != mesh->revision) || !plt_vertex_processor_entry_lighting_matches(candidate, lighting_model, lighting_setup, model)) {
+			continue;
+		}
+
+		if (plt_vertex_processor_entry_positions_match(candidate, viewport, mvp)) {
+			entry = candidate;
+			break;
+		}
+
+		if (!entry && (candidate->last_used_frame != processor->frame_index)) {
+			entry = candidate;
+		}
+	}
+
+	if (!entry) {
+		entry = plt_vertex_processor_evict_entry(processor, mesh);
+		plt_vertex_processor_apply_lighting(entry, lighting_model, lighting_setup, model);
+	}
+
+	if (!plt_vertex_processor_entry_positions_match(entry, viewport, mvp)) {
+		plt_vertex_processor_transform_positions(entry, viewport, mvp);
+	}
+
+	entry->last_used = ++processor->use_counter;
+	entry->last_used_frame = processor->frame_index;
+	return entry->result;
 }
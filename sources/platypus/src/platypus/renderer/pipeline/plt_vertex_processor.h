@@ -29,6 +29,10 @@ typedef struct Plt_Vertex_Processor_Result {
 Plt_Vertex_Processor *plt_vertex_processor_create();
 void plt_vertex_processor_destroy(Plt_Vertex_Processor **processor);
 
+// Marks the start of a frame's draws, entries used earlier in a frame aren't handed to other draws
+void plt_vertex_processor_begin_frame(Plt_Vertex_Processor *processor);
+
 typedef struct Plt_Mesh Plt_Mesh;
-typedef struct Plt_Linear_Allocator Plt_Linear_Allocator;
-Plt_Vertex_Processor_Result plt_vertex_processor_process_mesh(Plt_Vertex_Processor *processor, Plt_Linear_Allocator *allocator, Plt_Lighting_Setup lighting_setup, Plt_Mesh *mesh, Plt_Vector2i viewport, Plt_Matrix4x4f model, Plt_Matrix4x4f mvp);
+// Transforms 4 vertices per iteration, world normals are NULL and lighting is 1 for unlit draws.
+// Results live in a cache owned by the processor and stay valid until the next call.
+Plt_Vertex_Processor_Result plt_vertex_processor_process_mesh(Plt_Vertex_Processor *processor, Plt_Lighting_Model lighting_model, Plt_Lighting_Setup lighting_setup, Plt_Mesh *mesh, Plt_Vector2i viewport, Plt_Matrix4x4f model, Plt_Matrix4x4f mvp);
@@ -1,16 +1,19 @@
 #include "plt_renderer.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include "platypus/application/plt_application.h"
 #include "platypus/base/plt_macros.h"
 #include "platypus/base/plt_platform.h"
 #include "platypus/mesh/plt_mesh.h"
+#include "platypus/texture/plt_texture.h"
 #include "platypus/renderer/pipeline/plt_vertex_processor.h"
+#include "platypus/renderer/pipeline/plt_point_processor.h"
+#include "platypus/renderer/pipeline/plt_billboard_processor.h"
 #include "platypus/renderer/pipeline/plt_triangle_processor.h"
 #include "platypus/renderer/pipeline/plt_triangle_rasteriser.h"
 
 Plt_Vector2i plt_renderer_clipspace_to_pixel(Plt_Renderer *renderer, Plt_Vector2f p);
-void plt_renderer_draw_point(Plt_Renderer *renderer, Plt_Vector2f p, Plt_Color8 color);
 void plt_renderer_poke_pixel(Plt_Renderer *renderer, Plt_Vector2i p, Plt_Color8 color);
 
 void plt_renderer_draw_mesh_points(Plt_Renderer *renderer, Plt_Mesh *mesh);
@@ -21,9 +24,19 @@ Plt_Renderer *plt_renderer_create(Plt_Application *application, Plt_Framebuffer
 	Plt_Renderer *renderer = malloc(sizeof(Plt_Renderer));
 	
 	renderer->application = application;
-	renderer->frame_allocator = plt_linear_allocator_create(1024 * 1024 * 128); // 64MB
+	renderer->owned_pixels = NULL;
+	for (unsigned int i = 0; i < 2; ++i) {
+		renderer->command_lists[i].frame_allocator = plt_linear_allocator_create(PLT_RENDERER_FRAME_ALLOCATOR_SIZE);
+		renderer->command_lists[i].draw_call_count = 0;
+		renderer->command_lists[i].debug_view = Plt_Renderer_Debug_View_None;
+	}
+	renderer->recording_commands = &renderer->command_lists[0];
+	renderer->submitted_commands = &renderer->command_lists[1];
+	renderer->static_allocator = plt_linear_allocator_create(PLT_RENDERER_STATIC_ALLOCATOR_SIZE);
 
 	renderer->vertex_processor = plt_vertex_processor_create();
+	renderer->point_processor = plt_point_processor_create();
+	renderer->billboard_processor = plt_billboard_processor_create();
 	renderer->triangle_processor = plt_triangle_processor_create();
 	renderer->triangle_rasteriser = plt_triangle_rasteriser_create(renderer, (Plt_Size){ framebuffer.width, framebuffer.height });
 	
@@ -32,13 +45,20 @@ Plt_Renderer *plt_renderer_create(Plt_Application *application, Plt_Framebuffer
 	renderer->projection_matrix =
 	renderer->mvp_matrix = plt_matrix_identity();
 	
-	renderer->draw_call_count = 0;
+	renderer->static_bins_valid = false;
+	renderer->static_draw_call_count = 0;
+
+	renderer->frame_results_mutex = plt_thread_mutex_create();
+	renderer->frame_timings = (Plt_Renderer_Frame_Timings){ 0 };
+	renderer->frame_stats = (Plt_Renderer_Stats){ 0 };
 
 	renderer->clear_color = plt_color8_make(0, 0, 0, 255);
+	renderer->debug_view = Plt_Renderer_Debug_View_None;
 	
 	renderer->point_size = 1;
 	renderer->primitive_type = Plt_Primitive_Type_Triangle;
 	renderer->lighting_model = Plt_Lighting_Model_Unlit;
+	renderer->static_geometry = false;
 	renderer->render_color = plt_color8_make(255,255,255,255);
 	
 	renderer->lighting_setup = (Plt_Lighting_Setup) {
@@ -60,18 +80,56 @@ Plt_Renderer *plt_renderer_create(Plt_Application *application, Plt_Framebuffer
 }
 
 void plt_renderer_destroy(Plt_Renderer **renderer) {
-	plt_linear_allocator_destroy(&(*renderer)->frame_allocator);
+	for (unsigned int i = 0; i < 2; ++i) {
+		plt_linear_allocator_destroy(&(*renderer)->command_lists[i].frame_allocator);
+	}
+	plt_linear_allocator_destroy(&(*renderer)->static_allocator);
 	plt_vertex_processor_destroy(&(*renderer)->vertex_processor);
+	plt_point_processor_destroy(&(*renderer)->point_processor);
+	plt_billboard_processor_destroy(&(*renderer)->billboard_processor);
 	plt_triangle_processor_destroy(&(*renderer)->triangle_processor);
+	plt_triangle_rasteriser_destroy(&(*renderer)->triangle_rasteriser);
+	plt_thread_mutex_destroy(&(*renderer)->frame_results_mutex);
 
 	if ((*renderer)->depth_buffer) {
 		free((*renderer)->depth_buffer);
 	}
+	if ((*renderer)->owned_pixels) {
+		free((*renderer)->owned_pixels);
+	}
 	
 	free(*renderer);
 	*renderer = NULL;
 }
 
+Plt_Renderer *plt_renderer_create_headless(Plt_Framebuffer framebuffer) {
+	Plt_Renderer *renderer = plt_renderer_create(NULL, (Plt_Framebuffer){ .pixels = NULL, .width = framebuffer.width, .height = framebuffer.height });
+	plt_renderer_set_framebuffer(renderer, framebuffer);
+	return renderer;
+}
+
+void plt_renderer_set_framebuffer(Plt_Renderer *renderer, Plt_Framebuffer framebuffer) {
+	plt_assert((framebuffer.width > 0) && (framebuffer.height > 0), "Framebuffer must have a width and height.\n");
+
+	Plt_Color8 *previous_owned_pixels = renderer->owned_pixels;
+	if (!framebuffer.pixels) {
+		framebuffer.pixels = malloc(sizeof(Plt_Color8) * framebuffer.width * framebuffer.height);
+		renderer->owned_pixels = framebuffer.pixels;
+	} else if (framebuffer.pixels != previous_owned_pixels) {
+		renderer->owned_pixels = NULL;
+	}
+
+	plt_renderer_update_framebuffer(renderer, framebuffer);
+
+	if (previous_owned_pixels && (previous_owned_pixels != renderer->owned_pixels)) {
+		free(previous_owned_pixels);
+	}
+}
+
+Plt_Framebuffer plt_renderer_get_framebuffer(Plt_Renderer *renderer) {
+	return renderer->framebuffer;
+}
+
 void plt_renderer_update_framebuffer(Plt_Renderer *renderer, Plt_Framebuffer framebuffer) {
 	renderer->framebuffer = framebuffer;
 	plt_triangle_rasteriser_update_framebuffer(renderer->triangle_rasteriser, framebuffer);
@@ -90,17 +148,16 @@ void plt_renderer_update_framebuffer(Plt_Renderer *renderer, Plt_Framebuffer fra
 
 void plt_renderer_rasterise_triangles(Plt_Renderer *renderer) {
 	// Rasterise triangles
-	plt_timer_start(tr_timer)
+	plt_trace_begin("Rasterise");
+	uint64_t start_ns = plt_platform_get_time_ns();
 	plt_triangle_rasteriser_render_triangles(renderer->triangle_rasteriser);
-	plt_linear_allocator_clear(renderer->frame_allocator);
-	plt_timer_end(tr_timer, "TRIANGLE_RASTERISER")
+	plt_linear_allocator_clear(renderer->submitted_commands->frame_allocator);
+	renderer->stage_ns[Plt_Renderer_Stage_Rasteriser] += plt_platform_get_time_ns() - start_ns;
+	plt_trace_end("Rasterise");
 }
 
+// Takes effect when the frame is executed, the bins may still be in use by the last frame
 void plt_renderer_clear(Plt_Renderer *renderer, Plt_Color8 clear_color) {
-	Plt_Framebuffer framebuffer = renderer->framebuffer;
-	
-	// Clear triangle bins
-	plt_rasteriser_clear_triangle_bins(renderer->triangle_rasteriser);
 	renderer->clear_color = clear_color;
 }
 
@@ -151,6 +208,10 @@ void plt_renderer_plot_line_high(Plt_Renderer *renderer, Plt_Vector2i p0, Plt_Ve
 }
 
 void plt_renderer_plot_line(Plt_Renderer *renderer, Plt_Vector2i p0, Plt_Vector2i p1, Plt_Color8 color) {
+	Plt_Vector2i line_min = { plt_min(p0.x, p1.x), plt_min(p0.y, p1.y) };
+	Plt_Vector2i line_max = { plt_max(p0.x, p1.x), plt_max(p0.y, p1.y) };
+	plt_rasteriser_mark_overlay(renderer->triangle_rasteriser, plt_rect_make(line_min.x, line_min.y, line_max.x - line_min.x + 1, line_max.y - line_min.y + 1));
+	
 	if (abs(p1.y - p0.y) < abs(p1.x - p0.x)) {
 		if (p0.x > p1.x) {
 			plt_renderer_plot_line_low(renderer, p1, p0, color);
@@ -167,17 +228,26 @@ void plt_renderer_plot_line(Plt_Renderer *renderer, Plt_Vector2i p0, Plt_Vector2
 }
 
 void plt_renderer_execute_draw_call_draw_mesh(Plt_Renderer *renderer, Plt_Renderer_Draw_Call draw_call) {
+	Plt_Renderer_Command_List *commands = renderer->submitted_commands;
 	Plt_Vector2i viewport = { renderer->framebuffer.width, renderer->framebuffer.height };
 	Plt_Matrix4x4f mvp = plt_matrix_multiply(draw_call.projection, plt_matrix_multiply(draw_call.view, draw_call.model));
 	
 	switch (draw_call.primitive_type) {
 		case Plt_Primitive_Type_Triangle: {
-			Plt_Vertex_Processor_Result vp_result = plt_vertex_processor_process_mesh(renderer->vertex_processor, renderer->frame_allocator, renderer->lighting_setup, draw_call.mesh, viewport, draw_call.model, mvp);
-			plt_triangle_processor_process_vertex_data(renderer->triangle_processor, renderer->frame_allocator, viewport, draw_call.texture, vp_result, renderer->triangle_rasteriser);
+			// Static setup data has to outlive the frame
+			Plt_Linear_Allocator *allocator = draw_call.is_static ? renderer->static_allocator : commands->frame_allocator;
+			uint64_t start_ns = plt_platform_get_time_ns();
+			Plt_Vertex_Processor_Result vp_result = plt_vertex_processor_process_mesh(renderer->vertex_processor, draw_call.lighting_model, commands->lighting_setup, draw_call.mesh, viewport, draw_call.model, mvp);
+			uint64_t vertices_processed_ns = plt_platform_get_time_ns();
+			plt_triangle_processor_process_vertex_data(renderer->triangle_processor, allocator, viewport, draw_call.texture, vp_result, renderer->triangle_rasteriser, &renderer->stats);
+			renderer->stats.vertices_processed += vp_result.vertex_count;
+			renderer->stage_ns[Plt_Renderer_Stage_Vertex_Processor] += vertices_processed_ns - start_ns;
+			renderer->stage_ns[Plt_Renderer_Stage_Triangle_Processor] += plt_platform_get_time_ns() - vertices_processed_ns;
 		} break;
 			
 		case Plt_Primitive_Type_Line: {
-			Plt_Vertex_Processor_Result vp_result = plt_vertex_processor_process_mesh(renderer->vertex_processor, renderer->frame_allocator, renderer->lighting_setup, draw_call.mesh, viewport, draw_call.model, mvp);
+			// Lines are drawn flat, so skip lighting
+			Plt_Vertex_Processor_Result vp_result = plt_vertex_processor_process_mesh(renderer->vertex_processor, Plt_Lighting_Model_Unlit, commands->lighting_setup, draw_call.mesh, viewport, draw_call.model, mvp);
 
 			// Draw lines
 			for (unsigned int i = 0; i < vp_result.vertex_count; i += 3) {
@@ -209,24 +279,9 @@ void plt_renderer_execute_draw_call_draw_mesh(Plt_Renderer *renderer, Plt_Render
 		} break;
 			
 		case Plt_Primitive_Type_Point: {
-			for (unsigned int i = 0; i < draw_call.mesh->vertex_count; i += 1) {
-				Plt_Vector4f pos = {
-					draw_call.mesh->position_x[i],
-					draw_call.mesh->position_y[i],
-					draw_call.mesh->position_z[i],
-					1.0f
-				};
-				
-				pos = plt_matrix_multiply_vector4f(mvp, pos);
-				
-				// Discard behind the camera
-				if (pos.z < 0) {
-					return;
-				}
-				
-				Plt_Vector2f clip_xy = {pos.x / pos.w, pos.y / pos.w};
-				plt_renderer_draw_point(renderer, clip_xy, draw_call.color);
-			}
+			uint64_t start_ns = plt_platform_get_time_ns();
+			plt_point_processor_process_mesh(renderer->point_processor, commands->frame_allocator, draw_call.mesh, viewport, mvp, draw_call.texture, draw_call.color, draw_call.point_size, renderer->triangle_rasteriser);
+			renderer->stage_ns[Plt_Renderer_Stage_Triangle_Processor] += plt_platform_get_time_ns() - start_ns;
 		} break;
 	}
 }
@@ -244,78 +299,376 @@ void plt_renderer_execute_draw_call_draw_direct_texture(Plt_Renderer *renderer,
 
 	Plt_Color8 *pixels = renderer->framebuffer.pixels;
 	unsigned int row_length = renderer->framebuffer.width;
-		
-	Plt_Vector2i p_inc = { 1, 1 };
-	Plt_Vector2i tex_pos = draw_call.texture_offset;
+	plt_rasteriser_mark_overlay(renderer->triangle_rasteriser, draw_call.rect);
+	
+	// Unswizzle texture rows in spans rather than addressing every texel
+	Plt_Color8 span[64];
+	Plt_Vector2i tex_pos = {
+		draw_call.texture_offset.x + (bounds_min.x - draw_call.rect.x),
+		draw_call.texture_offset.y + (bounds_min.y - draw_call.rect.y)
+	};
 	for (unsigned int y = bounds_min.y; y < bounds_max.y; ++y) {
-		tex_pos.x = draw_call.texture_offset.x;
-		for (unsigned int x = bounds_min.x; x < bounds_max.x; ++x) {
-			Plt_Color8 pixel = plt_texture_get_pixel(draw_call.texture, tex_pos);
-			if (pixel.a == 255) {
-				pixels[y * row_length + x] = pixel;
-			} else if (pixel.a > 0) {
-				// Alpha blend
-				pixels[y * row_length + x] = plt_color8_blend(pixels[y * row_length + x], pixel);
+		for (unsigned int x = bounds_min.x; x < bounds_max.x; x += 64) {
+			unsigned int span_length = plt_min(bounds_max.x - x, 64);
+			plt_texture_copy_row(draw_call.texture, plt_vector2i_make(tex_pos.x + (x - bounds_min.x), tex_pos.y), span_length, span);
+			
+			Plt_Color8 *row = pixels + y * row_length + x;
+			for (unsigned int i = 0; i < span_length; ++i) {
+				Plt_Color8 pixel = span[i];
+				if (pixel.a == 255) {
+					row[i] = pixel;
+				} else if (pixel.a > 0) {
+					// Alpha blend
+					row[i] = plt_color8_blend(row[i], pixel);
+				}
 			}
-			tex_pos.x++;
 		}
 		tex_pos.y++;
 	}
 }
 
+void plt_renderer_execute_draw_call_draw_direct_colored_rect(Plt_Renderer *renderer, Plt_Renderer_Draw_Call draw_call) {
+	Plt_Vector2i bounds_min = {
+		plt_clamp(draw_call.rect.x, 0, renderer->framebuffer.width),
+		plt_clamp(draw_call.rect.y, 0, renderer->framebuffer.height)
+	};
+
+	Plt_Vector2i bounds_max = {
+		plt_clamp(draw_call.rect.x + draw_call.rect.width, 0, renderer->framebuffer.width),
+		plt_clamp(draw_call.rect.y + draw_call.rect.height, 0, renderer->framebuffer.height)
+	};
+
+	if (draw_call.color.a == 0) {
+		return;
+	}
+
+	Plt_Color8 *pixels = renderer->framebuffer.pixels;
+	unsigned int row_length = renderer->framebuffer.width;
+	plt_rasteriser_mark_overlay(renderer->triangle_rasteriser, draw_call.rect);
+
+	for (unsigned int y = bounds_min.y; y < bounds_max.y; ++y) {
+		Plt_Color8 *row = pixels + y * row_length;
+		for (unsigned int x = bounds_min.x; x < bounds_max.x; ++x) {
+			row[x] = (draw_call.color.a == 255) ? draw_call.color : plt_color8_blend(row[x], draw_call.color);
+		}
+	}
+}
+
+void plt_renderer_execute_draw_call_draw_direct_pixel(Plt_Renderer *renderer, Plt_Renderer_Draw_Call draw_call) {
+	Plt_Vector2i position = { draw_call.rect.x, draw_call.rect.y };
+	if ((position.x < 0) || (position.y < 0) || (position.x >= renderer->framebuffer.width) || (position.y >= renderer->framebuffer.height)) {
+		return;
+	}
+	plt_rasteriser_mark_overlay(renderer->triangle_rasteriser, draw_call.rect);
+	renderer->framebuffer.pixels[position.y * renderer->framebuffer.width + position.x] = draw_call.color;
+}
+
+void plt_renderer_execute_draw_call_draw_direct_scaled_texture(Plt_Renderer *renderer, Plt_Renderer_Draw_Call draw_call) {
+	Plt_Vector2i bounds_min = {
+		plt_clamp(draw_call.rect.x, 0, renderer->framebuffer.width),
+		plt_clamp(draw_call.rect.y, 0, renderer->framebuffer.height)
+	};
+
+	Plt_Vector2i bounds_max = {
+		plt_clamp(draw_call.rect.x + draw_call.rect.width, 0, renderer->framebuffer.width),
+		plt_clamp(draw_call.rect.y + draw_call.rect.height, 0, renderer->framebuffer.height)
+	};
+
+	Plt_Color8 render_color = draw_call.color;
+	Plt_Color8 *pixels = renderer->framebuffer.pixels;
+	unsigned int row_length = renderer->framebuffer.width;
+	plt_rasteriser_mark_overlay(renderer->triangle_rasteriser, draw_call.rect);
+	
+	Plt_Texture *texture = draw_call.texture;
+	if (!texture) {
+		for (unsigned int y = bounds_min.y; y < bounds_max.y; ++y) {
+			for (unsigned int x = bounds_min.x; x < bounds_max.x; ++x) {
+				pixels[y * row_length + x] = render_color;
+			}
+		}
+		return;
+	}
+	
+	// Step through level 0 in texel space, sampling at pixel centres
+	const Plt_Texture_Mip_Level *level = &texture->mip_levels[0];
+	Plt_Texture_Filter filter = texture->filter;
+	Plt_Vector2f p_inc = { (float)level->size.width / (float)draw_call.rect.width, (float)level->size.height / (float)draw_call.rect.height };
+	
+	Plt_Vector2f tex_pos;
+	tex_pos.y = ((int)bounds_min.y - draw_call.rect.y + 0.5f) * p_inc.y;
+	for (unsigned int y = bounds_min.y; y < bounds_max.y; ++y) {
+		tex_pos.x = ((int)bounds_min.x - draw_call.rect.x + 0.5f) * p_inc.x;
+		for (unsigned int x = bounds_min.x; x < bounds_max.x; ++x) {
+			pixels[y * row_length + x] = plt_texture_mip_level_sample(level, filter, tex_pos.x, tex_pos.y);
+			tex_pos.x += p_inc.x;
+		}
+		tex_pos.y += p_inc.y;
+	}
+}
+
 void plt_renderer_execute_draw_call(Plt_Renderer *renderer, Plt_Renderer_Draw_Call draw_call) {
 	switch (draw_call.type) {
 		case Plt_Renderer_Draw_Call_Type_Draw_Mesh:
 			plt_renderer_execute_draw_call_draw_mesh(renderer, draw_call);
 			break;
 			
+		case Plt_Renderer_Draw_Call_Type_Draw_Billboard:
+			// Billboards are binned together in plt_renderer_execute
+			break;
+			
 		case Plt_Renderer_Draw_Call_Type_Draw_Direct_Texture:
 			plt_renderer_execute_draw_call_draw_direct_texture(renderer, draw_call);
 			break;
+
+		case Plt_Renderer_Draw_Call_Type_Draw_Direct_Colored_Rect:
+			plt_renderer_execute_draw_call_draw_direct_colored_rect(renderer, draw_call);
+			break;
+
+		case Plt_Renderer_Draw_Call_Type_Draw_Direct_Pixel:
+			plt_renderer_execute_draw_call_draw_direct_pixel(renderer, draw_call);
+			break;
+
+		case Plt_Renderer_Draw_Call_Type_Draw_Direct_Scaled_Texture:
+			plt_renderer_execute_draw_call_draw_direct_scaled_texture(renderer, draw_call);
+			break;
+	}
+}
+
+static bool plt_renderer_is_static_draw_call(const Plt_Renderer_Draw_Call *call) {
+	return call->is_static && (call->type == Plt_Renderer_Draw_Call_Type_Draw_Mesh) && (call->primitive_type == Plt_Primitive_Type_Triangle);
+}
+
+static bool plt_renderer_static_draw_calls_equal(const Plt_Renderer_Draw_Call *a, const Plt_Renderer_Draw_Call *b) {
+	return (a->mesh == b->mesh) && (a->texture == b->texture) && (a->lighting_model == b->lighting_model)
+		&& (memcmp(&a->color, &b->color, sizeof(Plt_Color8)) == 0)
+		&& (memcmp(&a->model, &b->model, sizeof(Plt_Matrix4x4f)) == 0)
+		&& (memcmp(&a->view, &b->view, sizeof(Plt_Matrix4x4f)) == 0)
+		&& (memcmp(&a->projection, &b->projection, sizeof(Plt_Matrix4x4f)) == 0);
+}
+
+// The static bins stay valid while this frame issues the same static draws, in the same order, as the frame they were built in
+bool plt_renderer_static_bins_match(Plt_Renderer *renderer, Plt_Vector2i viewport) {
+	Plt_Renderer_Command_List *commands = renderer->submitted_commands;
+	if (!renderer->static_bins_valid || (renderer->static_viewport.x != viewport.x) || (renderer->static_viewport.y != viewport.y)) {
+		return false;
+	}
+
+	if (memcmp(&renderer->static_lighting_setup, &commands->lighting_setup, sizeof(Plt_Lighting_Setup)) != 0) {
+		return false;
+	}
+
+	unsigned int static_count = 0;
+	for (unsigned int i = 0; i < commands->draw_call_count; ++i) {
+		const Plt_Renderer_Draw_Call *call = &commands->draw_calls[i];
+		if (!plt_renderer_is_static_draw_call(call)) {
+			continue;
+		}
+
+		if (static_count == renderer->static_draw_call_count) {
+			return false;
+		}
+
+		if (!plt_renderer_static_draw_calls_equal(call, &renderer->static_draw_calls[static_count]) || (call->mesh->revision != renderer->static_mesh_revisions[static_count])) {
+			return false;
+		}
+		++static_count;
 	}
+
+	return static_count == renderer->static_draw_call_count;
+}
+
+void plt_renderer_rebuild_static_bins(Plt_Renderer *renderer, Plt_Vector2i viewport) {
+	Plt_Renderer_Command_List *commands = renderer->submitted_commands;
+	plt_linear_allocator_clear(renderer->static_allocator);
+
+	unsigned int static_count = 0;
+	for (unsigned int i = 0; i < commands->draw_call_count; ++i) {
+		Plt_Renderer_Draw_Call call = commands->draw_calls[i];
+		if (!plt_renderer_is_static_draw_call(&call)) {
+			continue;
+		}
+
+		plt_renderer_execute_draw_call(renderer, call);
+		renderer->static_draw_calls[static_count] = call;
+		renderer->static_mesh_revisions[static_count] = call.mesh->revision;
+		++static_count;
+	}
+
+	// Move everything just binned into the rasteriser's static bins
+	plt_rasteriser_capture_static_triangle_bins(renderer->triangle_rasteriser);
+
+	renderer->static_draw_call_count = static_count;
+	renderer->static_viewport = viewport;
+	renderer->static_lighting_setup = commands->lighting_setup;
+	renderer->static_bins_valid = true;
 }
 
 void plt_renderer_execute(Plt_Renderer *renderer) {
-	// Draw filled meshes first
-	for (unsigned int i = 0; i < renderer->draw_call_count; ++i) {
-		Plt_Renderer_Draw_Call call = renderer->draw_calls[i];
+	plt_renderer_submit(renderer);
+	plt_renderer_execute_submitted(renderer);
+}
+
+// Freezes what has been recorded so far and starts recording into the other list
+void plt_renderer_submit(Plt_Renderer *renderer) {
+	Plt_Renderer_Command_List *commands = renderer->recording_commands;
+	commands->clear_color = renderer->clear_color;
+	commands->lighting_setup = renderer->lighting_setup;
+	commands->debug_view = renderer->debug_view;
+
+	renderer->recording_commands = renderer->submitted_commands;
+	renderer->recording_commands->draw_call_count = 0;
+	renderer->submitted_commands = commands;
+}
+
+void plt_renderer_execute_submitted(Plt_Renderer *renderer) {
+	Plt_Renderer_Command_List *commands = renderer->submitted_commands;
+	Plt_Vector2i viewport = { renderer->framebuffer.width, renderer->framebuffer.height };
+
+	plt_trace_begin("Execute Frame");
+	uint64_t frame_start_ns = plt_platform_get_time_ns();
+	for (unsigned int i = 0; i < Plt_Renderer_Stage_Count; ++i) {
+		renderer->stage_ns[i] = 0;
+	}
+	renderer->triangle_count = 0;
+	renderer->stats = (Plt_Renderer_Stats){
+		.draw_call_count = commands->draw_call_count
+	};
+
+	plt_vertex_processor_begin_frame(renderer->vertex_processor);
+
+	// Clear triangle bins
+	plt_rasteriser_clear_triangle_bins(renderer->triangle_rasteriser);
+
+	// Static geometry is only re-binned when something about it changed
+	if (!plt_renderer_static_bins_match(renderer, viewport)) {
+		plt_trace_begin("Bin Static Geometry");
+		plt_renderer_rebuild_static_bins(renderer, viewport);
+		plt_trace_end("Bin Static Geometry");
+	}
+
+	// Bin dynamic filled meshes and points
+	plt_trace_begin("Bin Dynamic Geometry");
+	for (unsigned int i = 0; i < commands->draw_call_count; ++i) {
+		Plt_Renderer_Draw_Call call = commands->draw_calls[i];
 		if ((call.type == Plt_Renderer_Draw_Call_Type_Draw_Mesh) && (call.primitive_type == Plt_Primitive_Type_Triangle)) {
+			renderer->triangle_count += call.mesh->vertex_count / 3;
+		}
+		if ((call.type == Plt_Renderer_Draw_Call_Type_Draw_Mesh) && (call.primitive_type != Plt_Primitive_Type_Line) && !plt_renderer_is_static_draw_call(&call)) {
 			plt_renderer_execute_draw_call(renderer, call);
 		}
 	}
+	plt_trace_end("Bin Dynamic Geometry");
+	
+	// Bin billboards in texture batches
+	plt_trace_begin("Bin Billboards");
+	uint64_t billboards_start_ns = plt_platform_get_time_ns();
+	plt_billboard_processor_process_draw_calls(renderer->billboard_processor, commands->frame_allocator, commands->draw_calls, commands->draw_call_count, viewport, renderer->triangle_rasteriser);
+	renderer->stage_ns[Plt_Renderer_Stage_Triangle_Processor] += plt_platform_get_time_ns() - billboards_start_ns;
+	plt_trace_end("Bin Billboards");
+	
 	plt_renderer_rasterise_triangles(renderer);
-	plt_linear_allocator_clear(renderer->frame_allocator);
+	plt_linear_allocator_clear(commands->frame_allocator);
 	
 	// Draw every other scene element
-	for (unsigned int i = 0; i < renderer->draw_call_count; ++i) {
-		Plt_Renderer_Draw_Call call = renderer->draw_calls[i];
-		if ((call.type == Plt_Renderer_Draw_Call_Type_Draw_Mesh) && (call.primitive_type != Plt_Primitive_Type_Triangle)) {
+	plt_trace_begin("Direct Draws");
+	uint64_t direct_draw_start_ns = plt_platform_get_time_ns();
+	for (unsigned int i = 0; i < commands->draw_call_count; ++i) {
+		Plt_Renderer_Draw_Call call = commands->draw_calls[i];
+		if ((call.type == Plt_Renderer_Draw_Call_Type_Draw_Mesh) && (call.primitive_type == Plt_Primitive_Type_Line)) {
 			plt_renderer_execute_draw_call(renderer, call);
 		}
 	}
-	plt_linear_allocator_clear(renderer->frame_allocator);
+	plt_linear_allocator_clear(commands->frame_allocator);
 	
 	// Draw direct calls
-	for (unsigned int i = 0; i < renderer->draw_call_count; ++i) {
-		Plt_Renderer_Draw_Call call = renderer->draw_calls[i];
-		if (call.type == Plt_Renderer_Draw_Call_Type_Draw_Direct_Texture) {
-			plt_renderer_execute_draw_call(renderer, renderer->draw_calls[i]);
+	for (unsigned int i = 0; i < commands->draw_call_count; ++i) {
+		Plt_Renderer_Draw_Call call = commands->draw_calls[i];
+		switch (call.type) {
+			case Plt_Renderer_Draw_Call_Type_Draw_Direct_Texture:
+			case Plt_Renderer_Draw_Call_Type_Draw_Direct_Colored_Rect:
+			case Plt_Renderer_Draw_Call_Type_Draw_Direct_Pixel:
+			case Plt_Renderer_Draw_Call_Type_Draw_Direct_Scaled_Texture:
+				plt_renderer_execute_draw_call(renderer, call);
+				break;
+
+			default:
+				break;
 		}
 	}
-	plt_linear_allocator_clear(renderer->frame_allocator);
-		
-	renderer->draw_call_count = 0;
+	plt_linear_allocator_clear(commands->frame_allocator);
+
+	uint64_t frame_end_ns = plt_platform_get_time_ns();
+	renderer->stage_ns[Plt_Renderer_Stage_Direct_Draw] += frame_end_ns - direct_draw_start_ns;
+	Plt_Renderer_Frame_Timings frame_timings = {
+		.vertex_processor_ms = renderer->stage_ns[Plt_Renderer_Stage_Vertex_Processor] / 1000000.0f,
+		.triangle_processor_ms = renderer->stage_ns[Plt_Renderer_Stage_Triangle_Processor] / 1000000.0f,
+		.rasteriser_ms = renderer->stage_ns[Plt_Renderer_Stage_Rasteriser] / 1000000.0f,
+		.direct_draw_ms = renderer->stage_ns[Plt_Renderer_Stage_Direct_Draw] / 1000000.0f,
+		.total_ms = (frame_end_ns - frame_start_ns) / 1000000.0f,
+		.triangle_count = renderer->triangle_count
+	};
+	plt_thread_mutex_lock(renderer->frame_results_mutex);
+	renderer->frame_timings = frame_timings;
+	renderer->frame_stats = renderer->stats;
+	plt_thread_mutex_unlock(renderer->frame_results_mutex);
+	plt_trace_end("Direct Draws");
+	plt_trace_counter("Triangles", renderer->triangle_count);
+	plt_trace_end("Execute Frame");
+}
+
+void plt_renderer_set_thread_count(Plt_Renderer *renderer, unsigned int thread_count) {
+	plt_triangle_rasteriser_set_thread_count(renderer->triangle_rasteriser, thread_count);
+}
+
+unsigned int plt_renderer_get_thread_count(Plt_Renderer *renderer) {
+	return plt_triangle_rasteriser_get_thread_count(renderer->triangle_rasteriser);
+}
+
+// Takes effect when the frame is executed, like the clear color
+void plt_renderer_set_debug_view(Plt_Renderer *renderer, Plt_Renderer_Debug_View debug_view) {
+	plt_assert(debug_view < Plt_Renderer_Debug_View_Count, "Invalid renderer debug view.\n");
+	renderer->debug_view = debug_view;
+}
+
+Plt_Renderer_Debug_View plt_renderer_get_debug_view(Plt_Renderer *renderer) {
+	return renderer->debug_view;
+}
+
+// Written by the thread executing frames, safe to read from any thread while the next frame executes
+Plt_Renderer_Frame_Timings plt_renderer_get_frame_timings(Plt_Renderer *renderer) {
+	plt_thread_mutex_lock(renderer->frame_results_mutex);
+	Plt_Renderer_Frame_Timings frame_timings = renderer->frame_timings;
+	plt_thread_mutex_unlock(renderer->frame_results_mutex);
+	return frame_timings;
+}
+
+Plt_Renderer_Stats plt_renderer_get_stats(Plt_Renderer *renderer) {
+	plt_thread_mutex_lock(renderer->frame_results_mutex);
+	Plt_Renderer_Stats stats = renderer->frame_stats;
+	plt_thread_mutex_unlock(renderer->frame_results_mutex);
+	return stats;
 }
 
 void plt_renderer_direct_draw_pixel(Plt_Renderer *renderer, Plt_Vector2i position, unsigned int depth, Plt_Color8 color) {
-	if ((position.x < 0) || (position.y < 0) || (position.x > renderer->framebuffer.width) || (position.y > renderer->framebuffer.height)) {
-		return;
-	}
-	renderer->framebuffer.pixels[position.y * renderer->framebuffer.width + position.x] = color;
+	Plt_Renderer_Command_List *commands = renderer->recording_commands;
+	plt_assert(commands->draw_call_count < PLT_MAXIMUM_RENDERER_DRAW_CALLS, "Too many draw calls recorded this frame.\n");
+	commands->draw_calls[commands->draw_call_count++] = (Plt_Renderer_Draw_Call) {
+		.type = Plt_Renderer_Draw_Call_Type_Draw_Direct_Pixel,
+		.color = color,
+		.rect = plt_rect_make(position.x, position.y, 1, 1),
+		.depth = depth
+	};
 }
 
 void plt_renderer_direct_draw_colored_rect(Plt_Renderer *renderer, Plt_Rect rect, unsigned int depth, Plt_Color8 color) {
-
+	Plt_Renderer_Command_List *commands = renderer->recording_commands;
+	plt_assert(commands->draw_call_count < PLT_MAXIMUM_RENDERER_DRAW_CALLS, "Too many draw calls recorded this frame.\n");
+	commands->draw_calls[commands->draw_call_count++] = (Plt_Renderer_Draw_Call) {
+		.type = Plt_Renderer_Draw_Call_Type_Draw_Direct_Colored_Rect,
+		.color = color,
+		.rect = rect,
+		.depth = depth
+	};
 }
 
 void plt_renderer_direct_draw_texture(Plt_Renderer *renderer, Plt_Rect rect, unsigned int depth, Plt_Texture *texture) {
@@ -323,7 +676,9 @@ void plt_renderer_direct_draw_texture(Plt_Renderer *renderer, Plt_Rect rect, uns
 }
 
 void plt_renderer_direct_draw_texture_with_offset(Plt_Renderer *renderer, Plt_Rect rect, Plt_Vector2i texture_offset, unsigned int depth, Plt_Texture *texture) {
-	renderer->draw_calls[renderer->draw_call_count++] = (Plt_Renderer_Draw_Call) {
+	Plt_Renderer_Command_List *commands = renderer->recording_commands;
+	plt_assert(commands->draw_call_count < PLT_MAXIMUM_RENDERER_DRAW_CALLS, "Too many draw calls recorded this frame.\n");
+	commands->draw_calls[commands->draw_call_count++] = (Plt_Renderer_Draw_Call) {
 		.type = Plt_Renderer_Draw_Call_Type_Draw_Direct_Texture,
 		
 		.texture = texture,
@@ -336,45 +691,18 @@ void plt_renderer_direct_draw_texture_with_offset(Plt_Renderer *renderer, Plt_Re
 }
 
 void plt_renderer_direct_draw_scaled_texture(Plt_Renderer *renderer, Plt_Rect rect, unsigned int depth, Plt_Texture *texture) {
-	Plt_Vector2i bounds_min = {
-		plt_clamp(rect.x, 0, renderer->framebuffer.width),
-		plt_clamp(rect.y, 0, renderer->framebuffer.height)
-	};
-
-	Plt_Vector2i bounds_max = {
-		plt_clamp(rect.x + rect.width, 0, renderer->framebuffer.width),
-		plt_clamp(rect.y + rect.height, 0, renderer->framebuffer.height)
+	Plt_Renderer_Command_List *commands = renderer->recording_commands;
+	plt_assert(commands->draw_call_count < PLT_MAXIMUM_RENDERER_DRAW_CALLS, "Too many draw calls recorded this frame.\n");
+	commands->draw_calls[commands->draw_call_count++] = (Plt_Renderer_Draw_Call) {
+		.type = Plt_Renderer_Draw_Call_Type_Draw_Direct_Scaled_Texture,
+		
+		// Draws the bound texture, or a rect of the render color without one
+		.texture = renderer->bound_texture,
+		.color = renderer->render_color,
+		
+		.rect = rect,
+		.depth = depth
 	};
-
-	Plt_Color8 render_color = renderer->render_color;
-	Plt_Color8 *pixels = renderer->framebuffer.pixels;
-	unsigned int row_length = renderer->framebuffer.width;
-	
-	Plt_Texture *bound_texture = renderer->bound_texture;
-	
-	Plt_Vector2f p_inc = { 0.0f, 0.0f };
-	if (bound_texture) {
-		p_inc = (Plt_Vector2f){ 1.0f / (float)rect.width, 1.0f / (float)rect.height };
-	}
-	
-	Plt_Vector2f tex_pos = { 0.0f, 0.0f };
-	for (unsigned int y = bounds_min.y; y < bounds_max.y; ++y) {
-		tex_pos.x = 0.0f;
-		for (unsigned int x = bounds_min.x; x < bounds_max.x; ++x) {
-			
-			Plt_Color8 color;
-			if (bound_texture) {
-				color = plt_texture_sample(bound_texture, tex_pos);
-			} else {
-				color = render_color;
-			}
-			
-			pixels[y * row_length + x] = color;
-			
-			tex_pos.x += p_inc.x;
-		}
-		tex_pos.y += p_inc.y;
-	}
 }
 
 void plt_renderer_direct_draw_text(Plt_Renderer *renderer, Plt_Vector2i position, Plt_Font *font, const char *text) {
@@ -399,7 +727,9 @@ void plt_renderer_direct_draw_text(Plt_Renderer *renderer, Plt_Vector2i position
 }
 
 void plt_renderer_draw_mesh(Plt_Renderer *renderer, Plt_Mesh *mesh) {
-	renderer->draw_calls[renderer->draw_call_count++] = (Plt_Renderer_Draw_Call) {
+	Plt_Renderer_Command_List *commands = renderer->recording_commands;
+	plt_assert(commands->draw_call_count < PLT_MAXIMUM_RENDERER_DRAW_CALLS, "Too many draw calls recorded this frame.\n");
+	commands->draw_calls[commands->draw_call_count++] = (Plt_Renderer_Draw_Call) {
 		.type = Plt_Renderer_Draw_Call_Type_Draw_Mesh,
 		.primitive_type = renderer->primitive_type,
 		
@@ -409,76 +739,27 @@ void plt_renderer_draw_mesh(Plt_Renderer *renderer, Plt_Mesh *mesh) {
 		
 		.mesh = mesh,
 		.texture = renderer->bound_texture,
-		.color = renderer->render_color
+		.color = renderer->render_color,
+		.lighting_model = renderer->lighting_model,
+		.is_static = renderer->static_geometry,
+		.point_size = renderer->point_size
 	};
 }
 
 void plt_renderer_draw_billboard(Plt_Renderer *renderer, Plt_Vector2f size) {
-	Plt_Vector4f clipspace = plt_vector4f_make(0, 0, 0, 1);
-	clipspace = plt_matrix_multiply_vector4f(renderer->mvp_matrix, clipspace);
-	
-	if (clipspace.w < 0) {
-		// Behind camera, don't draw.
-		return;
-	}
-	
-	Plt_Vector3f ndc = plt_vector3f_make(clipspace.x / clipspace.w, clipspace.y / clipspace.w, clipspace.z / clipspace.w);
-	
-	Plt_Size framebuffer_size = plt_renderer_get_framebuffer_size(renderer);
-	Plt_Vector2i screen_space = plt_vector2i_make((ndc.x * 0.5f + 0.5f) * framebuffer_size.width, (ndc.y * 0.5f + 0.5f) * framebuffer_size.height);
-	
-	// TODO: Get camera FOV
-	float perspective_adjustment = sinf(plt_math_deg2rad(50.0f)) / clipspace.z;
-	Plt_Vector2f perspective_size = plt_vector2f_make(size.x * perspective_adjustment * 0.5f, size.y * perspective_adjustment * 0.5f);
-//	perspective_size = plt_vector2f_make(0.1f, 0.1f);
-	
-	Plt_Vector2i bounds_min = {
-		(perspective_size.x * -(int)framebuffer_size.width) + screen_space.x,
-		(perspective_size.x * -(int)framebuffer_size.width) + screen_space.y
-	};
-	Plt_Vector2i bounds_max = {
-		(perspective_size.x * framebuffer_size.width) + screen_space.x,
-		(perspective_size.x * framebuffer_size.width) + screen_space.y
-	};
-	
-	Plt_Texture *texture = renderer->bound_texture;
-	Plt_Vector2f p_inc = { 0.0f, 0.0f };
-	if (texture) {
-		p_inc = (Plt_Vector2f){ 1.0f / (float)(perspective_size.x * framebuffer_size.width * 2.0f), 1.0f / (float)(perspective_size.y * framebuffer_size.width * 2.0f) };
-	}
-	
-	Plt_Color8 *pixels = renderer->framebuffer.pixels;
-	float *depth_buffer = renderer->depth_buffer;
-	Plt_Color8 render_color = plt_color8_make(0, 255, 0, 255);
-	Plt_Vector2f tex_pos = { 0.0f, 0.0f };
-	
-	Plt_Vector2i clamped_bounds_min = {
-		plt_clamp(bounds_min.x, 0, framebuffer_size.width),
-		plt_clamp(bounds_min.y, 0, framebuffer_size.height)
-	};
-	Plt_Vector2i clamped_bounds_max = {
-		plt_clamp(bounds_max.x, 0, framebuffer_size.width),
-		plt_clamp(bounds_max.y, 0, framebuffer_size.height)
+	Plt_Renderer_Command_List *commands = renderer->recording_commands;
+	plt_assert(commands->draw_call_count < PLT_MAXIMUM_RENDERER_DRAW_CALLS, "Too many draw calls recorded this frame.\n");
+	commands->draw_calls[commands->draw_call_count++] = (Plt_Renderer_Draw_Call) {
+		.type = Plt_Renderer_Draw_Call_Type_Draw_Billboard,
+		
+		.model = renderer->model_matrix,
+		.view = renderer->view_matrix,
+		.projection = renderer->projection_matrix,
+		
+		.texture = renderer->bound_texture,
+		.color = renderer->render_color,
+		.billboard_size = size
 	};
-	
-	float initial_x = plt_max((clamped_bounds_min.x - bounds_min.x) * p_inc.x, 0);
-	tex_pos.y = plt_max((clamped_bounds_min.y - bounds_min.y) * p_inc.x, 0);
-	
-	for (int y = clamped_bounds_min.y; y < clamped_bounds_max.y; ++y) {
-		tex_pos.x = initial_x;
-		for (int x = clamped_bounds_min.x; x < clamped_bounds_max.x; ++x) {
-			Plt_Color8 c = plt_texture_sample(texture, tex_pos);
-			if (c.a > 0) {
-				float depth_sample = depth_buffer[y * framebuffer_size.width + x];
-				if (depth_sample > clipspace.z) {
-					depth_buffer[y * framebuffer_size.width + x] = clipspace.z;
-					pixels[y * framebuffer_size.width + x] = c;
-				}
-			}
-			tex_pos.x += p_inc.x;
-		}
-		tex_pos.y += p_inc.y;
-	}
 }
 
 void plt_renderer_draw_point(Plt_Renderer *renderer, Plt_Vector2f p, Plt_Color8 color) {
@@ -516,8 +797,18 @@ Plt_Vector2i plt_renderer_clipspace_to_pixel(Plt_Renderer *renderer, Plt_Vector2
 	};
 }
 
+unsigned int plt_renderer_get_dirty_rects(Plt_Renderer *renderer, Plt_Rect *rects, unsigned int max_rects) {
+	return plt_rasteriser_get_dirty_rects(renderer->triangle_rasteriser, rects, max_rects);
+}
+
+void plt_renderer_invalidate_framebuffer(Plt_Renderer *renderer) {
+	plt_rasteriser_invalidate_tiles(renderer->triangle_rasteriser);
+}
+
 void plt_renderer_present(Plt_Renderer *renderer) {
-	plt_application_present(renderer->application);
+	if (renderer->application) {
+		plt_application_present(renderer->application);
+	}
 }
 
 void plt_renderer_set_primitive_type(Plt_Renderer *renderer, Plt_Primitive_Type primitive_type) {
@@ -532,6 +823,10 @@ void plt_renderer_set_lighting_model(Plt_Renderer *renderer, Plt_Lighting_Model
 	renderer->lighting_model = model;
 }
 
+void plt_renderer_set_static_geometry(Plt_Renderer *renderer, bool static_geometry) {
+	renderer->static_geometry = static_geometry;
+}
+
 void plt_renderer_set_render_color(Plt_Renderer *renderer, Plt_Color8 color) {
 	renderer->render_color = color;
 }
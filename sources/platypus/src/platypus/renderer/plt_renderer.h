@@ -2,12 +2,22 @@
 #include "platypus/platypus.h"
 #include "platypus/framebuffer/plt_framebuffer.h"
 #include "platypus/base/allocation/plt_linear_allocator.h"
+#include "platypus/base/thread/plt_thread.h"
 
 #define PLT_MAXIMUM_RENDERER_DRAW_CALLS 2048
 
+// Static geometry is set up from a subset of one frame's draws, so its allocator is as large as a frame's.
+// Anything that fits drawn dynamically then fits captured as static geometry too
+#define PLT_RENDERER_FRAME_ALLOCATOR_SIZE (1024 * 1024 * 128) // 128MB
+#define PLT_RENDERER_STATIC_ALLOCATOR_SIZE PLT_RENDERER_FRAME_ALLOCATOR_SIZE
+
 typedef enum Plt_Renderer_Draw_Call_Type {
 	Plt_Renderer_Draw_Call_Type_Draw_Mesh,
-	Plt_Renderer_Draw_Call_Type_Draw_Direct_Texture
+	Plt_Renderer_Draw_Call_Type_Draw_Billboard,
+	Plt_Renderer_Draw_Call_Type_Draw_Direct_Texture,
+	Plt_Renderer_Draw_Call_Type_Draw_Direct_Colored_Rect,
+	Plt_Renderer_Draw_Call_Type_Draw_Direct_Pixel,
+	Plt_Renderer_Draw_Call_Type_Draw_Direct_Scaled_Texture
 } Plt_Renderer_Draw_Call_Type;
 
 typedef struct Plt_Renderer_Draw_Call {
@@ -21,22 +31,59 @@ typedef struct Plt_Renderer_Draw_Call {
 	Plt_Mesh *mesh;
 	Plt_Texture *texture;
 	Plt_Color8 color;
+	Plt_Lighting_Model lighting_model;
+	bool is_static;
+	unsigned int point_size;
+	Plt_Vector2f billboard_size;
 	
 	Plt_Rect rect;
 	Plt_Vector2i texture_offset;
 	unsigned int depth;
 } Plt_Renderer_Draw_Call;
 
+// Everything executing a frame reads, recorded on the calling thread then left untouched until
+// execution finishes, so the next frame can be recorded into the other list in the meantime
+typedef struct Plt_Renderer_Command_List {
+	// Transient pipeline data, lives as long as the list's execution
+	Plt_Linear_Allocator *frame_allocator;
+
+	Plt_Color8 clear_color;
+	Plt_Lighting_Setup lighting_setup;
+	Plt_Renderer_Debug_View debug_view;
+
+	unsigned int draw_call_count;
+	Plt_Renderer_Draw_Call draw_calls[PLT_MAXIMUM_RENDERER_DRAW_CALLS];
+} Plt_Renderer_Command_List;
+
+typedef enum Plt_Renderer_Stage {
+	Plt_Renderer_Stage_Vertex_Processor,
+	Plt_Renderer_Stage_Triangle_Processor,
+	Plt_Renderer_Stage_Rasteriser,
+	Plt_Renderer_Stage_Direct_Draw,
+	Plt_Renderer_Stage_Count
+} Plt_Renderer_Stage;
+
 typedef struct Plt_Vertex_Processor Plt_Vertex_Processor;
+typedef struct Plt_Point_Processor Plt_Point_Processor;
+typedef struct Plt_Billboard_Processor Plt_Billboard_Processor;
 typedef struct Plt_Triangle_Processor Plt_Triangle_Processor;
 typedef struct Plt_Triangle_Rasteriser Plt_Triangle_Rasteriser;
 typedef struct Plt_Renderer {
+	// NULL for headless renderers
 	Plt_Application *application;
 	Plt_Framebuffer framebuffer;
 
-	Plt_Linear_Allocator *frame_allocator;
+	// Pixels the renderer allocated itself, if any
+	Plt_Color8 *owned_pixels;
+
+	// Draws go into the recording list, plt_renderer_submit hands it over for execution
+	Plt_Renderer_Command_List command_lists[2];
+	Plt_Renderer_Command_List *recording_commands;
+	Plt_Renderer_Command_List *submitted_commands;
 
 	Plt_Vertex_Processor *vertex_processor;
+	Plt_Point_Processor *point_processor;
+	Plt_Billboard_Processor *billboard_processor;
 	Plt_Triangle_Processor *triangle_processor;
 	Plt_Triangle_Rasteriser *triangle_rasteriser;
 	
@@ -44,15 +91,33 @@ typedef struct Plt_Renderer {
 	unsigned int depth_buffer_width;
 	unsigned int depth_buffer_height;
 	
-	unsigned int draw_call_count;
-	Plt_Renderer_Draw_Call draw_calls[PLT_MAXIMUM_RENDERER_DRAW_CALLS];
+	// Static triangle draws the rasteriser's static bins were built from, their
+	// setup data lives in static_allocator until the bins are rebuilt
+	bool static_bins_valid;
+	Plt_Linear_Allocator *static_allocator;
+	Plt_Vector2i static_viewport;
+	Plt_Lighting_Setup static_lighting_setup;
+	unsigned int static_draw_call_count;
+	Plt_Renderer_Draw_Call static_draw_calls[PLT_MAXIMUM_RENDERER_DRAW_CALLS];
+	unsigned int static_mesh_revisions[PLT_MAXIMUM_RENDERER_DRAW_CALLS];
+	
+	// Accumulated while a frame executes, frame_timings and frame_stats are only updated once it finishes.
+	// Pipelined frames publish them from the render thread while the main thread records, under frame_results_mutex
+	uint64_t stage_ns[Plt_Renderer_Stage_Count];
+	unsigned int triangle_count;
+	Plt_Renderer_Stats stats;
+	Plt_Thread_Mutex *frame_results_mutex;
+	Plt_Renderer_Frame_Timings frame_timings;
+	Plt_Renderer_Stats frame_stats;
 	
 	Plt_Primitive_Type primitive_type;
 	unsigned int point_size;
 	Plt_Lighting_Model lighting_model;
+	bool static_geometry;
 	Plt_Color8 clear_color;
 	Plt_Color8 render_color;	
 	Plt_Lighting_Setup lighting_setup;
+	Plt_Renderer_Debug_View debug_view;
 	
 	Plt_Texture *bound_texture;
 	
@@ -63,8 +128,15 @@ typedef struct Plt_Renderer {
 } Plt_Renderer;
 
 Plt_Renderer *plt_renderer_create(Plt_Application *application, Plt_Framebuffer framebuffer);
-void plt_renderer_destroy(Plt_Renderer **renderer);
 
 void plt_renderer_update_framebuffer(Plt_Renderer *renderer, Plt_Framebuffer framebuffer);
 void plt_renderer_rasterise_triangles(Plt_Renderer *renderer);
-void plt_renderer_execute(Plt_Renderer *renderer);
+
+// Splits plt_renderer_execute so a frame can be executed on another thread while the next is recorded.
+// Only the framebuffer and rasteriser are touched while executing, never the recording state
+void plt_renderer_submit(Plt_Renderer *renderer);
+void plt_renderer_execute_submitted(Plt_Renderer *renderer);
+
+// Only tiles whose contents changed are redrawn, these report what changed in the last frame
+// and force a full redraw when the framebuffer contents were lost
+unsigned int plt_renderer_get_dirty_rects(Plt_Renderer *renderer, Plt_Rect *rects, unsigned int max_rects);
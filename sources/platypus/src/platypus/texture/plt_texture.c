@@ -1,34 +1,94 @@
-#include "platypus/platypus.h"
+#include "plt_texture.h"
 
+#include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include "platypus/base/plt_macros.h"
 #include "platypus/base/plt_platform.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "platypus/vendor/stb_image.h"
 
-typedef struct Plt_Texture {
-	Plt_Color8 *data;
+#if PLT_TEXTURE_BLOCK_SIZE != 4
+#error Tiled addressing in plt_texture.h needs to be updated for new block size
+#endif
 
-	Plt_Size size;
-	Plt_Vector2f texel_size;
+// Returns the number of texels needed to store a level of the given size and layout
+unsigned int plt_texture_get_level_storage(Plt_Texture_Layout layout, Plt_Size size, unsigned int *stride) {
+	if (layout == Plt_Texture_Layout_Tiled) {
+		unsigned int blocks_x = (size.width + PLT_TEXTURE_BLOCK_SIZE - 1) / PLT_TEXTURE_BLOCK_SIZE;
+		unsigned int blocks_y = (size.height + PLT_TEXTURE_BLOCK_SIZE - 1) / PLT_TEXTURE_BLOCK_SIZE;
+		*stride = blocks_x * PLT_TEXTURE_BLOCK_SIZE * PLT_TEXTURE_BLOCK_SIZE;
+		return *stride * blocks_y;
+	}
+
+	*stride = size.width;
+	return size.width * size.height;
+}
 
-	unsigned int row_length;
-} Plt_Texture;
+static inline bool plt_texture_is_size_power_of_two(Plt_Size size) {
+	return (size.width > 0) && (size.height > 0) && !(size.width & (size.width - 1)) && !(size.height & (size.height - 1));
+}
 
-Plt_Texture *plt_texture_create(Plt_Size size) {
-	Plt_Texture *texture = malloc(sizeof(Plt_Texture));
+// Fill in a level's addressing info, returns the number of texels it needs
+unsigned int plt_texture_init_mip_level(Plt_Texture *texture, Plt_Texture_Mip_Level *level, Plt_Color8 *data, Plt_Size size) {
+	level->data = data;
+	level->indices = NULL;
+	level->palette = texture->palette;
+	level->size = size;
+	level->format = texture->format;
+	level->layout = texture->layout;
+	level->address_mode = texture->address_mode;
+	level->power_of_two = plt_texture_is_size_power_of_two(size);
+	level->mask_x = size.width - 1;
+	level->mask_y = size.height - 1;
+	return plt_texture_get_level_storage(level->layout, size, &level->stride);
+}
+
+static unsigned int plt_texture_last_revision = 0;
+
+void plt_texture_bump_revision(Plt_Texture *texture) {
+	texture->revision = ++plt_texture_last_revision;
+}
 
+void plt_texture_reset_mip_levels(Plt_Texture *texture) {
+	plt_texture_bump_revision(texture);
+	texture->mip_level_count = 1;
+	plt_texture_init_mip_level(texture, &texture->mip_levels[0], texture->data, texture->size);
+	texture->mip_data = NULL;
+}
+
+void plt_texture_init_properties(Plt_Texture *texture, Plt_Size size, Plt_Color8 *data) {
 	texture->size = size;
 	texture->texel_size = plt_vector2f_make(1.0f / (float)size.width, 1.0f / (float)size.height);
 
 	texture->row_length = size.width * sizeof(Plt_Color8);
-	texture->data = malloc(texture->row_length * size.height);
+	texture->data = data;
+	texture->format = Plt_Texture_Format_Color8;
+	texture->index_data = NULL;
+	texture->palette = NULL;
+	texture->layout = Plt_Texture_Layout_Linear;
+	texture->address_mode = Plt_Texture_Address_Mode_Wrap;
+	texture->filter = Plt_Texture_Filter_Nearest;
+	texture->power_of_two = plt_texture_is_size_power_of_two(size);
+	plt_texture_reset_mip_levels(texture);
+}
+
+Plt_Texture *plt_texture_create(Plt_Size size) {
+	Plt_Texture *texture = malloc(sizeof(Plt_Texture));
+	plt_texture_init_properties(texture, size, malloc(sizeof(Plt_Color8) * size.width * size.height));
 
 	return texture;
 }
 
 void plt_texture_destroy(Plt_Texture **texture) {
+	if ((*texture)->mip_data) {
+		free((*texture)->mip_data);
+	}
+	if ((*texture)->index_data) {
+		free((*texture)->index_data);
+		free((*texture)->palette);
+	}
 	free((*texture)->data);
 	free(*texture);
 	*texture = NULL;
@@ -36,24 +96,25 @@ void plt_texture_destroy(Plt_Texture **texture) {
 
 Plt_Texture *plt_texture_create_with_bytes_nocopy(Plt_Size size, void *bytes) {
 	Plt_Texture *texture = malloc(sizeof(Plt_Texture));
-
-	texture->size = size;
-	texture->texel_size = plt_vector2f_make(1.0f / (float)size.width, 1.0f / (float)size.height);
-
-	texture->row_length = size.width * sizeof(Plt_Color8);
-	texture->data = bytes;
+	plt_texture_init_properties(texture, size, bytes);
 
 	return texture;
 }
 
 Plt_Texture *plt_texture_load(const char *path) {
+	return plt_texture_load_with_options(path, Plt_Texture_Option_None);
+}
+
+Plt_Texture *plt_texture_load_with_options(const char *path, Plt_Texture_Option options) {
 	Plt_Size size;
 	int channels;
 
+	plt_trace_begin("Load Texture");
 	Plt_Color8 *pixels = (Plt_Color8 *)stbi_load(path, (int *)&size.width, (int *)&size.height, &channels, 4);
 	plt_assert(pixels, "Failed loading texture from path.\n");
 
 	if (!pixels) {
+		plt_trace_end("Load Texture");
 		return NULL;
 	}
 	
@@ -63,46 +124,450 @@ Plt_Texture *plt_texture_load(const char *path) {
 		pixels[i] = (Plt_Color8){p.r, p.g, p.b, p.a};
 	}
 
-	return plt_texture_create_with_bytes_nocopy(size, pixels);
+	Plt_Texture *texture = plt_texture_create_with_bytes_nocopy(size, pixels);
+	if (options & Plt_Texture_Option_Tiled) {
+		plt_texture_convert_layout(texture, Plt_Texture_Layout_Tiled);
+	}
+	plt_texture_generate_mipmaps(texture);
+	if (options & Plt_Texture_Option_Palettised) {
+		plt_texture_palettise(texture);
+	}
+	plt_trace_end("Load Texture");
+	return texture;
+}
+
+void plt_texture_convert_layout(Plt_Texture *texture, Plt_Texture_Layout layout) {
+	plt_assert(texture->format == Plt_Texture_Format_Color8, "Palettised textures can't change layout.\n");
+	if (texture->layout == layout) {
+		return;
+	}
+
+	Plt_Texture_Mip_Level source = texture->mip_levels[0];
+
+	unsigned int stride;
+	unsigned int storage = plt_texture_get_level_storage(layout, texture->size, &stride);
+	Plt_Color8 *data = malloc(sizeof(Plt_Color8) * storage);
+	memset(data, 0, sizeof(Plt_Color8) * storage);
+
+	Plt_Texture_Mip_Level destination = { .data = data, .size = texture->size, .layout = layout, .stride = stride };
+	for (unsigned int y = 0; y < texture->size.height; ++y) {
+		for (unsigned int x = 0; x < texture->size.width; ++x) {
+			destination.data[plt_texture_mip_level_get_index(&destination, x, y)] = source.data[plt_texture_mip_level_get_index(&source, x, y)];
+		}
+	}
+
+	free(texture->data);
+	texture->data = data;
+	texture->layout = layout;
+
+	bool had_mipmaps = texture->mip_level_count > 1;
+	if (texture->mip_data) {
+		free(texture->mip_data);
+	}
+	plt_texture_reset_mip_levels(texture);
+	if (had_mipmaps) {
+		plt_texture_generate_mipmaps(texture);
+	}
+}
+
+void plt_texture_generate_mipmaps(Plt_Texture *texture) {
+	plt_assert(texture->format == Plt_Texture_Format_Color8, "Palettised textures can't regenerate their mip chain.\n");
+	if (texture->mip_data) {
+		free(texture->mip_data);
+	}
+	plt_texture_reset_mip_levels(texture);
+
+	// Size the whole chain up front so every level lives in a single allocation
+	unsigned int level_count = 1;
+	unsigned int chain_pixel_count = 0;
+	Plt_Size level_size = texture->size;
+	while (((level_size.width > 1) || (level_size.height > 1)) && (level_count < PLT_TEXTURE_MAX_MIP_LEVELS)) {
+		unsigned int stride;
+		level_size = plt_size_make(plt_max(level_size.width / 2, 1), plt_max(level_size.height / 2, 1));
+		chain_pixel_count += plt_texture_get_level_storage(texture->layout, level_size, &stride);
+		++level_count;
+	}
+
+	if (level_count == 1) {
+		return;
+	}
+
+	texture->mip_data = malloc(sizeof(Plt_Color8) * chain_pixel_count);
+	memset(texture->mip_data, 0, sizeof(Plt_Color8) * chain_pixel_count);
+
+	// Box filter each level from the one above it
+	Plt_Color8 *level_data = texture->mip_data;
+	for (unsigned int l = 1; l < level_count; ++l) {
+		const Plt_Texture_Mip_Level *source = &texture->mip_levels[l - 1];
+		Plt_Texture_Mip_Level *level = &texture->mip_levels[l];
+		level_data += plt_texture_init_mip_level(texture, level, level_data, plt_size_make(plt_max(source->size.width / 2, 1), plt_max(source->size.height / 2, 1)));
+
+		for (unsigned int y = 0; y < level->size.height; ++y) {
+			unsigned int y0 = plt_min(y * 2, source->size.height - 1);
+			unsigned int y1 = plt_min(y * 2 + 1, source->size.height - 1);
+			for (unsigned int x = 0; x < level->size.width; ++x) {
+				unsigned int x0 = plt_min(x * 2, source->size.width - 1);
+				unsigned int x1 = plt_min(x * 2 + 1, source->size.width - 1);
+				Plt_Color8 a = source->data[plt_texture_mip_level_get_index(source, x0, y0)];
+				Plt_Color8 b = source->data[plt_texture_mip_level_get_index(source, x1, y0)];
+				Plt_Color8 c = source->data[plt_texture_mip_level_get_index(source, x0, y1)];
+				Plt_Color8 d = source->data[plt_texture_mip_level_get_index(source, x1, y1)];
+				level->data[plt_texture_mip_level_get_index(level, x, y)] = (Plt_Color8) {
+					.b = (a.b + b.b + c.b + d.b + 2) >> 2,
+					.g = (a.g + b.g + c.g + d.g + 2) >> 2,
+					.r = (a.r + b.r + c.r + d.r + 2) >> 2,
+					.a = (a.a + b.a + c.a + d.a + 2) >> 2
+				};
+			}
+		}
+	}
+	texture->mip_level_count = level_count;
+}
+
+unsigned int plt_texture_get_mip_level_count(Plt_Texture *texture) {
+	return texture->mip_level_count;
+}
+
+// MARK: Palettisation
+
+typedef struct Plt_Texture_Palette_Entry {
+	Plt_Color8 color;
+
+	// Position of the texel in index_data
+	unsigned int texel;
+} Plt_Texture_Palette_Entry;
+
+// A median cut box, a contiguous run of entries that becomes one palette colour
+typedef struct Plt_Texture_Palette_Box {
+	unsigned int start;
+	unsigned int count;
+
+	// Channel (0 = b, 1 = g, 2 = r, 3 = a) with the widest range and that range
+	unsigned int channel;
+	int range;
+} Plt_Texture_Palette_Box;
+
+static inline int plt_texture_palette_channel(Plt_Color8 color, unsigned int channel) {
+	switch (channel) {
+		case 0: return color.b;
+		case 1: return color.g;
+		case 2: return color.r;
+		default: return color.a;
+	}
+}
+
+#define PLT_TEXTURE_DEFINE_PALETTE_COMPARE(channel, field) \
+static int plt_texture_palette_compare_##channel(const void *a, const void *b) { \
+	return (int)((const Plt_Texture_Palette_Entry *)a)->color.field - (int)((const Plt_Texture_Palette_Entry *)b)->color.field; \
+}
+
+PLT_TEXTURE_DEFINE_PALETTE_COMPARE(0, b)
+PLT_TEXTURE_DEFINE_PALETTE_COMPARE(1, g)
+PLT_TEXTURE_DEFINE_PALETTE_COMPARE(2, r)
+PLT_TEXTURE_DEFINE_PALETTE_COMPARE(3, a)
+
+static void plt_texture_palette_measure_box(const Plt_Texture_Palette_Entry *entries, Plt_Texture_Palette_Box *box) {
+	int min[4] = { 255, 255, 255, 255 };
+	int max[4] = { 0, 0, 0, 0 };
+	for (unsigned int i = box->start; i < box->start + box->count; ++i) {
+		for (unsigned int c = 0; c < 4; ++c) {
+			int value = plt_texture_palette_channel(entries[i].color, c);
+			min[c] = plt_min(min[c], value);
+			max[c] = plt_max(max[c], value);
+		}
+	}
+
+	box->channel = 0;
+	box->range = max[0] - min[0];
+	for (unsigned int c = 1; c < 4; ++c) {
+		if (max[c] - min[c] > box->range) {
+			box->channel = c;
+			box->range = max[c] - min[c];
+		}
+	}
+}
+
+void plt_texture_palettise(Plt_Texture *texture) {
+	if (texture->format == Plt_Texture_Format_Indexed8) {
+		return;
+	}
+
+	// Index storage mirrors the texel storage of every level
+	unsigned int level_offsets[PLT_TEXTURE_MAX_MIP_LEVELS];
+	unsigned int storage = 0;
+	unsigned int texel_count = 0;
+	for (unsigned int l = 0; l < texture->mip_level_count; ++l) {
+		unsigned int stride;
+		level_offsets[l] = storage;
+		storage += plt_texture_get_level_storage(texture->layout, texture->mip_levels[l].size, &stride);
+		texel_count += texture->mip_levels[l].size.width * texture->mip_levels[l].size.height;
+	}
+
+	Plt_Texture_Palette_Entry *entries = malloc(sizeof(Plt_Texture_Palette_Entry) * texel_count);
+	unsigned int entry_count = 0;
+	for (unsigned int l = 0; l < texture->mip_level_count; ++l) {
+		const Plt_Texture_Mip_Level *level = &texture->mip_levels[l];
+		for (unsigned int y = 0; y < level->size.height; ++y) {
+			for (unsigned int x = 0; x < level->size.width; ++x) {
+				unsigned int index = plt_texture_mip_level_get_index(level, x, y);
+				entries[entry_count++] = (Plt_Texture_Palette_Entry){ level->data[index], level_offsets[l] + index };
+			}
+		}
+	}
+
+	// Median cut: keep splitting the box with the widest channel range. Splits land on a change
+	// of value so equal colours stay together, textures with few enough colours are stored exactly
+	static int (*const compare[4])(const void *, const void *) = {
+		plt_texture_palette_compare_0, plt_texture_palette_compare_1, plt_texture_palette_compare_2, plt_texture_palette_compare_3
+	};
+
+	Plt_Texture_Palette_Box boxes[PLT_TEXTURE_PALETTE_SIZE];
+	unsigned int box_count = 1;
+	boxes[0] = (Plt_Texture_Palette_Box){ .start = 0, .count = entry_count };
+	plt_texture_palette_measure_box(entries, &boxes[0]);
+
+	while (box_count < PLT_TEXTURE_PALETTE_SIZE) {
+		unsigned int widest = 0;
+		for (unsigned int b = 1; b < box_count; ++b) {
+			if (boxes[b].range > boxes[widest].range) {
+				widest = b;
+			}
+		}
+
+		Plt_Texture_Palette_Box *box = &boxes[widest];
+		if (box->range == 0) {
+			break;
+		}
+
+		Plt_Texture_Palette_Entry *box_entries = entries + box->start;
+		qsort(box_entries, box->count, sizeof(Plt_Texture_Palette_Entry), compare[box->channel]);
+
+		// Nearest change of value to the median on either side
+		unsigned int lower = box->count / 2;
+		while ((lower > 0) && (plt_texture_palette_channel(box_entries[lower - 1].color, box->channel) == plt_texture_palette_channel(box_entries[lower].color, box->channel))) {
+			--lower;
+		}
+		unsigned int upper = box->count / 2;
+		while ((upper < box->count) && (plt_texture_palette_channel(box_entries[upper - 1].color, box->channel) == plt_texture_palette_channel(box_entries[upper].color, box->channel))) {
+			++upper;
+		}
+		unsigned int split = ((lower == 0) || ((upper < box->count) && (upper - box->count / 2 < box->count / 2 - lower))) ? upper : lower;
+
+		boxes[box_count] = (Plt_Texture_Palette_Box){ .start = box->start + split, .count = box->count - split };
+		box->count = split;
+		plt_texture_palette_measure_box(entries, box);
+		plt_texture_palette_measure_box(entries, &boxes[box_count]);
+		++box_count;
+	}
+
+	// Each box becomes the average of its colours
+	texture->palette = malloc(sizeof(Plt_Color8) * PLT_TEXTURE_PALETTE_SIZE);
+	memset(texture->palette, 0, sizeof(Plt_Color8) * PLT_TEXTURE_PALETTE_SIZE);
+	texture->index_data = malloc(storage);
+	memset(texture->index_data, 0, storage);
+	for (unsigned int b = 0; b < box_count; ++b) {
+		unsigned int sum[4] = { 0, 0, 0, 0 };
+		for (unsigned int i = boxes[b].start; i < boxes[b].start + boxes[b].count; ++i) {
+			sum[0] += entries[i].color.b;
+			sum[1] += entries[i].color.g;
+			sum[2] += entries[i].color.r;
+			sum[3] += entries[i].color.a;
+			texture->index_data[entries[i].texel] = b;
+		}
+
+		unsigned int count = plt_max(boxes[b].count, 1);
+		texture->palette[b] = (Plt_Color8) {
+			.b = (sum[0] + count / 2) / count,
+			.g = (sum[1] + count / 2) / count,
+			.r = (sum[2] + count / 2) / count,
+			.a = (sum[3] + count / 2) / count
+		};
+	}
+	free(entries);
+
+	// Drop the BGRA texels, levels now decode through the palette
+	free(texture->data);
+	if (texture->mip_data) {
+		free(texture->mip_data);
+	}
+	texture->data = NULL;
+	texture->mip_data = NULL;
+	texture->format = Plt_Texture_Format_Indexed8;
+	for (unsigned int l = 0; l < texture->mip_level_count; ++l) {
+		Plt_Texture_Mip_Level *level = &texture->mip_levels[l];
+		level->data = NULL;
+		level->indices = texture->index_data + level_offsets[l];
+		level->palette = texture->palette;
+		level->format = Plt_Texture_Format_Indexed8;
+	}
+	plt_texture_bump_revision(texture);
+}
+
+bool plt_texture_is_palettised(Plt_Texture *texture) {
+	return texture->format == Plt_Texture_Format_Indexed8;
+}
+
+unsigned int plt_texture_select_mip_level(Plt_Texture *texture, Plt_Vector2f uv_dx, Plt_Vector2f uv_dy) {
+	if (texture->mip_level_count == 1) {
+		return 0;
+	}
+
+	// Footprint of a pixel in level 0 texels
+	float dx_u = uv_dx.x * texture->size.width, dx_v = uv_dx.y * texture->size.height;
+	float dy_u = uv_dy.x * texture->size.width, dy_v = uv_dy.y * texture->size.height;
+	float footprint = fmaxf(dx_u * dx_u + dx_v * dx_v, dy_u * dy_u + dy_v * dy_v);
+	if (!(footprint > 1.0f)) {
+		return 0;
+	}
+
+	// log2 of the squared footprint is twice the LOD, round to the nearest level
+	int level = (int)(0.5f * log2f(footprint) + 0.5f);
+	return plt_min((unsigned int)level, texture->mip_level_count - 1);
 }
 
 inline Plt_Color8 plt_texture_get_pixel(Plt_Texture *texture, Plt_Vector2i pos) {
-	return texture->data[(pos.y % texture->size.height) * texture->size.width + (pos.x % texture->size.width)];
+	return plt_texture_mip_level_get_pixel(&texture->mip_levels[0], pos);
 }
 
 inline void plt_texture_set_pixel(Plt_Texture *texture, Plt_Vector2i pos, Plt_Color8 value) {
-	pos.x = pos.x % texture->size.width;
-	pos.y = pos.y % texture->size.height;
-	texture->data[pos.y * texture->size.width + pos.x] = value;
+	plt_assert(texture->format == Plt_Texture_Format_Color8, "Palettised textures are read-only.\n");
+	unsigned int x = plt_texture_address_wrap(pos.x, texture->size.width, 0);
+	unsigned int y = plt_texture_address_wrap(pos.y, texture->size.height, 0);
+	texture->data[plt_texture_mip_level_get_index(&texture->mip_levels[0], x, y)] = value;
+	plt_texture_bump_revision(texture);
+}
+
+void plt_texture_copy_row(Plt_Texture *texture, Plt_Vector2i pos, unsigned int length, Plt_Color8 *destination) {
+	const Plt_Texture_Mip_Level *level = &texture->mip_levels[0];
+	unsigned int x = plt_texture_address_wrap(pos.x, level->size.width, 0);
+	unsigned int y = plt_texture_address_wrap(pos.y, level->size.height, 0);
+
+	if (level->format == Plt_Texture_Format_Indexed8) {
+		// Decode through the palette a texel at a time
+		for (unsigned int i = 0; i < length; ++i) {
+			destination[i] = plt_texture_texel_indexed8(level, plt_texture_mip_level_get_index(level, x, y));
+			x = (x + 1 == level->size.width) ? 0 : x + 1;
+		}
+		return;
+	}
+
+	if (level->layout == Plt_Texture_Layout_Linear) {
+		Plt_Color8 *row = level->data + y * level->stride;
+		while (length) {
+			unsigned int run = plt_min(length, level->size.width - x);
+			memcpy(destination, row + x, sizeof(Plt_Color8) * run);
+			destination += run;
+			length -= run;
+			x = 0;
+		}
+		return;
+	}
+
+	// Unswizzle one block row at a time, each block contributes a contiguous run of texels
+	Plt_Color8 *block_row = level->data + (y >> 2) * level->stride + ((y & 3) << 2);
+	while (length) {
+		unsigned int run = plt_min(plt_min(length, PLT_TEXTURE_BLOCK_SIZE - (x & 3)), level->size.width - x);
+		memcpy(destination, block_row + ((x >> 2) << 4) + (x & 3), sizeof(Plt_Color8) * run);
+		destination += run;
+		length -= run;
+		x += run;
+		if (x == level->size.width) {
+			x = 0;
+		}
+	}
+}
+
+Plt_Color8 plt_texture_mip_level_sample(const Plt_Texture_Mip_Level *level, Plt_Texture_Filter filter, float x, float y) {
+	if (filter == Plt_Texture_Filter_Nearest) {
+		return plt_texture_mip_level_get_pixel(level, (Plt_Vector2i){ x, y });
+	}
+
+	int fixed_x = (int)(x * 256.0f) - 128;
+	int fixed_y = (int)(y * 256.0f) - 128;
+	unsigned int x0 = plt_texture_mip_level_address(level, fixed_x >> 8, level->size.width, level->mask_x);
+	unsigned int x1 = plt_texture_mip_level_address(level, (fixed_x >> 8) + 1, level->size.width, level->mask_x);
+	unsigned int y0 = plt_texture_mip_level_address(level, fixed_y >> 8, level->size.height, level->mask_y);
+	unsigned int y1 = plt_texture_mip_level_address(level, (fixed_y >> 8) + 1, level->size.height, level->mask_y);
+	simd_int4 texels = simd_int4_create(
+		plt_texture_texel_bits(plt_texture_mip_level_get_texel(level, plt_texture_mip_level_get_index(level, x0, y0))),
+		plt_texture_texel_bits(plt_texture_mip_level_get_texel(level, plt_texture_mip_level_get_index(level, x1, y0))),
+		plt_texture_texel_bits(plt_texture_mip_level_get_texel(level, plt_texture_mip_level_get_index(level, x0, y1))),
+		plt_texture_texel_bits(plt_texture_mip_level_get_texel(level, plt_texture_mip_level_get_index(level, x1, y1)))
+	);
+	return plt_texture_texel_from_bits(simd_int4_bilinear_u8(texels, fixed_x & 0xFF, fixed_y & 0xFF));
 }
 
 Plt_Color8 plt_texture_sample(Plt_Texture *texture, Plt_Vector2f pos) {
-	Plt_Vector2i pixel_pos = { pos.x * texture->size.width, pos.y * texture->size.height };
-	return plt_texture_get_pixel(texture, pixel_pos);
+	if (texture->filter == Plt_Texture_Filter_Nearest) {
+		Plt_Vector2i pixel_pos = { pos.x * texture->size.width, pos.y * texture->size.height };
+		return plt_texture_get_pixel(texture, pixel_pos);
+	}
+	return plt_texture_mip_level_sample(&texture->mip_levels[0], texture->filter, pos.x * texture->size.width, pos.y * texture->size.height);
 }
 
 void plt_texture_clear(Plt_Texture *texture, Plt_Color8 value) {
+	plt_assert(texture->format == Plt_Texture_Format_Color8, "Palettised textures are read-only.\n");
 #ifdef PLT_PLATFORM_MACOS
 	// Fast path
-	memset_pattern4(texture->data, &value, sizeof(Plt_Color8) * texture->size.width * texture->size.height);
+	unsigned int stride;
+	memset_pattern4(texture->data, &value, sizeof(Plt_Color8) * plt_texture_get_level_storage(texture->layout, texture->size, &stride));
 #else
 	// Slow path
 	Plt_Color8 *pixels = texture->data;
-	unsigned int total_pixels = texture->size.width * texture->size.height;
+	unsigned int stride;
+	unsigned int total_pixels = plt_texture_get_level_storage(texture->layout, texture->size, &stride);
 	for (unsigned int i = 0; i < total_pixels; ++i) {
 		pixels[i] = value;
 	}
 #endif
+	plt_texture_bump_revision(texture);
 }
 
 Plt_Size plt_texture_get_size(Plt_Texture *texture) {
 	return texture->size;
 }
 
+bool plt_texture_is_power_of_two(Plt_Texture *texture) {
+	return texture->power_of_two;
+}
+
+void plt_texture_set_address_mode(Plt_Texture *texture, Plt_Texture_Address_Mode mode) {
+	texture->address_mode = mode;
+	for (unsigned int i = 0; i < texture->mip_level_count; ++i) {
+		texture->mip_levels[i].address_mode = mode;
+	}
+	plt_texture_bump_revision(texture);
+}
+
+Plt_Texture_Address_Mode plt_texture_get_address_mode(Plt_Texture *texture) {
+	return texture->address_mode;
+}
+
+void plt_texture_set_filter(Plt_Texture *texture, Plt_Texture_Filter filter) {
+	texture->filter = filter;
+	plt_texture_bump_revision(texture);
+}
+
+Plt_Texture_Filter plt_texture_get_filter(Plt_Texture *texture) {
+	return texture->filter;
+}
+
 Plt_Vector2f plt_texture_get_texel_size(Plt_Texture *texture) {
 	return texture->texel_size;
 }
 
 Plt_Color8 *plt_texture_get_pixels(Plt_Texture *texture) {
+	// Callers may write through the pointer
+	plt_texture_bump_revision(texture);
 	return texture->data;
 }
+
+void plt_texture_mark_modified(Plt_Texture *texture) {
+	plt_assert(texture->format == Plt_Texture_Format_Color8, "Palettised textures are read-only.\n");
+	if (texture->mip_level_count > 1) {
+		// Bumps the revision too
+		plt_texture_generate_mipmaps(texture);
+	} else {
+		plt_texture_bump_revision(texture);
+	}
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "platypus/platypus.h"
+#include "platypus/base/plt_simd.h"
+
+// Enough levels for a 32768x32768 texture
+#define PLT_TEXTURE_MAX_MIP_LEVELS 16
+
+// Tiled textures store texels in square blocks of this size (4x4 BGRA = one 64 byte cache line)
+#define PLT_TEXTURE_BLOCK_SIZE 4
+
+typedef enum Plt_Texture_Layout {
+	// Row-major texels
+	Plt_Texture_Layout_Linear,
+
+	// Row-major blocks of PLT_TEXTURE_BLOCK_SIZE x PLT_TEXTURE_BLOCK_SIZE row-major texels, padded to whole blocks
+	Plt_Texture_Layout_Tiled
+} Plt_Texture_Layout;
+
+// Palettised textures index into this many colours
+#define PLT_TEXTURE_PALETTE_SIZE 256
+
+typedef enum Plt_Texture_Format {
+	// 32-bit BGRA texels
+	Plt_Texture_Format_Color8,
+
+	// 8-bit indices into a palette of PLT_TEXTURE_PALETTE_SIZE BGRA colours
+	Plt_Texture_Format_Indexed8
+} Plt_Texture_Format;
+
+typedef struct Plt_Texture_Mip_Level {
+	// Texels are either BGRA data or indices into the palette, depending on format
+	Plt_Color8 *data;
+	unsigned char *indices;
+	const Plt_Color8 *palette;
+
+	Plt_Size size;
+	Plt_Texture_Format format;
+	Plt_Texture_Layout layout;
+	Plt_Texture_Address_Mode address_mode;
+
+	// Texels per row (linear) or per row of blocks (tiled)
+	unsigned int stride;
+
+	// Wrapping power-of-two levels masks coordinates with these instead of using modulo
+	bool power_of_two;
+	unsigned int mask_x;
+	unsigned int mask_y;
+} Plt_Texture_Mip_Level;
+
+typedef struct Plt_Texture {
+	Plt_Color8 *data;
+
+	Plt_Size size;
+	Plt_Vector2f texel_size;
+
+	unsigned int row_length;
+	Plt_Texture_Format format;
+	Plt_Texture_Layout layout;
+	Plt_Texture_Address_Mode address_mode;
+	Plt_Texture_Filter filter;
+
+	// Tagged at creation, every level of a power-of-two texture is also power-of-two
+	bool power_of_two;
+
+	// Level 0 always points at data, smaller levels live in mip_data
+	unsigned int mip_level_count;
+	Plt_Texture_Mip_Level mip_levels[PLT_TEXTURE_MAX_MIP_LEVELS];
+	Plt_Color8 *mip_data;
+
+	// Palettised textures drop data and mip_data, every level's indices live in index_data
+	unsigned char *index_data;
+	Plt_Color8 *palette;
+
+	// Unique across every texture ever created and bumped on each edit, lets caches spot stale texels
+	unsigned int revision;
+} Plt_Texture;
+
+void plt_texture_bump_revision(Plt_Texture *texture);
+
+// Re-store level 0 in the given layout, regenerating any mip chain in the same layout
+void plt_texture_convert_layout(Plt_Texture *texture, Plt_Texture_Layout layout);
+
+// Select the mip level for a footprint with the given UV derivatives (in UV units per pixel)
+unsigned int plt_texture_select_mip_level(Plt_Texture *texture, Plt_Vector2f uv_dx, Plt_Vector2f uv_dy);
+
+// Copy a row of texels starting at pos into destination in row-major order, wrapping horizontally
+void plt_texture_copy_row(Plt_Texture *texture, Plt_Vector2i pos, unsigned int length, Plt_Color8 *destination);
+
+// MARK: Addressing
+
+// Every address function takes (coordinate, level size, level mask) so samplers can be generated for any of them
+
+static inline unsigned int plt_texture_address_wrap_power_of_two(int coord, unsigned int size, unsigned int mask) {
+	return (unsigned int)coord & mask;
+}
+
+static inline unsigned int plt_texture_address_wrap(int coord, unsigned int size, unsigned int mask) {
+	int wrapped = coord % (int)size;
+	return (wrapped < 0) ? wrapped + size : wrapped;
+}
+
+static inline unsigned int plt_texture_address_clamp(int coord, unsigned int size, unsigned int mask) {
+	return (coord < 0) ? 0 : plt_min((unsigned int)coord, size - 1);
+}
+
+static inline unsigned int plt_texture_index_linear(const Plt_Texture_Mip_Level *level, unsigned int x, unsigned int y) {
+	return y * level->stride + x;
+}
+
+static inline unsigned int plt_texture_index_tiled(const Plt_Texture_Mip_Level *level, unsigned int x, unsigned int y) {
+	return (y >> 2) * level->stride + ((x >> 2) << 4) + ((y & 3) << 2) + (x & 3);
+}
+
+static inline unsigned int plt_texture_mip_level_get_index(const Plt_Texture_Mip_Level *level, unsigned int x, unsigned int y) {
+	if (level->layout == Plt_Texture_Layout_Tiled) {
+		return plt_texture_index_tiled(level, x, y);
+	}
+	return plt_texture_index_linear(level, x, y);
+}
+
+static inline Plt_Color8 plt_texture_texel_color8(const Plt_Texture_Mip_Level *level, unsigned int index) {
+	return level->data[index];
+}
+
+static inline Plt_Color8 plt_texture_texel_indexed8(const Plt_Texture_Mip_Level *level, unsigned int index) {
+	return level->palette[level->indices[index]];
+}
+
+static inline Plt_Color8 plt_texture_mip_level_get_texel(const Plt_Texture_Mip_Level *level, unsigned int index) {
+	if (level->format == Plt_Texture_Format_Indexed8) {
+		return plt_texture_texel_indexed8(level, index);
+	}
+	return plt_texture_texel_color8(level, index);
+}
+
+typedef union Plt_Texture_Texel_Bits {
+	Plt_Color8 color;
+	int bits;
+} Plt_Texture_Texel_Bits;
+
+static inline int plt_texture_texel_bits(Plt_Color8 color) {
+	return (Plt_Texture_Texel_Bits){ .color = color }.bits;
+}
+
+static inline Plt_Color8 plt_texture_texel_from_bits(unsigned int bits) {
+	return (Plt_Texture_Texel_Bits){ .bits = bits }.color;
+}
+
+// MARK: Specialised samplers, raster kernels pick one per texture to keep the pixel loop branch and division free
+
+// Defines plt_texture_fetch_<suffix> (integer texel) and plt_texture_sample_{nearest,bilinear}_<suffix>
+// (texel space coordinates, texel centres at +0.5) for one address mode, layout and texel format
+#define PLT_TEXTURE_DEFINE_SAMPLERS(suffix, ADDRESS, INDEX, TEXEL) \
+static inline Plt_Color8 plt_texture_fetch_##suffix(const Plt_Texture_Mip_Level *level, Plt_Vector2i pos) { \
+	return TEXEL(level, INDEX(level, ADDRESS(pos.x, level->size.width, level->mask_x), ADDRESS(pos.y, level->size.height, level->mask_y))); \
+} \
+\
+static inline Plt_Color8 plt_texture_sample_nearest_##suffix(const Plt_Texture_Mip_Level *level, float x, float y) { \
+	return plt_texture_fetch_##suffix(level, (Plt_Vector2i){ x, y }); \
+} \
+\
+static inline Plt_Color8 plt_texture_sample_bilinear_##suffix(const Plt_Texture_Mip_Level *level, float x, float y) { \
+	int fixed_x = (int)(x * 256.0f) - 128; \
+	int fixed_y = (int)(y * 256.0f) - 128; \
+	unsigned int x0 = ADDRESS(fixed_x >> 8, level->size.width, level->mask_x); \
+	unsigned int x1 = ADDRESS((fixed_x >> 8) + 1, level->size.width, level->mask_x); \
+	unsigned int y0 = ADDRESS(fixed_y >> 8, level->size.height, level->mask_y); \
+	unsigned int y1 = ADDRESS((fixed_y >> 8) + 1, level->size.height, level->mask_y); \
+	simd_int4 texels = simd_int4_create( \
+		plt_texture_texel_bits(TEXEL(level, INDEX(level, x0, y0))), plt_texture_texel_bits(TEXEL(level, INDEX(level, x1, y0))), \
+		plt_texture_texel_bits(TEXEL(level, INDEX(level, x0, y1))), plt_texture_texel_bits(TEXEL(level, INDEX(level, x1, y1))) \
+	); \
+	return plt_texture_texel_from_bits(simd_int4_bilinear_u8(texels, fixed_x & 0xFF, fixed_y & 0xFF)); \
+}
+
+// Defines samplers for every address mode and layout of one texel format, suffixed <address>_<layout>_<format>
+#define PLT_TEXTURE_DEFINE_FORMAT_SAMPLERS(format, TEXEL) \
+PLT_TEXTURE_DEFINE_SAMPLERS(wrap_power_of_two_linear_##format, plt_texture_address_wrap_power_of_two, plt_texture_index_linear, TEXEL) \
+PLT_TEXTURE_DEFINE_SAMPLERS(wrap_power_of_two_tiled_##format, plt_texture_address_wrap_power_of_two, plt_texture_index_tiled, TEXEL) \
+PLT_TEXTURE_DEFINE_SAMPLERS(wrap_linear_##format, plt_texture_address_wrap, plt_texture_index_linear, TEXEL) \
+PLT_TEXTURE_DEFINE_SAMPLERS(wrap_tiled_##format, plt_texture_address_wrap, plt_texture_index_tiled, TEXEL) \
+PLT_TEXTURE_DEFINE_SAMPLERS(clamp_linear_##format, plt_texture_address_clamp, plt_texture_index_linear, TEXEL) \
+PLT_TEXTURE_DEFINE_SAMPLERS(clamp_tiled_##format, plt_texture_address_clamp, plt_texture_index_tiled, TEXEL)
+
+PLT_TEXTURE_DEFINE_FORMAT_SAMPLERS(color8, plt_texture_texel_color8)
+PLT_TEXTURE_DEFINE_FORMAT_SAMPLERS(indexed8, plt_texture_texel_indexed8)
+
+// MARK: Generic sampling honouring the level's address mode and layout
+
+static inline unsigned int plt_texture_mip_level_address(const Plt_Texture_Mip_Level *level, int coord, unsigned int size, unsigned int mask) {
+	if (level->address_mode == Plt_Texture_Address_Mode_Clamp) {
+		return plt_texture_address_clamp(coord, size, mask);
+	} else if (level->power_of_two) {
+		return plt_texture_address_wrap_power_of_two(coord, size, mask);
+	}
+	return plt_texture_address_wrap(coord, size, mask);
+}
+
+static inline Plt_Color8 plt_texture_mip_level_get_pixel(const Plt_Texture_Mip_Level *level, Plt_Vector2i pos) {
+	unsigned int x = plt_texture_mip_level_address(level, pos.x, level->size.width, level->mask_x);
+	unsigned int y = plt_texture_mip_level_address(level, pos.y, level->size.height, level->mask_y);
+	return plt_texture_mip_level_get_texel(level, plt_texture_mip_level_get_index(level, x, y));
+}
+
+// Sample at texel space coordinates with the given filter
+Plt_Color8 plt_texture_mip_level_sample(const Plt_Texture_Mip_Level *level, Plt_Texture_Filter filter, float x, float y);
@@ -1,11 +1,12 @@
 #include "plt_component_billboard_renderer.h"
 
 #include <stdlib.h>
+#include "platypus/world/plt_world.h"
 
 void _billboard_renderer_type_render(Plt_World *world, Plt_Entity_ID entity_id, void *instance_data, Plt_Frame_State state, Plt_Renderer *renderer) {
 	Plt_Object_Type_Billboard_Renderer_Data *data = instance_data;
 	
-//	plt_renderer_set_model_matrix(renderer, plt_object_get_model_matrix(object));
+	plt_renderer_set_model_matrix(renderer, plt_world_entity_get_model_matrix(world, entity_id));
 	plt_renderer_bind_texture(renderer, data->texture);
 	plt_renderer_draw_billboard(renderer, data->size);
 }
@@ -10,6 +10,11 @@ void _flying_camera_controller_type_init(Plt_World *world, Plt_Entity_ID entity_
 void _flying_camera_controller_type_update(Plt_World *world, Plt_Entity_ID entity_id, void *instance_data, Plt_Frame_State state) {
 	Plt_Object_Type_Flying_Camera_Controller_Data *data = instance_data;
 
+	// Headless worlds have no input
+	if (!state.input_state) {
+		return;
+	}
+
 	Plt_Vector3f forwards = plt_entity_get_forward(world, entity_id);
 	Plt_Vector3f right = plt_entity_get_right(world, entity_id);
 
@@ -15,7 +15,9 @@ void _mesh_renderer_type_render(Plt_World *world, Plt_Entity_ID entity_id, void
 	plt_renderer_bind_texture(renderer, mesh_type_data->texture);
 	plt_renderer_set_render_color(renderer, mesh_type_data->color);
 	plt_renderer_set_primitive_type(renderer, Plt_Primitive_Type_Triangle);
+	plt_renderer_set_static_geometry(renderer, mesh_type_data->is_static);
 	plt_renderer_draw_mesh(renderer, mesh_type_data->mesh);
+	plt_renderer_set_static_geometry(renderer, false);
 }
 
 void plt_register_mesh_renderer_component(Plt_World *world) {
@@ -39,3 +41,12 @@ void plt_component_mesh_renderer_set_texture(Plt_World *world, Plt_Entity_ID ent
 	
 	data->texture = texture;
 }
+
+void plt_component_mesh_renderer_set_static(Plt_World *world, Plt_Entity_ID entity_id, bool is_static) {
+	Plt_Object_Type_Mesh_Renderer_Data *data = plt_world_get_component_instance_data(world, entity_id, PLT_COMPONENT_MESH_RENDERER);
+	if (!data) {
+		return;
+	}
+	
+	data->is_static = is_static;
+}
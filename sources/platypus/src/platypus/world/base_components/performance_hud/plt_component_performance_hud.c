@@ -0,0 +1,200 @@
+#include "plt_component_performance_hud.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include "platypus/base/plt_macros.h"
+#include "platypus/base/plt_platform.h"
+#include "platypus/renderer/pipeline/plt_triangle_bin.h"
+#include "platypus/world/plt_world.h"
+
+#define PLT_PERFORMANCE_HUD_GRAPH_HEIGHT 48
+#define PLT_PERFORMANCE_HUD_BAR_WIDTH 2
+#define PLT_PERFORMANCE_HUD_PADDING 4
+
+#define PLT_PERFORMANCE_HUD_MAX_LINES 12
+#define PLT_PERFORMANCE_HUD_MAX_LINE_LENGTH 64
+#define PLT_PERFORMANCE_HUD_WORKERS_PER_LINE 8
+
+// Frames between reads of the process's memory use
+#define PLT_PERFORMANCE_HUD_MEMORY_SAMPLE_INTERVAL 30
+
+typedef struct Plt_Performance_Hud_Text {
+	char lines[PLT_PERFORMANCE_HUD_MAX_LINES][PLT_PERFORMANCE_HUD_MAX_LINE_LENGTH];
+	unsigned int line_count;
+	unsigned int max_line_length;
+} Plt_Performance_Hud_Text;
+
+static char *plt_performance_hud_text_add_line(Plt_Performance_Hud_Text *text) {
+	plt_assert(text->line_count < PLT_PERFORMANCE_HUD_MAX_LINES, "Too many performance HUD lines.\n");
+	return text->lines[text->line_count++];
+}
+
+static void plt_performance_hud_text_finish_line(Plt_Performance_Hud_Text *text) {
+	text->max_line_length = plt_max(text->max_line_length, strlen(text->lines[text->line_count - 1]));
+}
+
+static void plt_performance_hud_text_printf(Plt_Performance_Hud_Text *text, const char *format, ...) {
+	va_list args;
+	va_start(args, format);
+	vsnprintf(plt_performance_hud_text_add_line(text), PLT_PERFORMANCE_HUD_MAX_LINE_LENGTH, format, args);
+	va_end(args);
+	plt_performance_hud_text_finish_line(text);
+}
+
+static void plt_performance_hud_build_summary(Plt_Performance_Hud_Text *text, Plt_Object_Type_Performance_Hud_Data *data) {
+	float last_ms = data->frame_ms_history[(data->next_index + PLT_PERFORMANCE_HUD_HISTORY_LENGTH - 1) % PLT_PERFORMANCE_HUD_HISTORY_LENGTH];
+	float total_ms = 0.0f;
+	float max_ms = 0.0f;
+	unsigned int missed_count = 0;
+	for (unsigned int i = 0; i < data->history_count; ++i) {
+		float frame_ms = data->frame_ms_history[i];
+		total_ms += frame_ms;
+		max_ms = plt_max(max_ms, frame_ms);
+		missed_count += frame_ms > data->target_frame_ms;
+	}
+	float mean_ms = total_ms / plt_max(data->history_count, 1);
+
+	plt_performance_hud_text_printf(text, "Frame %.1fms avg %.1f max %.1f", last_ms, mean_ms, max_ms);
+	plt_performance_hud_text_printf(text, "FPS %.0f, %u/%u over %.1fms", (mean_ms > 0.0f) ? 1000.0f / mean_ms : 0.0f, missed_count, data->history_count, data->target_frame_ms);
+}
+
+static void plt_performance_hud_build_renderer_details(Plt_Performance_Hud_Text *text, Plt_Object_Type_Performance_Hud_Data *data, Plt_Renderer *renderer) {
+	Plt_Renderer_Frame_Timings timings = plt_renderer_get_frame_timings(renderer);
+	Plt_Renderer_Stats stats = plt_renderer_get_stats(renderer);
+
+	plt_performance_hud_text_printf(text, "Render %.2fms", timings.total_ms);
+	plt_performance_hud_text_printf(text, " VP %.2f TP %.2f RS %.2f DD %.2f", timings.vertex_processor_ms, timings.triangle_processor_ms, timings.rasteriser_ms, timings.direct_draw_ms);
+	plt_performance_hud_text_printf(text, "Draws %u Tris %u/%u binned", stats.draw_call_count, stats.triangles_binned, stats.triangles_submitted);
+
+	unsigned int rasterised_pixels = stats.tiles_rasterised * PLT_TRIANGLE_BIN_SIZE * PLT_TRIANGLE_BIN_SIZE;
+	plt_performance_hud_text_printf(text, "Tiles %u/%u Overdraw %.2fx", stats.tiles_rasterised, stats.tile_count, (rasterised_pixels > 0) ? stats.pixels_written / (float)rasterised_pixels : 0.0f);
+
+	// Busy time over the rasteriser's wall time, a worker well under the others ran out of tiles early
+	for (unsigned int i = 0; i < stats.worker_count; i += PLT_PERFORMANCE_HUD_WORKERS_PER_LINE) {
+		char *line = plt_performance_hud_text_add_line(text);
+		int length = snprintf(line, PLT_PERFORMANCE_HUD_MAX_LINE_LENGTH, (i == 0) ? "Workers" : "       ");
+		for (unsigned int j = i; j < plt_min(i + PLT_PERFORMANCE_HUD_WORKERS_PER_LINE, stats.worker_count); ++j) {
+			float utilisation = (timings.rasteriser_ms > 0.0f) ? plt_min(stats.worker_busy_ms[j] / timings.rasteriser_ms, 1.0f) : 0.0f;
+			length += snprintf(line + length, PLT_PERFORMANCE_HUD_MAX_LINE_LENGTH - length, " %3d%%", (int)(utilisation * 100.0f));
+		}
+		plt_performance_hud_text_finish_line(text);
+	}
+
+	if (data->frames_until_memory_sample == 0) {
+		data->resident_memory = plt_platform_get_resident_memory();
+		data->frames_until_memory_sample = PLT_PERFORMANCE_HUD_MEMORY_SAMPLE_INTERVAL;
+	}
+	data->frames_until_memory_sample--;
+
+	if (data->resident_memory > 0) {
+		plt_performance_hud_text_printf(text, "Memory %.1fMB", data->resident_memory / (1024.0f * 1024.0f));
+	}
+}
+
+static void plt_performance_hud_draw_graph(Plt_Object_Type_Performance_Hud_Data *data, Plt_Renderer *renderer, Plt_Vector2i position) {
+	float scale_ms = data->target_frame_ms * 2.0f;
+	Plt_Color8 under_color = plt_color8_make(80, 220, 80, 255);
+	Plt_Color8 over_color = plt_color8_make(230, 60, 60, 255);
+
+	// Oldest frame on the left, the graph fills from the right until the history is full
+	unsigned int first_index = (data->next_index + PLT_PERFORMANCE_HUD_HISTORY_LENGTH - data->history_count) % PLT_PERFORMANCE_HUD_HISTORY_LENGTH;
+	unsigned int first_x = position.x + (PLT_PERFORMANCE_HUD_HISTORY_LENGTH - data->history_count) * PLT_PERFORMANCE_HUD_BAR_WIDTH;
+	for (unsigned int i = 0; i < data->history_count; ++i) {
+		float frame_ms = data->frame_ms_history[(first_index + i) % PLT_PERFORMANCE_HUD_HISTORY_LENGTH];
+		unsigned int height = plt_clamp(frame_ms / scale_ms, 0.0f, 1.0f) * PLT_PERFORMANCE_HUD_GRAPH_HEIGHT;
+		height = plt_max(height, 1);
+
+		Plt_Rect bar = plt_rect_make(first_x + i * PLT_PERFORMANCE_HUD_BAR_WIDTH, position.y + PLT_PERFORMANCE_HUD_GRAPH_HEIGHT - height, PLT_PERFORMANCE_HUD_BAR_WIDTH, height);
+		plt_renderer_direct_draw_colored_rect(renderer, bar, 0, (frame_ms > data->target_frame_ms) ? over_color : under_color);
+	}
+
+	// Target frame time, halfway up the graph
+	Plt_Rect target_line = plt_rect_make(position.x, position.y + PLT_PERFORMANCE_HUD_GRAPH_HEIGHT / 2, PLT_PERFORMANCE_HUD_HISTORY_LENGTH * PLT_PERFORMANCE_HUD_BAR_WIDTH, 1);
+	plt_renderer_direct_draw_colored_rect(renderer, target_line, 0, plt_color8_make(255, 255, 255, 160));
+}
+
+void _performance_hud_init(Plt_World *world, Plt_Entity_ID entity_id, void *instance_data) {
+	Plt_Object_Type_Performance_Hud_Data *data = instance_data;
+	data->font = NULL;
+	data->position = (Plt_Vector2i){0, 0};
+	data->target_frame_ms = 1000.0f / 60.0f;
+	data->history_count = 0;
+	data->next_index = 0;
+	data->resident_memory = 0;
+	data->frames_until_memory_sample = 0;
+}
+
+void _performance_hud_render(Plt_World *world, Plt_Entity_ID entity_id, void *instance_data, Plt_Frame_State state, Plt_Renderer *renderer) {
+	Plt_Object_Type_Performance_Hud_Data *data = instance_data;
+
+	// Render runs once per presented frame, unlike update under a fixed timestep
+	data->frame_ms_history[data->next_index] = state.delta_time;
+	data->next_index = (data->next_index + 1) % PLT_PERFORMANCE_HUD_HISTORY_LENGTH;
+	data->history_count = plt_min(data->history_count + 1, PLT_PERFORMANCE_HUD_HISTORY_LENGTH);
+
+	if (!data->font) {
+		return;
+	}
+
+	Plt_Performance_Hud_Text summary = { .line_count = 0, .max_line_length = 0 };
+	plt_performance_hud_build_summary(&summary, data);
+
+	Plt_Performance_Hud_Text details = { .line_count = 0, .max_line_length = 0 };
+	plt_performance_hud_build_renderer_details(&details, data, renderer);
+
+	Plt_Size character_size = plt_font_get_character_size(data->font);
+	unsigned int text_width = plt_max(summary.max_line_length, details.max_line_length) * character_size.width;
+	unsigned int content_width = plt_max(text_width, PLT_PERFORMANCE_HUD_HISTORY_LENGTH * PLT_PERFORMANCE_HUD_BAR_WIDTH);
+	unsigned int content_height = (summary.line_count + details.line_count) * character_size.height + PLT_PERFORMANCE_HUD_GRAPH_HEIGHT + PLT_PERFORMANCE_HUD_PADDING * 2;
+
+	Plt_Rect background = plt_rect_make(data->position.x, data->position.y, content_width + PLT_PERFORMANCE_HUD_PADDING * 2, content_height + PLT_PERFORMANCE_HUD_PADDING * 2);
+	plt_renderer_direct_draw_colored_rect(renderer, background, 0, plt_color8_make(0, 0, 0, 176));
+
+	Plt_Vector2i cursor = { data->position.x + PLT_PERFORMANCE_HUD_PADDING, data->position.y + PLT_PERFORMANCE_HUD_PADDING };
+	for (unsigned int i = 0; i < summary.line_count; ++i) {
+		plt_renderer_direct_draw_text(renderer, cursor, data->font, summary.lines[i]);
+		cursor.y += character_size.height;
+	}
+
+	cursor.y += PLT_PERFORMANCE_HUD_PADDING;
+	plt_performance_hud_draw_graph(data, renderer, cursor);
+	cursor.y += PLT_PERFORMANCE_HUD_GRAPH_HEIGHT + PLT_PERFORMANCE_HUD_PADDING;
+
+	for (unsigned int i = 0; i < details.line_count; ++i) {
+		plt_renderer_direct_draw_text(renderer, cursor, data->font, details.lines[i]);
+		cursor.y += character_size.height;
+	}
+}
+
+void plt_register_performance_hud_component(Plt_World *world) {
+	plt_world_register_component(world, PLT_COMPONENT_PERFORMANCE_HUD, sizeof(Plt_Object_Type_Performance_Hud_Data), _performance_hud_init, NULL, _performance_hud_render);
+}
+
+void plt_component_performance_hud_set_font(Plt_World *world, Plt_Entity_ID entity_id, Plt_Font *font) {
+	Plt_Object_Type_Performance_Hud_Data *data = plt_world_get_component_instance_data(world, entity_id, PLT_COMPONENT_PERFORMANCE_HUD);
+	if (!data) {
+		return;
+	}
+	
+	data->font = font;
+}
+
+void plt_component_performance_hud_set_position(Plt_World *world, Plt_Entity_ID entity_id, Plt_Vector2i position) {
+	Plt_Object_Type_Performance_Hud_Data *data = plt_world_get_component_instance_data(world, entity_id, PLT_COMPONENT_PERFORMANCE_HUD);
+	if (!data) {
+		return;
+	}
+	
+	data->position = position;
+}
+
+void plt_component_performance_hud_set_target_fps(Plt_World *world, Plt_Entity_ID entity_id, unsigned int fps) {
+	Plt_Object_Type_Performance_Hud_Data *data = plt_world_get_component_instance_data(world, entity_id, PLT_COMPONENT_PERFORMANCE_HUD);
+	if (!data) {
+		return;
+	}
+	
+	data->target_frame_ms = 1000.0f / ((fps > 0) ? fps : 60);
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "platypus/platypus.h"
+
+void plt_register_performance_hud_component(Plt_World *world);
@@ -3,12 +3,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
+
+#include "platypus/base/plt_macros.h"
+#include "platypus/input/plt_input_state.h"
 
 #include "platypus/world/base_components/billboard_renderer/plt_component_billboard_renderer.h"
 #include "platypus/world/base_components/camera/plt_component_camera.h"
 #include "platypus/world/base_components/collider/plt_component_collider.h"
 #include "platypus/world/base_components/flying_camera_controller/plt_component_flying_camera_controller.h"
 #include "platypus/world/base_components/mesh_renderer/plt_component_mesh_renderer.h"
+#include "platypus/world/base_components/performance_hud/plt_component_performance_hud.h"
 
 Plt_World *plt_world_create() {
 	Plt_World *world = malloc(sizeof(Plt_World));
@@ -19,13 +24,21 @@ Plt_World *plt_world_create() {
 	world->entity_count = 0;
 	world->component_count = 0;
 
+	world->fixed_timestep_ms = 0.0f;
+	world->max_ticks_per_update = 1;
+	world->accumulated_ms = 0.0f;
+	world->interpolation_alpha = 1.0f;
+	world->accumulated_mouse_movement = (Plt_Vector2f){0, 0};
+
 	world->is_updating = false;
+	world->is_rendering = false;
 	
 	plt_register_billboard_renderer_component(world);
 	plt_register_camera_component(world);
 	plt_register_collider_component(world);
 	plt_register_flying_camera_component(world);
 	plt_register_mesh_renderer_component(world);
+	plt_register_performance_hud_component(world);
 	
 	return world;
 }
@@ -51,7 +64,8 @@ void plt_world_update_finish(Plt_World *world) {
 	world->deferred_destroy_count = 0;
 }
 
-void plt_world_update(Plt_World *world, Plt_Frame_State state) {
+void plt_world_tick(Plt_World *world, Plt_Frame_State state) {
+	plt_trace_begin("World Tick");
 	plt_world_update_begin(world);
 
 	for (unsigned int i = 0; i < world->component_count; ++i) {
@@ -60,19 +74,83 @@ void plt_world_update(Plt_World *world, Plt_Frame_State state) {
 			continue;
 		}
 
+		plt_trace_begin(component.name);
 		Plt_Component_Table_Entry *entry = component.table.entries;
 		for (unsigned int j = 0; j < component.table.entry_count; ++j) {
 			//printf("Updating entity %d(%s)\n", entry->entity_id, component.name);
 			component.update(world, entry->entity_id, entry->instance_data, state);
 			entry = (Plt_Component_Table_Entry *)(((char *)entry) + sizeof(Plt_Component_Table_Entry) + component.data_size);
 		}
+		plt_trace_end(component.name);
 	}
 
 	plt_world_update_finish(world);
+	plt_trace_end("World Tick");
+}
+
+void plt_world_update(Plt_World *world, Plt_Frame_State state) {
+	if (world->fixed_timestep_ms == 0.0f) {
+		plt_world_tick(world, state);
+		return;
+	}
+
+	Plt_Frame_State tick_state = state;
+	tick_state.delta_time = world->fixed_timestep_ms;
+
+	// Ticks get their own copy of the input, so mouse movement is only applied once however many run
+	Plt_Input_State tick_input_state;
+	if (state.input_state) {
+		tick_input_state = *state.input_state;
+		tick_state.input_state = &tick_input_state;
+		world->accumulated_mouse_movement = plt_vector2f_add(world->accumulated_mouse_movement, state.input_state->mouse_movement);
+	}
+
+	world->accumulated_ms += state.delta_time;
+	unsigned int tick_count = 0;
+	while ((world->accumulated_ms >= world->fixed_timestep_ms) && (tick_count < world->max_ticks_per_update)) {
+		for (unsigned int i = 0; i < world->entity_count; ++i) {
+			world->entities[i].previous_transform = world->entities[i].transform;
+		}
+
+		if (state.input_state) {
+			tick_input_state.mouse_movement = world->accumulated_mouse_movement;
+			world->accumulated_mouse_movement = (Plt_Vector2f){0, 0};
+		}
+
+		plt_world_tick(world, tick_state);
+		world->accumulated_ms -= world->fixed_timestep_ms;
+		++tick_count;
+	}
+
+	// Out of ticks, let simulation fall behind rather than owe the next frame even more work
+	if (world->accumulated_ms >= world->fixed_timestep_ms) {
+		world->accumulated_ms = fmodf(world->accumulated_ms, world->fixed_timestep_ms);
+	}
+	world->interpolation_alpha = world->accumulated_ms / world->fixed_timestep_ms;
+}
+
+void plt_world_set_fixed_timestep(Plt_World *world, float tick_rate, unsigned int max_ticks_per_update) {
+	plt_assert(tick_rate >= 0.0f, "Tick rate can't be negative.\n");
+	plt_assert(max_ticks_per_update > 0, "At least one tick must be allowed per update.\n");
+
+	world->fixed_timestep_ms = (tick_rate > 0.0f) ? 1000.0f / tick_rate : 0.0f;
+	world->max_ticks_per_update = max_ticks_per_update;
+	world->accumulated_ms = 0.0f;
+	world->interpolation_alpha = 1.0f;
+	world->accumulated_mouse_movement = (Plt_Vector2f){0, 0};
+	for (unsigned int i = 0; i < world->entity_count; ++i) {
+		world->entities[i].previous_transform = world->entities[i].transform;
+	}
+}
+
+float plt_world_get_interpolation_alpha(Plt_World *world) {
+	return world->interpolation_alpha;
 }
 
 void plt_world_render(Plt_World *world, Plt_Frame_State state, Plt_Renderer *renderer) {
+	plt_trace_begin("World Render");
 	plt_world_update_begin(world);
+	world->is_rendering = true;
 	
 	// Update camera
 	Plt_Entity_ID camera;
@@ -87,15 +165,19 @@ void plt_world_render(Plt_World *world, Plt_Frame_State state, Plt_Renderer *ren
 			continue;
 		}
 
+		plt_trace_begin(component.name);
 		Plt_Component_Table_Entry *entry = component.table.entries;
 		for (unsigned int j = 0; j < component.table.entry_count; ++j) {
 			//printf("Updating entity %d(%s)\n", entry->entity_id, component.name);
 			component.render(world, entry->entity_id, entry->instance_data, state, renderer);
 			entry = (Plt_Component_Table_Entry *)(((char *)entry) + sizeof(Plt_Component_Table_Entry) + component.data_size);
 		}
+		plt_trace_end(component.name);
 	}
 
+	world->is_rendering = false;
 	plt_world_update_finish(world);
+	plt_trace_end("World Render");
 }
 
 Plt_Entity *plt_world_get_entity(Plt_World *world, Plt_Entity_ID entity_id) {
@@ -137,6 +219,7 @@ Plt_Entity_ID plt_world_create_entity(Plt_World *world, const char *name, Plt_En
 		.name = name,
 		.transform = plt_transform_create(plt_vector3f_make(0, 0, 0), plt_quaternion_create_from_euler(plt_vector3f_make(0, 0, 0)), plt_vector3f_make(1, 1, 1))
 	};
+	entity.previous_transform = entity.transform;
 
 	world->entities[world->entity_count++] = entity;
 	
@@ -245,9 +328,16 @@ void plt_world_entity_remove_component(Plt_World *world, Plt_Entity_ID entity_id
 Plt_Matrix4x4f plt_world_entity_get_model_matrix(Plt_World *world, Plt_Entity_ID entity_id) {
 	Plt_Matrix4x4f matrix = plt_matrix_identity();
 	
+	// Rendering between fixed ticks sees transforms part way from the last tick to the current one
+	bool interpolate = world->is_rendering && (world->fixed_timestep_ms > 0.0f);
+	
 	while (entity_id != PLT_ENTITY_ID_NONE) {
 		Plt_Entity *entity = plt_world_get_entity(world, entity_id);
-		matrix = plt_matrix_multiply(plt_transform_to_matrix(entity->transform), matrix);
+		Plt_Transform transform = entity->transform;
+		if (interpolate) {
+			transform = plt_transform_interpolate(entity->previous_transform, entity->transform, world->interpolation_alpha);
+		}
+		matrix = plt_matrix_multiply(plt_transform_to_matrix(transform), matrix);
 		entity_id = entity->parent;
 	}
 	
@@ -282,6 +372,11 @@ void plt_world_entity_set_transform(Plt_World *world, Plt_Entity_ID entity_id, P
 	Plt_Entity *entity = plt_world_get_entity(world, entity_id);
 	if (entity) {
 		entity->transform = transform;
+
+		// Moves made outside of an update are teleports, so don't blend into them
+		if (!world->is_updating) {
+			entity->previous_transform = transform;
+		}
 	}
 }
 
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "platypus/platypus.h"
+
+// With a fixed timestep every entity's transform is blended between ticks while rendering. An entity that
+// hasn't moved must still get exactly the same model matrix each frame, the renderer's caches compare
+// matrices byte for byte.
+
+#define TEST_PROBE_COMPONENT "test_matrix_probe"
+#define TEST_MOVER_COMPONENT "test_mover"
+#define TEST_FRAME_COUNT 50
+
+typedef struct Test_Probe_Data {
+	Plt_Matrix4x4f model_matrix;
+} Test_Probe_Data;
+
+static void _test_probe_init(Plt_World *world, Plt_Entity_ID entity_id, void *instance_data) {
+	Test_Probe_Data *data = instance_data;
+	data->model_matrix = plt_matrix_identity();
+}
+
+static void _test_probe_render(Plt_World *world, Plt_Entity_ID entity_id, void *instance_data, Plt_Frame_State state, Plt_Renderer *renderer) {
+	Test_Probe_Data *data = instance_data;
+	data->model_matrix = plt_world_entity_get_model_matrix(world, entity_id);
+}
+
+static void _test_mover_update(Plt_World *world, Plt_Entity_ID entity_id, void *instance_data, Plt_Frame_State state) {
+	Plt_Transform transform = plt_world_entity_get_transform(world, entity_id);
+	transform.translation.x += state.delta_time * 0.01f;
+	plt_world_entity_set_transform(world, entity_id, transform);
+}
+
+int main(int argc, char **argv) {
+	Plt_World *world = plt_world_create();
+	plt_world_register_component(world, TEST_PROBE_COMPONENT, sizeof(Test_Probe_Data), _test_probe_init, NULL, _test_probe_render);
+	plt_world_register_component(world, TEST_MOVER_COMPONENT, 0, NULL, _test_mover_update, NULL);
+
+	// Values with plenty of low bits for blending to round away
+	Plt_Transform transform = {
+		.translation = plt_vector3f_make(1.1f, -2.3f, 0.7f),
+		.rotation = plt_quaternion_create_from_euler(plt_vector3f_make(0.3f, 1.1f, -0.4f)),
+		.scale = plt_vector3f_make(1.5f, 0.9f, 1.3f)
+	};
+
+	Plt_Entity_ID stationary = plt_world_create_entity(world, "stationary", PLT_ENTITY_ID_NONE);
+	plt_world_entity_set_transform(world, stationary, transform);
+	plt_world_entity_add_component(world, stationary, TEST_PROBE_COMPONENT);
+
+	Plt_Entity_ID moving = plt_world_create_entity(world, "moving", PLT_ENTITY_ID_NONE);
+	plt_world_entity_set_transform(world, moving, transform);
+	plt_world_entity_add_component(world, moving, TEST_PROBE_COMPONENT);
+	plt_world_entity_add_component(world, moving, TEST_MOVER_COMPONENT);
+
+	plt_world_set_fixed_timestep(world, 30.0f, 4);
+
+	Plt_Matrix4x4f expected = plt_transform_to_matrix(transform);
+	Plt_Matrix4x4f last_moving_matrix = plt_matrix_identity();
+	unsigned int moving_changed_count = 0;
+	unsigned int failure_count = 0;
+
+	for (unsigned int i = 0; i < TEST_FRAME_COUNT; ++i) {
+		Plt_Frame_State state = {
+			.delta_time = 1000.0f / 60.0f + (i % 3) * 2.1f,
+			.application_time = 0.0f,
+			.input_state = NULL
+		};
+		plt_world_update(world, state);
+		plt_world_render(world, state, NULL);
+
+		Test_Probe_Data *stationary_data = plt_world_get_component_instance_data(world, stationary, TEST_PROBE_COMPONENT);
+		if (memcmp(&stationary_data->model_matrix, &expected, sizeof(Plt_Matrix4x4f)) != 0) {
+			printf("Frame %u: stationary entity's matrix changed at alpha %f\n", i, plt_world_get_interpolation_alpha(world));
+			++failure_count;
+		}
+
+		Test_Probe_Data *moving_data = plt_world_get_component_instance_data(world, moving, TEST_PROBE_COMPONENT);
+		moving_changed_count += memcmp(&moving_data->model_matrix, &last_moving_matrix, sizeof(Plt_Matrix4x4f)) != 0;
+		last_moving_matrix = moving_data->model_matrix;
+	}
+
+	// Make sure frames really were interpolated
+	if (moving_changed_count < TEST_FRAME_COUNT / 2) {
+		printf("Moving entity only changed %u times, interpolation isn't being exercised\n", moving_changed_count);
+		++failure_count;
+	}
+
+	plt_world_destroy(world);
+
+	if (failure_count > 0) {
+		printf("FAILED: %u checks\n", failure_count);
+		return 1;
+	}
+
+	printf("Passed\n");
+	return 0;
+}